@@ -0,0 +1,56 @@
+/**
+ * @file benchmark_batch_inference.cpp
+ * @details Throughput of batched inference for different batch sizes
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <infer/infer.hpp>
+#include <iostream>
+#include <log/log.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+int main(int argc, char **argv) {
+  std::string model_path =
+      argc > 1 ? argv[1]
+               : std::string(PROJECT_SOURCE_DIR) + "/models/deeplabv3.tflite";
+  const int iterations = argc > 2 ? std::stoi(argv[2]) : 20;
+
+  tflite::inference::TFLiteInferenceEngine engine;
+  if (engine.load_model(model_path) !=
+      tflite::inference::InferenceStatus::SUCCESS) {
+    LOG_ERROR("Failed to load the model: ", model_path);
+    return -1;
+  }
+
+  cv::Mat image(engine.get_input_height(), engine.get_input_width(),
+                CV_32FC(engine.get_input_channels()));
+  cv::randu(image, 0.0, 1.0);
+
+  for (int batch_size : {1, 2, 4, 8}) {
+    std::vector<cv::Mat> batch(batch_size, image);
+
+    // Warm-up, also allocates the tensors for this batch size
+    if (engine.infer_batch(batch).empty()) {
+      std::cout << "Batch " << batch_size << ": not supported by the model"
+                << std::endl;
+      continue;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      engine.infer_batch(batch);
+    }
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+
+    std::cout << "Batch " << batch_size << ": "
+              << (iterations * batch_size) / seconds << " images/sec"
+              << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file benchmark_concurrent_models.cpp
+ * @details Combined throughput of 1-4 models running side by side, each
+ * starting one thread per core versus sharing the cores through the compute
+ * thread pool
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <atomic>
+#include <chrono>
+#include <infer/compute_thread_pool.hpp>
+#include <infer/infer.hpp>
+#include <iostream>
+#include <log/log.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+/**
+ * @brief Run the engines concurrently, each on its own thread
+ * @param engines Loaded engines
+ * @param image Input image
+ * @param seconds Measurement duration
+ * @return Inferences per second of all engines together
+ */
+double run(
+    std::vector<std::unique_ptr<tflite::inference::TFLiteInferenceEngine>>
+        &engines,
+    const cv::Mat &image, double seconds) {
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> inferences{0};
+  std::vector<std::thread> threads;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto &engine : engines) {
+    threads.emplace_back([&engine, &image, &stop, &inferences] {
+      while (!stop) {
+        if (engine->set_input(image) ==
+                tflite::inference::InferenceStatus::SUCCESS &&
+            engine->invoke() == tflite::inference::InferenceStatus::SUCCESS) {
+          ++inferences;
+        }
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  const double elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  return static_cast<double>(inferences) / elapsed;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string model_path =
+      argc > 1 ? argv[1]
+               : std::string(PROJECT_SOURCE_DIR) +
+                     "/models/mobilenet_ssd_v1.tflite";
+  const double seconds = argc > 2 ? std::stod(argv[2]) : 5.0;
+  const int cores = static_cast<int>(
+      tflite::inference::ComputeThreadPool::get_instance().num_cores());
+
+  enum class Mode { OVERSUBSCRIBED, SHARED, PINNED };
+  for (Mode mode : {Mode::OVERSUBSCRIBED, Mode::SHARED, Mode::PINNED}) {
+    for (int count = 1; count <= 4; ++count) {
+      tflite::inference::EngineOptions options;
+      if (mode == Mode::OVERSUBSCRIBED) {
+        // Every engine starts one thread per core, as before the pool
+        options.num_threads = cores;
+      } else {
+        options.num_threads = std::max(1, cores / count);
+        options.pin_threads = mode == Mode::PINNED;
+      }
+
+      std::vector<std::unique_ptr<tflite::inference::TFLiteInferenceEngine>>
+          engines;
+      for (int i = 0; i < count; ++i) {
+        auto engine =
+            std::make_unique<tflite::inference::TFLiteInferenceEngine>();
+        if (engine->load_model(model_path, options) !=
+            tflite::inference::InferenceStatus::SUCCESS) {
+          LOG_ERROR("Failed to load the model: ", model_path);
+          return -1;
+        }
+        engines.push_back(std::move(engine));
+      }
+
+      cv::Mat image(engines[0]->get_input_height(),
+                    engines[0]->get_input_width(),
+                    CV_8UC(engines[0]->get_input_channels()));
+      cv::randu(image, 0, 255);
+      // Warm-up, creates the lazily started worker threads
+      run(engines, image, 0.2);
+
+      const double throughput = run(engines, image, seconds);
+      std::cout << (mode == Mode::OVERSUBSCRIBED ? "Oversubscribed"
+                    : mode == Mode::SHARED       ? "Shared        "
+                                                 : "Pinned        ")
+                << " | Models: " << count << " | Threads/model: "
+                << engines[0]->get_num_threads()
+                << " | Combined: " << throughput << " inferences/s"
+                << " | Per model: " << throughput / count << " inferences/s"
+                << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file benchmark_detection_overlay.cpp
+ * @details Drawing of 100 detections on a 1080p frame with cached label
+ * sprites, in place and into a reused buffer, against cloning the frame and
+ * calling putText for every box
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <postprocess/detection_decoder.hpp>
+#include <visualizer/detection_overlay.hpp>
+
+#include "synthetic.hpp"
+
+using namespace tflite;
+
+namespace {
+/**
+ * @brief Drawing previously done by the object detection visualizer
+ */
+cv::Mat previous_draw(const cv::Mat &image,
+                      const postprocess::Detections &detections) {
+  cv::Mat overlaid_image = image.clone();
+  for (size_t i = 0; i < detections.size(); i++) {
+    cv::rectangle(overlaid_image, detections.boxes[i], cv::Scalar(0, 255, 0),
+                  2);
+    cv::putText(overlaid_image,
+                std::to_string(detections.classes[i]) + " : " +
+                    std::to_string(detections.scores[i]),
+                cv::Point(detections.boxes[i].x, detections.boxes[i].y - 5),
+                cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 2);
+  }
+  return overlaid_image;
+}
+
+template <typename Function> double time_ms(int iterations, Function &&run) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    run();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         iterations;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const int iterations = argc > 1 ? std::stoi(argv[1]) : 100;
+  const int count = argc > 2 ? std::stoi(argv[2]) : 100;
+
+  cv::Mat frame(1080, 1920, CV_8UC3);
+  cv::randu(frame, 0, 255);
+
+  const auto outputs = benchmark::make_detections(count);
+  postprocess::DecoderOptions decoder_options;
+  decoder_options.score_threshold = 0.0f;
+  postprocess::Detections detections;
+  postprocess::DetectionDecoder(decoder_options)
+      .decode(frame.size(), outputs.locations.data(), outputs.classes.data(),
+              outputs.scores.data(), outputs.num_detections.data(),
+              detections);
+
+  visualizer::DetectionOverlay overlay;
+  cv::Mat output;
+  cv::Mat in_place = frame.clone();
+
+  const double previous =
+      time_ms(iterations, [&] { previous_draw(frame, detections); });
+  // First frame renders every label
+  const double cold =
+      time_ms(1, [&] { overlay.draw(frame, detections, output); });
+  const double buffer =
+      time_ms(iterations, [&] { overlay.draw(frame, detections, output); });
+  const double place =
+      time_ms(iterations, [&] { overlay.draw(in_place, detections); });
+
+  std::cout << count << " boxes on 1920x1080, " << overlay.get_cache_size()
+            << " cached labels (ms per frame)" << std::endl;
+  std::cout << std::fixed << std::setprecision(3) << std::setw(28)
+            << "clone + putText: " << previous << std::endl
+            << std::setw(28) << "sprites, first frame: " << cold << std::endl
+            << std::setw(28) << "sprites, reused buffer: " << buffer
+            << std::endl
+            << std::setw(28) << "sprites, in place: " << place << std::endl;
+  return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file benchmark_metrics.cpp
+ * @details Cost of recording a latency sample, single and multi-threaded,
+ * versus a shared atomic counter
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <metrics/histogram.hpp>
+#include <thread>
+#include <utils/scoped_timer.hpp>
+#include <vector>
+
+namespace {
+/**
+ * @brief Run a recording function on several threads
+ * @param num_threads Number of threads
+ * @param iterations Iterations per thread
+ * @param fn Function called once per iteration
+ * @return Nanoseconds per call on each thread
+ */
+double run(int num_threads, int iterations,
+           const std::function<void(int)> &fn) {
+  std::vector<std::thread> threads;
+  const auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([iterations, &fn] {
+      for (int i = 0; i < iterations; ++i) {
+        fn(i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+} // namespace
+
+int main() {
+  constexpr int ITERATIONS = 2000000;
+  const int max_threads =
+      static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+
+  std::vector<int> thread_counts;
+  for (int num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+    thread_counts.push_back(num_threads);
+  }
+  thread_counts.push_back(max_threads);
+
+  std::cout << "threads\tatomic (ns)\trecord (ns)\tscoped timer (ns)\n";
+  for (int num_threads : thread_counts) {
+    std::atomic<uint64_t> shared{0};
+    const double atomic_ns = run(num_threads, ITERATIONS, [&shared](int i) {
+      shared.fetch_add(static_cast<uint64_t>(i), std::memory_order_relaxed);
+    });
+
+    tflite::metrics::Histogram histogram;
+    const double record_ns = run(num_threads, ITERATIONS, [&histogram](int i) {
+      histogram.record(static_cast<uint64_t>(i));
+    });
+
+    tflite::metrics::Histogram timed;
+    const double timer_ns = run(num_threads, ITERATIONS, [&timed](int) {
+      utils::timer::ScopedTimer timer(timed);
+    });
+
+    std::cout << num_threads << "\t" << atomic_ns << "\t\t" << record_ns
+              << "\t\t" << timer_ns << "\n";
+  }
+  return 0;
+}
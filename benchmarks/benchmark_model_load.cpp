@@ -0,0 +1,69 @@
+/**
+ * @file benchmark_model_load.cpp
+ * @details Cold and warm model load times with the persistent XNNPACK
+ * weights cache
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <infer/infer.hpp>
+#include <iostream>
+#include <log/log.hpp>
+
+namespace {
+double load_ms(const std::string &model_path,
+               const tflite::inference::EngineOptions &options) {
+  const auto start = std::chrono::steady_clock::now();
+  tflite::inference::TFLiteInferenceEngine engine;
+  if (engine.load_model(model_path, options) !=
+      tflite::inference::InferenceStatus::SUCCESS) {
+    return -1.0;
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string model_path =
+      argc > 1 ? argv[1]
+               : std::string(PROJECT_SOURCE_DIR) + "/models/deeplabv3.tflite";
+  const int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+  tflite::inference::EngineOptions options;
+  options.delegate = tflite::inference::DelegateType::XNNPACK;
+  options.fallback_to_cpu = false;
+  const double no_cache_ms = load_ms(model_path, options);
+  if (no_cache_ms < 0.0) {
+    LOG_ERROR("Failed to load the model: ", model_path);
+    return -1;
+  }
+
+  options.xnnpack.persistent_weights_cache = true;
+  double cold_ms = 0.0;
+  double warm_ms = 0.0;
+  for (int i = 0; i < repetitions; ++i) {
+    // Cold: remove the cache so the weights are packed and written
+    for (const auto &entry : std::filesystem::directory_iterator(
+             std::filesystem::path(model_path).parent_path())) {
+      if (entry.path().extension() == ".xnnpack_cache") {
+        std::filesystem::remove(entry.path());
+      }
+    }
+    cold_ms += load_ms(model_path, options);
+
+    // Warm: the cache written above is memory-mapped
+    warm_ms += load_ms(model_path, options);
+  }
+
+  std::cout << "Without cache: " << no_cache_ms << " ms" << std::endl;
+  std::cout << "Cold (cache written): " << cold_ms / repetitions << " ms"
+            << std::endl;
+  std::cout << "Warm (cache mapped): " << warm_ms / repetitions << " ms"
+            << std::endl;
+  return 0;
+}
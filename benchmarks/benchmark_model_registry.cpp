@@ -0,0 +1,76 @@
+/**
+ * @file benchmark_model_registry.cpp
+ * @details Load time and resident memory for a growing number of engines,
+ * with and without sharing the model through the registry
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <fstream>
+#include <infer/infer.hpp>
+#include <iostream>
+#include <log/log.hpp>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+/**
+ * @brief Resident set size of the process in MB (Linux)
+ */
+double rss_mb() {
+  std::ifstream statm("/proc/self/statm");
+  long pages = 0;
+  long resident = 0;
+  statm >> pages >> resident;
+  return static_cast<double>(resident) * sysconf(_SC_PAGESIZE) / 1e6;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string model_path =
+      argc > 1 ? argv[1]
+               : std::string(PROJECT_SOURCE_DIR) + "/models/deeplabv3.tflite";
+
+  tflite::inference::EngineOptions options;
+  options.num_threads = 1;
+
+  for (bool shared : {false, true}) {
+    for (int count : {1, 2, 4, 8, 16}) {
+      const double rss_before = rss_mb();
+      const auto start = std::chrono::steady_clock::now();
+
+      std::vector<std::unique_ptr<tflite::inference::TFLiteInferenceEngine>>
+          engines;
+      for (int i = 0; i < count; ++i) {
+        auto engine =
+            std::make_unique<tflite::inference::TFLiteInferenceEngine>();
+        tflite::inference::InferenceStatus status;
+        if (shared) {
+          status = engine->load_model(model_path, options);
+        } else {
+          // One private model per engine, as before the registry
+          status = engine->load_model(
+              std::shared_ptr<tflite::FlatBufferModel>(
+                  tflite::FlatBufferModel::BuildFromFile(model_path.c_str())),
+              options);
+        }
+        if (status != tflite::inference::InferenceStatus::SUCCESS) {
+          LOG_ERROR("Failed to load the model: ", model_path);
+          return -1;
+        }
+        engines.push_back(std::move(engine));
+      }
+
+      const double ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+      std::cout << (shared ? "Registry" : "Private ") << " | Engines: "
+                << count << " | Load: " << ms << " ms"
+                << " | RSS: +" << rss_mb() - rss_before << " MB" << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file benchmark_nms.cpp
+ * @details Non-maximum suppression of 8k to 25k candidate boxes, as output by
+ * YOLO-style models, for each kernel against a naive loop
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <postprocess/nms.hpp>
+#include <random>
+#include <vector>
+
+using namespace tflite::postprocess;
+using utils::cpu::SimdLevel;
+
+namespace {
+/**
+ * @brief Candidates clustered around objects, like the raw anchors of a
+ * detector
+ */
+BoxStore make_candidates(size_t count, int num_classes) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> position(0.0f, 1920.0f);
+  std::uniform_real_distribution<float> size(20.0f, 300.0f);
+  std::normal_distribution<float> jitter(0.0f, 8.0f);
+  std::uniform_real_distribution<float> score(0.0f, 1.0f);
+  std::uniform_int_distribution<int> class_id(0, num_classes - 1);
+
+  BoxStore boxes(count);
+  while (boxes.size() < count) {
+    const float cx = position(generator);
+    const float cy = position(generator) * 0.5625f;
+    const float width = size(generator);
+    const float height = size(generator);
+    const int object_class = class_id(generator);
+    for (int i = 0; i < 50 && boxes.size() < count; ++i) {
+      boxes.push_back_center(cx + jitter(generator), cy + jitter(generator),
+                             width + jitter(generator),
+                             height + jitter(generator), score(generator),
+                             object_class);
+    }
+  }
+  return boxes;
+}
+
+/**
+ * @brief Hand-written suppression on cv::Rect with a division per pair
+ */
+std::vector<size_t> naive_nms(const std::vector<cv::Rect> &rects,
+                              const BoxStore &boxes, float score_threshold,
+                              float threshold) {
+  std::vector<size_t> order;
+  for (size_t i = 0; i < rects.size(); ++i) {
+    if (boxes.scores()[i] >= score_threshold) {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&boxes](size_t a, size_t b) {
+    return boxes.scores()[a] > boxes.scores()[b];
+  });
+  std::vector<size_t> keep;
+  for (size_t candidate : order) {
+    bool suppressed = false;
+    for (size_t kept : keep) {
+      if (boxes.classes()[kept] == boxes.classes()[candidate] &&
+          overlap(rects[kept], rects[candidate]) > threshold) {
+        suppressed = true;
+        break;
+      }
+    }
+    if (!suppressed) {
+      keep.push_back(candidate);
+    }
+  }
+  return keep;
+}
+
+template <typename Function> double time_ms(int iterations, Function &&run) {
+  run();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    run();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         iterations;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const int iterations = argc > 1 ? std::stoi(argv[1]) : 10;
+  const int num_classes = argc > 2 ? std::stoi(argv[2]) : 80;
+
+  NmsOptions options;
+  options.threshold = 0.45f;
+  options.score_threshold = 0.05f;
+
+  std::cout << "Best kernel: "
+            << utils::cpu::to_string(utils::cpu::detect_simd_level())
+            << std::endl;
+  std::cout << std::setw(8) << "boxes" << std::setw(12) << "naive"
+            << std::setw(12) << "scalar" << std::setw(12) << "sse4.1"
+            << std::setw(12) << "avx2" << std::setw(14) << "avx2 top-2k"
+            << std::setw(8) << "kept" << "   (ms per frame)" << std::endl;
+
+  for (size_t count : {8000, 16000, 25000}) {
+    const BoxStore boxes = make_candidates(count, num_classes);
+    std::vector<cv::Rect> rects;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      rects.emplace_back(cv::Point(cvRound(boxes.x1()[i]),
+                                   cvRound(boxes.y1()[i])),
+                         cv::Point(cvRound(boxes.x2()[i]),
+                                   cvRound(boxes.y2()[i])));
+    }
+
+    const double naive = time_ms(iterations, [&] {
+      naive_nms(rects, boxes, options.score_threshold, options.threshold);
+    });
+
+    NonMaxSuppression nms;
+    std::vector<uint32_t> keep;
+    std::vector<double> kernels;
+    for (SimdLevel level :
+         {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2}) {
+      nms.set_simd_level(level);
+      kernels.push_back(nms.get_simd_level() == level
+                            ? time_ms(iterations,
+                                      [&] { nms.run(boxes, options, keep); })
+                            : 0.0);
+    }
+    const size_t kept = keep.size();
+
+    NmsOptions top_k = options;
+    top_k.top_k = 2000;
+    nms.set_simd_level(SimdLevel::AVX2);
+    const double preselected =
+        time_ms(iterations, [&] { nms.run(boxes, top_k, keep); });
+
+    std::cout << std::fixed << std::setprecision(3) << std::setw(8) << count
+              << std::setw(12) << naive << std::setw(12) << kernels[0]
+              << std::setw(12) << kernels[1] << std::setw(12) << kernels[2]
+              << std::setw(14) << preselected << std::setw(8) << kept
+              << std::endl;
+  }
+  return 0;
+}
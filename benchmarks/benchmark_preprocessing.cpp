@@ -0,0 +1,75 @@
+/**
+ * @file benchmark_preprocessing.cpp
+ * @details Fused preprocessing against the resize, cvtColor and convertTo
+ * chain of OpenCV calls
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <preprocess/preprocessor.hpp>
+
+namespace {
+template <typename Function>
+double measure_ms(Function &&function, int iterations) {
+  function();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    function();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         iterations;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const int iterations = argc > 1 ? std::stoi(argv[1]) : 100;
+
+  cv::Mat image(1080, 1920, CV_8UC3);
+  cv::randu(image, 0, 255);
+
+  for (TfLiteType type : {kTfLiteFloat32, kTfLiteUInt8}) {
+    tflite::preprocess::PreprocessSpec spec;
+    spec.width = 513;
+    spec.height = 513;
+    spec.type = type;
+    spec.mean = {0.5f, 0.5f, 0.5f};
+    spec.std = {0.5f, 0.5f, 0.5f};
+    spec.swap_rb = true;
+    spec.scale = type == kTfLiteFloat32 ? 0.0f : 1.0f / 128.0f;
+    spec.zero_point = type == kTfLiteFloat32 ? 0 : 128;
+
+    const int tensor_type = type == kTfLiteFloat32 ? CV_32FC3 : CV_8UC3;
+    cv::Mat tensor(spec.height, spec.width, tensor_type);
+
+    // Reference chain, copying into the tensor like infer() does
+    cv::Mat resized, rgb, normalized;
+    const double opencv_ms = measure_ms(
+        [&] {
+          cv::resize(image, resized, cv::Size(spec.width, spec.height));
+          cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+          if (type == kTfLiteFloat32) {
+            rgb.convertTo(normalized, CV_32FC3, 2.0 / 255.0, -1.0);
+          } else {
+            rgb.convertTo(normalized, CV_8UC3);
+          }
+          normalized.copyTo(tensor);
+        },
+        iterations);
+
+    tflite::preprocess::Preprocessor preprocessor(spec);
+    const double fused_ms =
+        measure_ms([&] { preprocessor.run(image, tensor); }, iterations);
+
+    std::cout << (type == kTfLiteFloat32 ? "float32" : "uint8")
+              << " 1920x1080 -> 513x513 | OpenCV chain: " << opencv_ms
+              << " ms | Fused: " << fused_ms << " ms | Speedup: "
+              << opencv_ms / fused_ms << "x" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file benchmark_roi_cascade.cpp
+ * @details Second-stage throughput of the batched ROI cascade against one
+ * invocation per detection, for different numbers of detections
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <infer/infer.hpp>
+#include <iostream>
+#include <log/log.hpp>
+#include <opencv2/opencv.hpp>
+#include <pipeline/roi_cascade.hpp>
+#include <preprocess/preprocessor.hpp>
+#include <vector>
+
+using namespace tflite;
+
+int main(int argc, char **argv) {
+  std::string model_path =
+      argc > 1 ? argv[1]
+               : std::string(PROJECT_SOURCE_DIR) + "/models/deeplabv3.tflite";
+  const int iterations = argc > 2 ? std::stoi(argv[2]) : 10;
+
+  auto engine = std::make_shared<inference::TFLiteInferenceEngine>();
+  if (engine->load_model(model_path) != inference::InferenceStatus::SUCCESS) {
+    LOG_ERROR("Failed to load the model: ", model_path);
+    return -1;
+  }
+  const auto spec = preprocess::PreprocessSpec::from_engine(*engine);
+  preprocess::Preprocessor preprocessor(spec);
+
+  cv::Mat frame(1080, 1920, CV_8UC(spec.channels));
+  cv::randu(frame, 0, 255);
+
+  pipeline::CascadeOptions options;
+  options.max_batch_size = 8;
+  pipeline::RoiCascade cascade(engine, spec, options);
+
+  for (int num_detections : {1, 4, 8, 16, 32}) {
+    visualizer::ObjectDetectionVisualizer::DetectionOutput detections;
+    for (int i = 0; i < num_detections; ++i) {
+      detections.boxes.emplace_back((i * 57) % 1700, (i * 31) % 900, 200, 160);
+      detections.classes.push_back(0);
+      detections.scores.push_back(1.0f);
+    }
+
+    // One invocation per detection
+    const auto start_single = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+      for (const cv::Rect &box : detections.boxes) {
+        cv::Mat input = engine->input_view();
+        preprocessor.run(frame(box), input);
+        engine->invoke();
+      }
+    }
+    const double single = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start_single)
+                              .count();
+
+    // Warm-up, also allocates the tensors of the batch sizes
+    std::vector<pipeline::RoiResult> results;
+    cascade.run(frame, detections, results);
+    const auto start_cascade = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+      cascade.run(frame, detections, results);
+    }
+    const double batched =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      start_cascade)
+            .count();
+
+    std::cout << num_detections << " detections: "
+              << (iterations * num_detections) / single
+              << " ROIs/sec single, "
+              << (iterations * num_detections) / batched
+              << " ROIs/sec batched (" << cascade.get_num_invocations()
+              << " invocations)" << std::endl;
+  }
+  return 0;
+}
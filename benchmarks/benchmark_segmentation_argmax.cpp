@@ -0,0 +1,141 @@
+/**
+ * @file benchmark_segmentation_argmax.cpp
+ * @details Class map of DeepLab-sized outputs with the vectorized argmax for
+ * each kernel and thread count, against the previous scalar loop
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <postprocess/segmentation_argmax.hpp>
+#include <random>
+#include <vector>
+
+using namespace tflite::postprocess;
+using utils::cpu::SimdLevel;
+
+namespace {
+/**
+ * @brief Single-threaded loop previously used by the segmentation visualizer
+ */
+cv::Mat previous_argmax(const float *scores, int height, int width,
+                        int channels) {
+  cv::Mat classes(height, width, CV_8UC1);
+  for (int i = 0; i < height; ++i) {
+    for (int j = 0; j < width; ++j) {
+      float max_prob = 0.0;
+      uchar max_class = 0;
+      for (int c = 0; c < channels; ++c) {
+        float prob = scores[i * width * channels + j * channels + c];
+        if (prob > max_prob) {
+          max_prob = prob;
+          max_class = c;
+        }
+      }
+      classes.at<uchar>(i, j) = max_class;
+    }
+  }
+  return classes;
+}
+
+template <typename T>
+std::vector<T> make_scores(int size, int channels, int low, int high) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> value(low, high);
+  std::vector<T> scores(static_cast<size_t>(size) * size * channels);
+  for (T &score : scores) {
+    score = static_cast<T>(value(generator));
+  }
+  return scores;
+}
+
+template <typename Function> double time_ms(int iterations, Function &&run) {
+  run();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    run();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         iterations;
+}
+
+template <typename T>
+void run_kernels(const char *type, int size, int channels,
+                 const std::vector<T> &scores, int iterations,
+                 const std::vector<int> &thread_counts) {
+  SegmentationArgmax argmax;
+  cv::Mat classes;
+  cv::Mat confidence;
+  for (SimdLevel level :
+       {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2}) {
+    argmax.set_simd_level(level);
+    if (argmax.get_simd_level() != level) {
+      continue;
+    }
+    for (int threads : thread_counts) {
+      cv::setNumThreads(threads);
+      const double classes_only = time_ms(iterations, [&] {
+        argmax.run(scores.data(), size, size, channels, classes);
+      });
+      const double with_confidence = time_ms(iterations, [&] {
+        argmax.run(scores.data(), size, size, channels, classes,
+                   &confidence);
+      });
+      std::cout << std::fixed << std::setprecision(3) << std::setw(6) << type
+                << std::setw(6) << size << std::setw(10)
+                << utils::cpu::to_string(level) << std::setw(9) << threads
+                << std::setw(12) << classes_only << std::setw(16)
+                << with_confidence << std::endl;
+    }
+  }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const int iterations = argc > 1 ? std::stoi(argv[1]) : 20;
+  const int max_threads = argc > 2 ? std::stoi(argv[2]) : cv::getNumThreads();
+  constexpr int channels = 21;
+  std::vector<int> thread_counts = {1};
+  if (max_threads > 1) {
+    thread_counts.push_back(max_threads);
+  }
+
+  std::cout << "Best kernel: "
+            << utils::cpu::to_string(utils::cpu::detect_simd_level())
+            << std::endl;
+  std::cout << std::setw(6) << "type" << std::setw(6) << "size"
+            << std::setw(10) << "kernel" << std::setw(9) << "threads"
+            << std::setw(12) << "classes" << std::setw(16) << "+confidence"
+            << "   (ms per frame)" << std::endl;
+
+  for (int size : {257, 513}) {
+    const auto scores = make_scores<float>(size, channels, -1000, 1000);
+    std::vector<float> normalized(scores.size());
+    for (size_t i = 0; i < scores.size(); ++i) {
+      normalized[i] = scores[i] / 1000.0f;
+    }
+    cv::setNumThreads(1);
+    const double previous = time_ms(iterations, [&] {
+      previous_argmax(normalized.data(), size, size, channels);
+    });
+    std::cout << std::fixed << std::setprecision(3) << std::setw(6) << "float"
+              << std::setw(6) << size << std::setw(10) << "previous"
+              << std::setw(9) << 1 << std::setw(12) << previous << std::endl;
+    run_kernels("float", size, channels, normalized, iterations,
+                thread_counts);
+    run_kernels("uint8", size, channels,
+                make_scores<uint8_t>(size, channels, 0, 255), iterations,
+                thread_counts);
+    run_kernels("int8", size, channels,
+                make_scores<int8_t>(size, channels, -128, 127), iterations,
+                thread_counts);
+  }
+  cv::setNumThreads(max_threads);
+  return 0;
+}
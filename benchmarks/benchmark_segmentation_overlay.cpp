@@ -0,0 +1,98 @@
+/**
+ * @file benchmark_segmentation_overlay.cpp
+ * @details Overlay of DeepLab-sized class maps on a 1080p frame, fused
+ * colorization and blending against the previous resize, color map and
+ * addWeighted passes
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <visualizer/segmentation_overlay.hpp>
+
+using namespace tflite::visualizer;
+
+namespace {
+/**
+ * @brief Passes previously made by the segmentation visualizer, each one
+ * allocating its own image
+ */
+cv::Mat previous_overlay(const cv::Mat &image, const cv::Mat &classes) {
+  cv::Mat resized;
+  cv::resize(classes * 255, resized, image.size(), 0, 0, cv::INTER_NEAREST);
+  cv::Mat color_map;
+  cv::applyColorMap(resized, color_map, cv::COLORMAP_JET);
+  if (color_map.type() != image.type()) {
+    color_map.convertTo(color_map, image.type());
+  }
+  cv::Mat output;
+  cv::addWeighted(image, 0.9, color_map, 0.1, 0, output);
+  return output;
+}
+
+template <typename Function> double time_ms(int iterations, Function &&run) {
+  run();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    run();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         iterations;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const int iterations = argc > 1 ? std::stoi(argv[1]) : 50;
+  const int max_threads = argc > 2 ? std::stoi(argv[2]) : cv::getNumThreads();
+
+  cv::Mat frame(1080, 1920, CV_8UC3);
+  cv::randu(frame, 0, 255);
+
+  std::cout << std::setw(10) << "classes" << std::setw(9) << "threads"
+            << std::setw(12) << "previous" << std::setw(10) << "fused"
+            << std::setw(12) << "in-place" << "   (ms per frame)" << std::endl;
+
+  for (int size : {257, 513}) {
+    // Blobs of the 21 DeepLab classes
+    cv::Mat classes(size, size, CV_8UC1);
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+        classes.at<uchar>(y, x) =
+            static_cast<uchar>(((y / 32) * 7 + (x / 48)) % 21);
+      }
+    }
+
+    std::vector<int> thread_counts = {1};
+    if (max_threads > 1) {
+      thread_counts.push_back(max_threads);
+    }
+    for (int threads : thread_counts) {
+      cv::setNumThreads(threads);
+      SegmentationOverlay overlay;
+      cv::Mat output;
+      cv::Mat in_place = frame.clone();
+
+      const double previous =
+          time_ms(iterations, [&] { previous_overlay(frame, classes); });
+      const double fused =
+          time_ms(iterations, [&] { overlay.run(frame, classes, output); });
+      const double fused_in_place = time_ms(
+          iterations, [&] { overlay.run(in_place, classes, in_place); });
+
+      const std::string name =
+          std::to_string(size) + "x" + std::to_string(size);
+      std::cout << std::fixed << std::setprecision(3) << std::setw(10) << name
+                << std::setw(9) << threads << std::setw(12) << previous
+                << std::setw(10) << fused << std::setw(12) << fused_in_place
+                << std::endl;
+    }
+  }
+  cv::setNumThreads(max_threads);
+  return 0;
+}
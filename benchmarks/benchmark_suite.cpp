@@ -0,0 +1,441 @@
+/**
+ * @file benchmark_suite.cpp
+ * @details Benchmarks of every step of the inference path with JSON output
+ * and comparison against a baseline
+ * Usage: benchmark_suite [--threads 1,2,4] [--sizes 640x480,1920x1080]
+ *        [--warmup 5] [--repetitions 30] [--filter infer] [--synthetic]
+ *        [--output results.json] [--compare baseline.json]
+ *        [--tolerance 0.1]
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <infer/compute_thread_pool.hpp>
+#include <infer/infer.hpp>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include <postprocess/detection_decoder.hpp>
+#include <preprocess/preprocessor.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <visualizer/object_detection.hpp>
+#include <visualizer/segmentation.hpp>
+
+#include "synthetic.hpp"
+
+namespace {
+struct Options {
+  std::vector<int> threads{1, 2, 4};
+  std::vector<cv::Size> sizes{{640, 480}, {1280, 720}, {1920, 1080}};
+  int warmup = 5;
+  int repetitions = 30;
+  std::string filter;
+  bool synthetic = false;
+  std::string output;
+  std::string compare;
+  double tolerance = 0.1;
+};
+
+struct Result {
+  std::string name;
+  int repetitions = 0;
+  double mean_ms = 0.0;
+  double median_ms = 0.0;
+  double min_ms = 0.0;
+  double max_ms = 0.0;
+  double stddev_ms = 0.0;
+};
+
+/**
+ * @brief Model under test, a file or a synthetic buffer
+ */
+struct Model {
+  std::string name;
+  std::string path;
+  std::vector<uint8_t> buffer;
+  // Input normalization, (pixel / 255 - mean) / std
+  float mean = 0.0f;
+  float std = 1.0f;
+
+  tflite::inference::InferenceStatus
+  load(tflite::inference::TFLiteInferenceEngine &engine,
+       const tflite::inference::EngineOptions &options) const {
+    return this->buffer.empty()
+               ? engine.load_model(this->path, options)
+               : engine.load_model_from_buffer(this->buffer.data(),
+                                               this->buffer.size(), options);
+  }
+};
+
+std::vector<std::string> split(const std::string &text, char separator) {
+  std::vector<std::string> parts;
+  std::stringstream stream(text);
+  std::string part;
+  while (std::getline(stream, part, separator)) {
+    if (!part.empty()) {
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      return i + 1 < argc ? argv[++i] : std::string();
+    };
+    if (arg == "--threads") {
+      options.threads.clear();
+      for (const auto &part : split(value(), ',')) {
+        options.threads.push_back(std::stoi(part));
+      }
+    } else if (arg == "--sizes") {
+      options.sizes.clear();
+      for (const auto &part : split(value(), ',')) {
+        const auto wh = split(part, 'x');
+        if (wh.size() != 2) {
+          std::cerr << "Invalid size: " << part << std::endl;
+          return false;
+        }
+        options.sizes.emplace_back(std::stoi(wh[0]), std::stoi(wh[1]));
+      }
+    } else if (arg == "--warmup") {
+      options.warmup = std::stoi(value());
+    } else if (arg == "--repetitions") {
+      options.repetitions = std::max(1, std::stoi(value()));
+    } else if (arg == "--filter") {
+      options.filter = value();
+    } else if (arg == "--synthetic") {
+      options.synthetic = true;
+    } else if (arg == "--output") {
+      options.output = value();
+    } else if (arg == "--compare") {
+      options.compare = value();
+    } else if (arg == "--tolerance") {
+      options.tolerance = std::stod(value());
+    } else {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+class Suite {
+public:
+  explicit Suite(const Options &options) : m_options(options) {}
+
+  /**
+   * @brief Time a function after a warm-up
+   * @param name Benchmark name
+   * @param function Function to time
+   * @param repetitions Repetitions, 0 for the configured number
+   */
+  void run(const std::string &name, const std::function<void()> &function,
+           int repetitions = 0) {
+    if (!this->m_options.filter.empty() &&
+        name.find(this->m_options.filter) == std::string::npos) {
+      return;
+    }
+    repetitions = repetitions > 0 ? repetitions : this->m_options.repetitions;
+
+    for (int i = 0; i < this->m_options.warmup; ++i) {
+      function();
+    }
+    std::vector<double> times;
+    times.reserve(repetitions);
+    for (int i = 0; i < repetitions; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      function();
+      times.push_back(std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - start)
+                          .count());
+    }
+
+    Result result;
+    result.name = name;
+    result.repetitions = repetitions;
+    std::sort(times.begin(), times.end());
+    result.min_ms = times.front();
+    result.max_ms = times.back();
+    result.median_ms = times.size() % 2 == 1
+                           ? times[times.size() / 2]
+                           : 0.5 * (times[times.size() / 2 - 1] +
+                                    times[times.size() / 2]);
+    for (double time : times) {
+      result.mean_ms += time;
+    }
+    result.mean_ms /= static_cast<double>(times.size());
+    for (double time : times) {
+      result.stddev_ms += (time - result.mean_ms) * (time - result.mean_ms);
+    }
+    result.stddev_ms = std::sqrt(result.stddev_ms / times.size());
+
+    std::cerr << std::left << std::setw(60) << name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(12)
+              << result.median_ms << " ms" << std::endl;
+    this->m_results.push_back(result);
+  }
+
+  /**
+   * @brief Format the results as JSON, one benchmark per line
+   * @return JSON
+   */
+  [[nodiscard]] std::string to_json() const {
+    std::ostringstream out;
+    out << std::setprecision(6);
+    out << "{\n  \"context\": {\"cores\": "
+        << tflite::inference::ComputeThreadPool::get_instance().num_cores()
+        << ", \"warmup\": " << this->m_options.warmup
+        << ", \"repetitions\": " << this->m_options.repetitions
+        << ", \"synthetic\": "
+        << (this->m_options.synthetic ? "true" : "false")
+        << "},\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < this->m_results.size(); ++i) {
+      const auto &result = this->m_results[i];
+      out << "    {\"name\": \"" << result.name
+          << "\", \"repetitions\": " << result.repetitions
+          << ", \"mean_ms\": " << result.mean_ms
+          << ", \"median_ms\": " << result.median_ms
+          << ", \"min_ms\": " << result.min_ms
+          << ", \"max_ms\": " << result.max_ms
+          << ", \"stddev_ms\": " << result.stddev_ms << "}"
+          << (i + 1 < this->m_results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+  }
+
+  /**
+   * @brief Compare the medians against a baseline written by this suite
+   * @param path Baseline JSON
+   * @return Number of regressions, -1 if the baseline cannot be read
+   */
+  [[nodiscard]] int compare(const std::string &path) const {
+    std::ifstream file(path);
+    if (!file) {
+      std::cerr << "Failed to read the baseline: " << path << std::endl;
+      return -1;
+    }
+
+    std::map<std::string, double> baseline;
+    std::string line;
+    while (std::getline(file, line)) {
+      const std::string name = read_string(line, "name");
+      const std::string median = read_value(line, "median_ms");
+      if (!name.empty() && !median.empty()) {
+        baseline[name] = std::stod(median);
+      }
+    }
+
+    int regressions = 0;
+    std::cout << std::left << std::setw(60) << "Benchmark" << std::right
+              << std::setw(14) << "Baseline ms" << std::setw(14)
+              << "Current ms" << std::setw(10) << "Change"
+              << "  Status\n";
+    for (const auto &result : this->m_results) {
+      auto it = baseline.find(result.name);
+      std::cout << std::left << std::setw(60) << result.name << std::right
+                << std::fixed << std::setprecision(3);
+      if (it == baseline.end()) {
+        std::cout << std::setw(14) << "-" << std::setw(14) << result.median_ms
+                  << std::setw(10) << "-" << "  NEW\n";
+        continue;
+      }
+
+      const double change = it->second > 0.0
+                                ? result.median_ms / it->second - 1.0
+                                : 0.0;
+      const char *status = "OK";
+      if (change > this->m_options.tolerance) {
+        status = "REGRESSION";
+        ++regressions;
+      } else if (change < -this->m_options.tolerance) {
+        status = "IMPROVED";
+      }
+      std::cout << std::setw(14) << it->second << std::setw(14)
+                << result.median_ms << std::setw(9) << std::setprecision(1)
+                << change * 100.0 << "%  " << status << "\n";
+    }
+    std::cout << regressions << " regressions above "
+              << this->m_options.tolerance * 100.0 << "%" << std::endl;
+    return regressions;
+  }
+
+private:
+  static std::string read_string(const std::string &line,
+                                 const std::string &key) {
+    const std::string token = "\"" + key + "\": \"";
+    const size_t begin = line.find(token);
+    if (begin == std::string::npos) {
+      return "";
+    }
+    const size_t end = line.find('"', begin + token.size());
+    return line.substr(begin + token.size(), end - begin - token.size());
+  }
+
+  static std::string read_value(const std::string &line,
+                                const std::string &key) {
+    const std::string token = "\"" + key + "\": ";
+    const size_t begin = line.find(token);
+    if (begin == std::string::npos) {
+      return "";
+    }
+    const size_t end = line.find_first_of(",}", begin + token.size());
+    return line.substr(begin + token.size(), end - begin - token.size());
+  }
+
+private:
+  const Options &m_options;
+  std::vector<Result> m_results;
+};
+
+std::string size_name(const cv::Size &size) {
+  return std::to_string(size.width) + "x" + std::to_string(size.height);
+}
+
+/**
+ * @brief Get the model of the given file, or a synthetic stand-in
+ */
+Model get_model(const std::string &name, bool synthetic, float mean,
+                float std) {
+  Model model;
+  model.path = std::string(PROJECT_SOURCE_DIR) + "/models/" + name + ".tflite";
+  model.mean = mean;
+  model.std = std;
+  if (synthetic || !std::filesystem::exists(model.path)) {
+    model.name = "synthetic_" + name;
+    model.buffer = tflite::benchmark::make_conv_model(257, 21);
+  } else {
+    model.name = name;
+  }
+  return model;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    return -1;
+  }
+
+  Suite suite(options);
+  std::vector<cv::Mat> images;
+  for (const auto &size : options.sizes) {
+    cv::Mat image(size, CV_8UC3);
+    cv::randu(image, 0, 255);
+    images.push_back(image);
+  }
+
+  const std::vector<Model> models{
+      get_model("mobilenet_ssd_v1", options.synthetic, 0.5f, 0.5f),
+      get_model("deeplabv3", options.synthetic, 0.0f, 1.0f)};
+
+  for (const auto &model : models) {
+    for (int threads : options.threads) {
+      tflite::inference::EngineOptions engine_options;
+      engine_options.num_threads = threads;
+      const std::string suffix =
+          model.name + "/threads=" + std::to_string(threads);
+
+      suite.run(
+          "load_model/" + suffix,
+          [&] {
+            tflite::inference::TFLiteInferenceEngine engine;
+            model.load(engine, engine_options);
+          },
+          std::min(options.repetitions, 10));
+
+      tflite::inference::TFLiteInferenceEngine engine;
+      if (model.load(engine, engine_options) !=
+          tflite::inference::InferenceStatus::SUCCESS) {
+        std::cerr << "Failed to load the model: " << model.name << std::endl;
+        return -1;
+      }
+      tflite::preprocess::Preprocessor preprocessor(
+          tflite::preprocess::PreprocessSpec::from_engine(
+              engine, {model.mean, model.mean, model.mean},
+              {model.std, model.std, model.std}));
+      cv::Mat input = engine.input_view();
+
+      // Preprocessing runs on the calling thread, once per model is enough
+      if (threads == options.threads.front()) {
+        for (size_t i = 0; i < images.size(); ++i) {
+          suite.run("preprocess/" + model.name + "/" +
+                        size_name(options.sizes[i]),
+                    [&] { preprocessor.run(images[i], input); });
+        }
+      }
+
+      preprocessor.run(images.front(), input);
+      suite.run("infer/" + suffix, [&] { engine.invoke(); });
+    }
+  }
+
+  // Postprocessing on synthetic outputs, independent of the models
+  const auto detections = tflite::benchmark::make_detections(100);
+  const tflite::postprocess::DetectionDecoder decoder;
+  tflite::postprocess::Detections decoded;
+  for (size_t i = 0; i < images.size(); ++i) {
+    const std::string size = size_name(options.sizes[i]);
+    suite.run("detection/convert_to_array/" + size, [&] {
+      tflite::visualizer::ObjectDetectionVisualizer::convert_to_array(
+          images[i].size(), detections.locations.data(),
+          detections.classes.data(), detections.scores.data(),
+          detections.num_detections.data());
+    });
+    // Same decoding into a buffer reused across iterations
+    suite.run("detection/decode/" + size, [&] {
+      decoder.decode(images[i].size(), detections.locations.data(),
+                     detections.classes.data(), detections.scores.data(),
+                     detections.num_detections.data(), decoded);
+    });
+    suite.run("detection/overlay/" + size, [&] {
+      tflite::visualizer::ObjectDetectionVisualizer::overlay(
+          images[i], detections.locations.data(), detections.classes.data(),
+          detections.scores.data(), detections.num_detections.data());
+    });
+  }
+
+  for (int size : {257, 513}) {
+    constexpr int classes = 21;
+    const auto scores =
+        tflite::benchmark::make_segmentation_scores(size, classes);
+    cv::Mat image(size, size, CV_8UC3);
+    cv::randu(image, 0, 255);
+    const std::string name = std::to_string(size) + "x" + std::to_string(size);
+
+    suite.run("segmentation/generate_segmentation_map/" + name, [&] {
+      tflite::visualizer::SegmentationVisualizer::generate_segmentation_map(
+          scores.data(), size, size, classes);
+    });
+    suite.run("segmentation/overlay/" + name, [&] {
+      tflite::visualizer::SegmentationVisualizer::overlay(
+          image, scores.data(), size, size, classes);
+    });
+  }
+
+  const std::string json = suite.to_json();
+  if (options.output.empty()) {
+    std::cout << json;
+  } else {
+    std::ofstream(options.output) << json;
+    std::cerr << "Results written to " << options.output << std::endl;
+  }
+
+  if (!options.compare.empty()) {
+    return suite.compare(options.compare) == 0 ? 0 : 1;
+  }
+  return 0;
+}
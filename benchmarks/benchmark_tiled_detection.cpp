@@ -0,0 +1,89 @@
+/**
+ * @file benchmark_tiled_detection.cpp
+ * @details Per-frame cost of tiled detection on a 4K frame for different
+ * grids, numbers of engines and batching
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <infer/infer.hpp>
+#include <iomanip>
+#include <iostream>
+#include <log/log.hpp>
+#include <opencv2/opencv.hpp>
+#include <pipeline/tiled_detector.hpp>
+#include <vector>
+
+using namespace tflite;
+
+int main(int argc, char **argv) {
+  std::string model_path =
+      argc > 1 ? argv[1]
+               : std::string(PROJECT_SOURCE_DIR) +
+                     "/models/mobilenet_ssd_v1.tflite";
+  const int iterations = argc > 2 ? std::stoi(argv[2]) : 10;
+  const int max_engines = argc > 3 ? std::stoi(argv[3]) : 4;
+
+  std::vector<std::shared_ptr<inference::TFLiteInferenceEngine>> engines;
+  for (int i = 0; i < max_engines; ++i) {
+    auto engine = std::make_shared<inference::TFLiteInferenceEngine>();
+    inference::EngineOptions engine_options;
+    engine_options.num_threads = 1;
+    if (engine->load_model(model_path, engine_options) !=
+        inference::InferenceStatus::SUCCESS) {
+      LOG_ERROR("Failed to load the model: ", model_path);
+      return -1;
+    }
+    engines.push_back(engine);
+  }
+  const auto spec = preprocess::PreprocessSpec::from_engine(*engines[0]);
+
+  cv::Mat image =
+      cv::imread(std::string(PROJECT_SOURCE_DIR) + "/data/person_1.jpg");
+  if (image.empty()) {
+    image = cv::Mat(2160, 3840, CV_8UC3);
+    cv::randu(image, 0, 255);
+  }
+  cv::Mat frame;
+  cv::resize(image, frame, cv::Size(3840, 2160));
+
+  struct Grid {
+    int cols;
+    int rows;
+  };
+  std::cout << std::setw(8) << "grid" << std::setw(9) << "engines"
+            << std::setw(8) << "tiles" << std::setw(12) << "frame ms"
+            << std::setw(12) << "merge ms" << std::setw(12) << "detections"
+            << std::endl;
+  for (const Grid &grid : {Grid{1, 1}, Grid{2, 1}, Grid{4, 2}, Grid{0, 0}}) {
+    for (int num_engines = 1; num_engines <= max_engines; num_engines *= 2) {
+      pipeline::TileOptions options;
+      options.cols = grid.cols;
+      options.rows = grid.rows;
+      pipeline::TiledDetector detector(
+          {engines.begin(), engines.begin() + num_engines}, spec, options);
+
+      // Warm-up, also starts the threads
+      detector.run(frame);
+      double frame_ms = 0.0;
+      double merge_ms = 0.0;
+      for (int i = 0; i < iterations; ++i) {
+        detector.run(frame);
+        frame_ms += detector.get_last_stats().total_ms;
+        merge_ms += detector.get_last_stats().merge_ms;
+      }
+
+      const auto &stats = detector.get_last_stats();
+      std::cout << std::setw(8)
+                << (grid.cols > 0 ? std::to_string(grid.cols) + "x" +
+                                        std::to_string(grid.rows)
+                                  : std::string("auto"))
+                << std::setw(9) << num_engines << std::setw(8) << stats.tiles
+                << std::setw(12) << frame_ms / iterations << std::setw(12)
+                << merge_ms / iterations << std::setw(12) << stats.detections
+                << std::endl;
+    }
+  }
+  return 0;
+}
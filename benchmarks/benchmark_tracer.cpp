@@ -0,0 +1,44 @@
+/**
+ * @file benchmark_tracer.cpp
+ * @details Cost of a trace span with the tracer stopped and started
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <iostream>
+#include <trace/tracer.hpp>
+
+namespace {
+/**
+ * @brief Time an empty traced scope
+ * @param iterations Number of spans
+ * @return Nanoseconds per span
+ */
+double run(int iterations) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    TFLITE_TRACE_FRAME(i);
+    TFLITE_TRACE_SCOPE("span");
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+} // namespace
+
+int main() {
+  constexpr int ITERATIONS = 5000000;
+  auto &tracer = tflite::trace::Tracer::get_instance();
+
+#ifndef TFLITE_ENABLE_TRACING
+  std::cout << "Built without TFLITE_ENABLE_TRACING, spans are compiled out"
+            << std::endl;
+#endif
+  std::cout << "Stopped: " << run(ITERATIONS) << " ns/span" << std::endl;
+  tracer.start();
+  std::cout << "Started: " << run(ITERATIONS) << " ns/span" << std::endl;
+  tracer.stop();
+  return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file synthetic.hpp
+ * @details Synthetic models and model outputs, so the benchmarks run without
+ * downloaded assets
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef BENCHMARK_SYNTHETIC_HPP
+#define BENCHMARK_SYNTHETIC_HPP
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <flatbuffers/flatbuffers.h>
+#include <tensorflow/lite/schema/schema_generated.h>
+
+namespace tflite::benchmark {
+/**
+ * @brief Build a float model of one 3x3 convolution with random weights,
+ * shaped like a segmentation model: [1, size, size, 3] to
+ * [1, size, size, classes]
+ * @param size Input height and width
+ * @param classes Output channels
+ * @param seed Seed of the weights
+ * @return Model flatbuffer, must outlive the engines using it
+ */
+inline std::vector<uint8_t> make_conv_model(int size, int classes,
+                                            uint32_t seed = 42) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+  std::vector<float> weights(static_cast<size_t>(classes) * 3 * 3 * 3);
+  std::vector<float> bias(classes);
+  for (float &weight : weights) {
+    weight = distribution(generator);
+  }
+  for (float &value : bias) {
+    value = distribution(generator);
+  }
+
+  flatbuffers::FlatBufferBuilder builder;
+  auto create_buffer = [&builder](const std::vector<float> &values) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(values.data());
+    builder.ForceVectorAlignment(values.size() * sizeof(float),
+                                 sizeof(uint8_t), 16);
+    return CreateBuffer(builder,
+                        builder.CreateVector(bytes,
+                                             values.size() * sizeof(float)));
+  };
+  // Buffer 0 is the empty buffer of the activations
+  std::vector<flatbuffers::Offset<Buffer>> buffers{
+      CreateBuffer(builder), create_buffer(weights), create_buffer(bias)};
+
+  std::vector<flatbuffers::Offset<Tensor>> tensors{
+      CreateTensor(builder, builder.CreateVector<int32_t>({1, size, size, 3}),
+                   TensorType_FLOAT32, 0, builder.CreateString("input")),
+      CreateTensor(builder, builder.CreateVector<int32_t>({classes, 3, 3, 3}),
+                   TensorType_FLOAT32, 1, builder.CreateString("weights")),
+      CreateTensor(builder, builder.CreateVector<int32_t>({classes}),
+                   TensorType_FLOAT32, 2, builder.CreateString("bias")),
+      CreateTensor(builder,
+                   builder.CreateVector<int32_t>({1, size, size, classes}),
+                   TensorType_FLOAT32, 0, builder.CreateString("output"))};
+
+  auto options =
+      CreateConv2DOptions(builder, Padding_SAME, 1, 1, ActivationFunctionType_RELU)
+          .Union();
+  std::vector<flatbuffers::Offset<Operator>> operators{CreateOperator(
+      builder, 0, builder.CreateVector<int32_t>({0, 1, 2}),
+      builder.CreateVector<int32_t>({3}), BuiltinOptions_Conv2DOptions,
+      options)};
+
+  auto subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors), builder.CreateVector<int32_t>({0}),
+      builder.CreateVector<int32_t>({3}), builder.CreateVector(operators),
+      builder.CreateString("main"));
+
+  std::vector<flatbuffers::Offset<OperatorCode>> codes{CreateOperatorCode(
+      builder, static_cast<int8_t>(BuiltinOperator_CONV_2D), 0, 1,
+      BuiltinOperator_CONV_2D)};
+
+  auto model = CreateModel(builder, TFLITE_SCHEMA_VERSION,
+                           builder.CreateVector(codes),
+                           builder.CreateVector(&subgraph, 1),
+                           builder.CreateString("synthetic conv"),
+                           builder.CreateVector(buffers));
+  FinishModelBuffer(builder, model);
+  return std::vector<uint8_t>(builder.GetBufferPointer(),
+                              builder.GetBufferPointer() + builder.GetSize());
+}
+
+/**
+ * @brief Outputs of an SSD postprocess op with random detections
+ */
+struct SyntheticDetections {
+  std::vector<float> locations;
+  std::vector<float> classes;
+  std::vector<float> scores;
+  std::vector<float> num_detections;
+};
+
+/**
+ * @brief Generate random SSD outputs with normalized [ymin, xmin, ymax, xmax]
+ * boxes
+ * @param count Number of detections
+ * @param seed Seed
+ * @return Outputs
+ */
+inline SyntheticDetections make_detections(int count, uint32_t seed = 42) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  SyntheticDetections detections;
+  for (int i = 0; i < count; ++i) {
+    const float y = unit(generator) * 0.8f;
+    const float x = unit(generator) * 0.8f;
+    detections.locations.insert(detections.locations.end(),
+                                {y, x, y + 0.2f * unit(generator),
+                                 x + 0.2f * unit(generator)});
+    detections.classes.push_back(static_cast<float>(generator() % 90));
+    detections.scores.push_back(unit(generator));
+  }
+  detections.num_detections.push_back(static_cast<float>(count));
+  return detections;
+}
+
+/**
+ * @brief Generate random per-pixel class scores of a segmentation model
+ * @param size Output height and width
+ * @param classes Number of classes
+ * @param seed Seed
+ * @return Scores in HWC order
+ */
+inline std::vector<float> make_segmentation_scores(int size, int classes,
+                                                   uint32_t seed = 42) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<float> scores(static_cast<size_t>(size) * size * classes);
+  for (float &score : scores) {
+    score = unit(generator);
+  }
+  return scores;
+}
+} // namespace tflite::benchmark
+
+#endif // BENCHMARK_SYNTHETIC_HPP
@@ -0,0 +1,78 @@
+/**
+ * @file example_latest_frame.cpp
+ * @details Example script for real-time object detection on a camera feed,
+ * dropping the frames the model cannot keep up with
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <infer/infer.hpp>
+#include <iostream>
+#include <log/glogging.hpp>
+#include <opencv2/opencv.hpp>
+#include <pipeline/latest_frame_scheduler.hpp>
+#include <pipeline/stages.hpp>
+#include <preprocess/preprocessor.hpp>
+
+int main(int argc, char **argv) {
+  tflite::logging::GLogger::init(argv[0],
+                                 std::string(PROJECT_SOURCE_DIR) + "/logs");
+
+  // Camera 0 unless a video file or stream URL is given
+  std::unique_ptr<tflite::pipeline::VideoSource> source =
+      argc > 1 ? std::make_unique<tflite::pipeline::VideoSource>(argv[1])
+               : std::make_unique<tflite::pipeline::VideoSource>(0, 300);
+  if (!source->is_opened()) {
+    tflite::logging::GLogger::shutdown();
+    return -1;
+  }
+
+  std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v12.tflite";
+  auto engine = std::make_shared<tflite::inference::TFLiteInferenceEngine>();
+  if (engine->load_model(model_path) !=
+      tflite::inference::InferenceStatus::SUCCESS) {
+    LOG(ERROR) << "Failed to load the model";
+    tflite::logging::GLogger::shutdown();
+    return -1;
+  }
+  auto preprocessor = std::make_shared<tflite::preprocess::Preprocessor>(
+      tflite::preprocess::PreprocessSpec::from_engine(
+          *engine, {0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}));
+
+  tflite::pipeline::SchedulerOptions options;
+  options.policy = tflite::pipeline::FramePolicy::TARGET_FPS;
+  options.target_fps = 15.0;
+  tflite::pipeline::LatestFrameScheduler scheduler(options);
+  scheduler.start(engine, preprocessor, [](tflite::pipeline::Frame &frame) {
+    if (frame.result.status != tflite::inference::InferenceStatus::SUCCESS) {
+      LOG(ERROR) << "Inference failed on frame " << frame.id;
+      return;
+    }
+    auto detections =
+        tflite::visualizer::ObjectDetectionVisualizer::convert_to_array(
+            frame.image.size(), frame.result.output(0), frame.result.output(1),
+            frame.result.output(2), frame.result.output(3));
+    LOG_EVERY_N(INFO, 15) << "Frame " << frame.id << ": "
+                          << detections.boxes.size() << " detections";
+  });
+
+  // The capture loop never waits for the model
+  tflite::pipeline::Frame frame;
+  while ((*source)(frame)) {
+    scheduler.submit(frame.image);
+    ++frame.id;
+  }
+  scheduler.stop();
+
+  auto stats = scheduler.get_stats();
+  std::cout << "Submitted: " << stats.submitted
+            << " | Processed: " << stats.processed
+            << " | Dropped: " << stats.dropped() << " (" << stats.skipped
+            << " skipped, " << stats.overwritten << " overwritten)"
+            << " | Latency: " << stats.mean_latency_ms << " ms mean, "
+            << stats.max_latency_ms << " ms max" << std::endl;
+  tflite::logging::GLogger::shutdown();
+  return 0;
+}
@@ -11,6 +11,7 @@
 #include <log/glogging.hpp>
 #include <log/log.hpp>
 #include <opencv2/opencv.hpp>
+#include <preprocess/preprocessor.hpp>
 #include <utils/scoped_timer.hpp>
 #include <visualizer/object_detection.hpp>
 
@@ -43,15 +44,27 @@ int main(int argc, char **argv) {
       tflite::logging::GLogger::shutdown();
       return -1;
     }
-    cv::Mat img_1_clone = img_1.clone();
-    cv::resize(img_1_clone, img_1_clone,
-               cv::Size(object_detection.get_input_height(),
-                        object_detection.get_input_width()));
+    // Resize and quantize straight into the input tensor
+    tflite::preprocess::Preprocessor preprocessor(
+        tflite::preprocess::PreprocessSpec::from_engine(
+            object_detection, {0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}));
+    cv::Mat input = object_detection.input_view();
+    if (preprocessor.run(img_1, input) !=
+        tflite::inference::InferenceStatus::SUCCESS) {
+      LOG(ERROR) << "Failed to preprocess the image";
+      tflite::logging::GLogger::shutdown();
+      return -1;
+    }
 
     auto [output_locations, output_classes, output_scores, num_detections] =
-        object_detection.infer(img_1_clone);
+        object_detection.infer_in_place();
     LOG(INFO) << "Inference Completed Successfully";
 
+    cv::Mat img_1_clone;
+    cv::resize(img_1, img_1_clone,
+               cv::Size(object_detection.get_input_width(),
+                        object_detection.get_input_height()));
+
     cv::Mat overlayed_image =
         tflite::visualizer::ObjectDetectionVisualizer::overlay(
             img_1_clone, output_locations, output_classes, output_scores,
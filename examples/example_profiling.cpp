@@ -0,0 +1,62 @@
+/**
+ * @file example_profiling.cpp
+ * @details Example script for a per-operator profile of a model
+ * Usage: example_profiling [model] [invocations] [total|mean|p50|p99|count|
+ * type|node] [text|json]
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <infer/infer.hpp>
+#include <iostream>
+#include <log/glogging.hpp>
+#include <map>
+#include <opencv2/opencv.hpp>
+
+int main(int argc, char **argv) {
+  tflite::logging::GLogger::init(argv[0],
+                                 std::string(PROJECT_SOURCE_DIR) + "/logs");
+  std::string model_path =
+      argc > 1 ? argv[1]
+               : std::string(PROJECT_SOURCE_DIR) + "/models/deeplabv3.tflite";
+  const int invocations = argc > 2 ? std::stoi(argv[2]) : 50;
+  const std::string sort = argc > 3 ? argv[3] : "total";
+  const bool json = argc > 4 && std::string(argv[4]) == "json";
+
+  using SortKey = tflite::inference::ProfileReport::SortKey;
+  const std::map<std::string, SortKey> sort_keys{
+      {"total", SortKey::TOTAL}, {"mean", SortKey::MEAN},
+      {"p50", SortKey::P50},     {"p99", SortKey::P99},
+      {"count", SortKey::COUNT}, {"type", SortKey::TYPE},
+      {"node", SortKey::NODE}};
+  if (sort_keys.count(sort) == 0) {
+    LOG(ERROR) << "Unknown sort key: " << sort;
+    tflite::logging::GLogger::shutdown();
+    return -1;
+  }
+
+  tflite::inference::EngineOptions options;
+  options.enable_profiling = true;
+  tflite::inference::TFLiteInferenceEngine engine;
+  if (engine.load_model(model_path, options) !=
+      tflite::inference::InferenceStatus::SUCCESS) {
+    LOG(ERROR) << "Failed to load the model";
+    tflite::logging::GLogger::shutdown();
+    return -1;
+  }
+
+  cv::Mat input = engine.input_view();
+  cv::randu(input, 0, 1);
+  // Warm-up
+  engine.invoke();
+  engine.reset_profile();
+  for (int i = 0; i < invocations; ++i) {
+    engine.invoke();
+  }
+
+  auto report = engine.get_profile(sort_keys.at(sort));
+  std::cout << (json ? report.to_json() : report.to_text()) << std::endl;
+  tflite::logging::GLogger::shutdown();
+  return 0;
+}
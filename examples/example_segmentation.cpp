@@ -10,6 +10,7 @@
 #include <iostream>
 #include <log/log.hpp>
 #include <opencv2/opencv.hpp>
+#include <preprocess/preprocessor.hpp>
 #include <utils/scoped_timer.hpp>
 #include <visualizer/segmentation.hpp>
 
@@ -27,18 +28,23 @@ int main() {
       return -1;
     }
 
-    cv::Mat img_1_clone = img_1.clone();
-    cv::resize(img_1_clone, img_1_clone,
-               cv::Size(segmentation.get_input_height(),
-                        segmentation.get_input_width()));
-    img_1_clone.convertTo(img_1_clone, CV_32FC3, 1.0 / 255.0);
+    // Resize and normalize straight into the input tensor, no extra copy
+    tflite::preprocess::Preprocessor preprocessor(
+        tflite::preprocess::PreprocessSpec::from_engine(segmentation));
+    cv::Mat input = segmentation.input_view();
+    if (preprocessor.run(img_1, input) !=
+        tflite::inference::InferenceStatus::SUCCESS) {
+      LOG_ERROR("Failed to preprocess the image");
+      return -1;
+    }
 
     auto [output_locations, output_classes, output_scores, num_detections] =
-        segmentation.infer(img_1_clone);
+        segmentation.infer_in_place();
 
+    // The class map is upsampled to the image while blending
     cv::Mat overlayed_image =
         tflite::visualizer::SegmentationVisualizer::overlay(
-            img_1_clone, output_locations, segmentation.get_output_height(),
+            img_1, output_locations, segmentation.get_output_height(),
             segmentation.get_output_width(),
             segmentation.get_output_channels());
     auto status = tflite::visualizer::SegmentationVisualizer::show(
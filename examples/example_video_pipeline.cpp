@@ -0,0 +1,83 @@
+/**
+ * @file example_video_pipeline.cpp
+ * @details Example script for object detection on a video with one thread per
+ * pipeline stage
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <infer/infer.hpp>
+#include <iostream>
+#include <log/glogging.hpp>
+#include <opencv2/opencv.hpp>
+#include <pipeline/pipeline.hpp>
+#include <pipeline/stages.hpp>
+#include <preprocess/preprocessor.hpp>
+#include <trace/tracer.hpp>
+
+int main(int argc, char **argv) {
+  tflite::logging::GLogger::init(argv[0],
+                                 std::string(PROJECT_SOURCE_DIR) + "/logs");
+  tflite::trace::Tracer::get_instance().start();
+
+  // Camera 0 unless a video file is given
+  std::unique_ptr<tflite::pipeline::VideoSource> source =
+      argc > 1 ? std::make_unique<tflite::pipeline::VideoSource>(argv[1])
+               : std::make_unique<tflite::pipeline::VideoSource>(0, 300);
+  if (!source->is_opened()) {
+    tflite::logging::GLogger::shutdown();
+    return -1;
+  }
+
+  std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v12.tflite";
+  auto engine = std::make_shared<tflite::inference::TFLiteInferenceEngine>();
+  if (engine->load_model(model_path) !=
+      tflite::inference::InferenceStatus::SUCCESS) {
+    LOG(ERROR) << "Failed to load the model";
+    tflite::logging::GLogger::shutdown();
+    return -1;
+  }
+  auto preprocessor = std::make_shared<tflite::preprocess::Preprocessor>(
+      tflite::preprocess::PreprocessSpec::from_engine(
+          *engine, {0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}));
+
+  tflite::pipeline::Pipeline pipeline(4);
+  pipeline.set_source("capture", *source);
+  pipeline.add_stage("preprocess",
+                     tflite::pipeline::make_preprocess_stage(preprocessor));
+  pipeline.add_stage("inference",
+                     tflite::pipeline::make_inference_stage(engine));
+  pipeline.add_stage("postprocess",
+                     tflite::pipeline::make_detection_postprocess_stage());
+  pipeline.add_stage("overlay",
+                     tflite::pipeline::make_detection_overlay_stage());
+  pipeline.add_stage("sink", [](tflite::pipeline::Frame &frame) {
+    LOG_EVERY_N(INFO, 30) << "Frame " << frame.id << ": "
+                          << frame.detections.boxes.size() << " detections";
+  });
+
+  if (!pipeline.start()) {
+    tflite::logging::GLogger::shutdown();
+    return -1;
+  }
+  pipeline.wait();
+
+  for (const auto &stage : pipeline.get_stats()) {
+    std::cout << stage.name << " | Frames: " << stage.frames
+              << " | FPS: " << stage.fps << " | Mean: " << stage.mean_ms
+              << " ms | Max Queue: " << stage.max_queue_depth << "/"
+              << stage.queue_capacity << std::endl;
+  }
+
+  // Open in https://ui.perfetto.dev to see where each frame spent its time
+  const std::string trace_path =
+      std::string(PROJECT_SOURCE_DIR) + "/logs/pipeline_trace.json";
+  tflite::trace::Tracer::get_instance().stop();
+  if (tflite::trace::Tracer::get_instance().write_chrome_trace(trace_path)) {
+    std::cout << "Trace written to " << trace_path << std::endl;
+  }
+  tflite::logging::GLogger::shutdown();
+  return 0;
+}
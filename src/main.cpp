@@ -4,6 +4,7 @@
 #include <log/log.hpp>
 #include <memory>
 #include <opencv2/opencv.hpp>
+#include <preprocess/preprocessor.hpp>
 #include <sstream>
 #include <utils/scoped_timer.hpp>
 #include <visualizer/object_detection.hpp>
@@ -21,13 +22,19 @@ int main() {
     tflite::inference::TFLiteInferenceEngine object_detection;
 
     object_detection.load_model(modelPath);
-    cv::Mat img_1_clone = img_1.clone();
-    cv::resize(img_1_clone, img_1_clone,
-               cv::Size(object_detection.get_input_height(),
-                        object_detection.get_input_width()));
+    tflite::preprocess::Preprocessor preprocessor(
+        tflite::preprocess::PreprocessSpec::from_engine(
+            object_detection, {0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}));
+    cv::Mat input = object_detection.input_view();
+    preprocessor.run(img_1, input);
 
     auto [output_locations, output_classes, output_scores, num_detections] =
-        object_detection.infer(img_1_clone);
+        object_detection.infer_in_place();
+
+    cv::Mat img_1_clone;
+    cv::resize(img_1, img_1_clone,
+               cv::Size(object_detection.get_input_width(),
+                        object_detection.get_input_height()));
 
     cv::Mat overlayed_image =
         tflite::visualizer::ObjectDetectionVisualizer::overlay(
@@ -43,15 +50,18 @@ int main() {
     std::string segmentation_model_path =
         std::string(PROJECT_SOURCE_DIR) + "/models/deeplabv3.tflite";
     segmentation.load_model(segmentation_model_path);
-
-    cv::Mat img_1_clone = img_1.clone();
-    cv::resize(img_1_clone, img_1_clone,
-               cv::Size(segmentation.get_input_height(),
-                        segmentation.get_input_width()));
-    img_1_clone.convertTo(img_1_clone, CV_32FC3, 1.0 / 255.0);
+    tflite::preprocess::Preprocessor preprocessor(
+        tflite::preprocess::PreprocessSpec::from_engine(segmentation));
+    cv::Mat input = segmentation.input_view();
+    preprocessor.run(img_1, input);
 
     auto [output_locations, output_classes, output_scores, num_detections] =
-        segmentation.infer(img_1_clone);
+        segmentation.infer_in_place();
+
+    cv::Mat img_1_clone;
+    cv::resize(img_1, img_1_clone,
+               cv::Size(segmentation.get_input_width(),
+                        segmentation.get_input_height()));
 
     cv::Mat overlayed_image =
         tflite::visualizer::SegmentationVisualizer::overlay(
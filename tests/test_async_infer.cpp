@@ -0,0 +1,110 @@
+/**
+ * @file test_async_infer.hpp
+ * @details Test cases for the asynchronous inference engine
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <infer/async_infer.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+using namespace tflite::inference;
+
+class AsyncInferenceEngineTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    auto status = engine.load_model(this->model_path);
+    assert(status == InferenceStatus::SUCCESS);
+  }
+
+  AsyncInferenceEngine engine{2};
+  std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v1.tflite";
+};
+
+TEST_F(AsyncInferenceEngineTest, InferAsyncReturnsErrorForEmptyImage) {
+  auto result = engine.infer_async(cv::Mat()).get();
+  EXPECT_EQ(result.status, InferenceStatus::INPUT_ERROR);
+  EXPECT_TRUE(result.outputs.empty());
+}
+
+TEST_F(AsyncInferenceEngineTest, InferAsyncMatchesSynchronousInference) {
+  cv::Mat image(300, 300, CV_8UC3);
+  cv::randu(image, 0, 255);
+
+  TFLiteInferenceEngine sync_engine;
+  ASSERT_EQ(sync_engine.load_model(this->model_path), InferenceStatus::SUCCESS);
+  auto [locations, classes, scores, num_detections] = sync_engine.infer(image);
+  ASSERT_NE(num_detections, nullptr);
+
+  auto result = engine.infer_async(image).get();
+  ASSERT_EQ(result.status, InferenceStatus::SUCCESS);
+  ASSERT_EQ(result.outputs.size(), 4);
+  EXPECT_EQ(result.output(3)[0], num_detections[0]);
+  EXPECT_FLOAT_EQ(result.output(2)[0], scores[0]);
+  EXPECT_EQ(result.output(4), nullptr);
+}
+
+TEST_F(AsyncInferenceEngineTest, RequestsOwnTheirOutputs) {
+  TFLiteInferenceEngine sync_engine;
+  ASSERT_EQ(sync_engine.load_model(this->model_path), InferenceStatus::SUCCESS);
+
+  std::vector<cv::Mat> images;
+  std::vector<InferenceResult> expected;
+  for (int i = 0; i < 6; ++i) {
+    cv::Mat image(300, 300, CV_8UC3);
+    cv::randu(image, 0, 255);
+    ASSERT_NE(std::get<3>(sync_engine.infer(image)), nullptr);
+    expected.push_back(InferenceResult::collect(sync_engine));
+    images.push_back(image);
+  }
+  ASSERT_NE(expected[0].outputs, expected[1].outputs);
+
+  std::vector<std::future<InferenceResult>> futures;
+  for (const auto &image : images) {
+    futures.push_back(engine.infer_async(image));
+    EXPECT_LE(engine.queue_size(), 2);
+  }
+
+  // The first result is taken before the later requests overwrite the
+  // engine's output tensors
+  std::vector<InferenceResult> results;
+  results.push_back(futures[0].get());
+  const auto first_outputs = results[0].outputs;
+  for (size_t i = 1; i < futures.size(); ++i) {
+    results.push_back(futures[i].get());
+  }
+
+  EXPECT_EQ(results[0].outputs, first_outputs);
+  for (size_t i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(results[i].status, InferenceStatus::SUCCESS);
+    ASSERT_EQ(results[i].outputs.size(), expected[i].outputs.size());
+    for (size_t j = 0; j < results[i].outputs.size(); ++j) {
+      const auto &values = results[i].outputs[j];
+      const auto &expected_values = expected[i].outputs[j];
+      ASSERT_EQ(values.size(), expected_values.size());
+      for (size_t k = 0; k < values.size(); ++k) {
+        EXPECT_FLOAT_EQ(values[k], expected_values[k])
+            << "request " << i << ", output " << j << ", value " << k;
+      }
+    }
+  }
+}
+
+TEST_F(AsyncInferenceEngineTest, InferAsyncCallsBack) {
+  std::atomic<int> calls{0};
+  cv::Mat image = cv::Mat::zeros(300, 300, CV_8UC3);
+  for (int i = 0; i < 4; ++i) {
+    engine.infer_async(image, [&](InferenceResult &&result) {
+      if (result.status == InferenceStatus::SUCCESS) {
+        ++calls;
+      }
+    });
+  }
+  engine.stop();
+  EXPECT_EQ(calls, 4);
+}
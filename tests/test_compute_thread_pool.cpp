@@ -0,0 +1,140 @@
+/**
+ * @file test_compute_thread_pool.hpp
+ * @details Test cases for the process-wide compute thread pool
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <infer/compute_thread_pool.hpp>
+#include <infer/infer.hpp>
+#include <set>
+
+using namespace tflite::inference;
+
+TEST(ComputeThreadPoolTest, BudgetsGetDisjointCores) {
+  auto &pool = ComputeThreadPool::get_instance();
+  if (pool.num_free_cores() < 4) {
+    GTEST_SKIP() << "Needs at least 4 free cores";
+  }
+
+  auto first = pool.acquire(2);
+  auto second = pool.acquire(2);
+  ASSERT_EQ(first.num_threads(), 2);
+  ASSERT_EQ(second.num_threads(), 2);
+
+  std::set<int> cores(first.cores().begin(), first.cores().end());
+  cores.insert(second.cores().begin(), second.cores().end());
+  EXPECT_EQ(cores.size(), 4);
+}
+
+TEST(ComputeThreadPoolTest, ReleaseReturnsCores) {
+  auto &pool = ComputeThreadPool::get_instance();
+  const size_t free_cores = pool.num_free_cores();
+  {
+    auto budget = pool.acquire(1);
+    EXPECT_EQ(pool.num_free_cores(), free_cores > 0 ? free_cores - 1 : 0);
+
+    ThreadBudget moved = std::move(budget);
+    EXPECT_EQ(budget.num_threads(), 0);
+    EXPECT_EQ(moved.num_threads(), 1);
+  }
+  EXPECT_EQ(pool.num_free_cores(), free_cores);
+}
+
+TEST(ComputeThreadPoolTest, ZeroThreadsTakesFreeCores) {
+  auto &pool = ComputeThreadPool::get_instance();
+  const size_t free_cores = pool.num_free_cores();
+
+  auto first = pool.acquire(0);
+  EXPECT_EQ(first.num_threads(), std::max<size_t>(1, free_cores));
+  EXPECT_EQ(pool.num_free_cores(), 0);
+
+  // No free core left, the second engine still gets one thread
+  auto second = pool.acquire(0);
+  EXPECT_EQ(second.num_threads(), 1);
+}
+
+TEST(ComputeThreadPoolTest, SetCoresKeepsGrantedLoad) {
+  auto &pool = ComputeThreadPool::get_instance();
+  const std::vector<int> cores = pool.cores();
+  if (pool.num_free_cores() < 2) {
+    GTEST_SKIP() << "Needs at least 2 free cores";
+  }
+
+  auto budget = pool.acquire(1);
+  const int held = budget.cores()[0];
+  const int other = held == cores[0] ? cores[1] : cores[0];
+  pool.set_cores({held, other});
+  EXPECT_EQ(pool.num_free_cores(), 1);
+
+  auto next = pool.acquire(1);
+  ASSERT_EQ(next.num_threads(), 1);
+  EXPECT_EQ(next.cores()[0], other);
+  EXPECT_EQ(pool.num_free_cores(), 0);
+
+  budget.release();
+  next.release();
+  EXPECT_EQ(pool.num_free_cores(), 2);
+  pool.set_cores(cores);
+}
+
+#ifdef __linux__
+TEST(ComputeThreadPoolTest, AffinityScopePinsAndRestores) {
+  cpu_set_t before;
+  ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &before),
+            0);
+  auto budget = ComputeThreadPool::get_instance().acquire(1, true);
+  ASSERT_TRUE(budget.pinned());
+  {
+    AffinityScope scope(budget.cores());
+    cpu_set_t pinned;
+    ASSERT_EQ(
+        pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &pinned), 0);
+    EXPECT_EQ(CPU_COUNT(&pinned), 1);
+    EXPECT_TRUE(CPU_ISSET(budget.cores()[0], &pinned));
+  }
+  cpu_set_t after;
+  ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &after),
+            0);
+  EXPECT_TRUE(CPU_EQUAL(&before, &after));
+}
+#endif
+
+TEST(ComputeThreadPoolTest, EnginesShareTheCores) {
+  const std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v1.tflite";
+  auto &pool = ComputeThreadPool::get_instance();
+  const size_t free_cores = pool.num_free_cores();
+
+  EngineOptions options;
+  options.num_threads = 1;
+  options.pin_threads = true;
+
+  {
+    TFLiteInferenceEngine detection;
+    TFLiteInferenceEngine segmentation;
+    ASSERT_EQ(detection.load_model(model_path, options),
+              InferenceStatus::SUCCESS);
+    ASSERT_EQ(segmentation.load_model(model_path, options),
+              InferenceStatus::SUCCESS);
+    EXPECT_EQ(detection.get_num_threads(), 1);
+    EXPECT_EQ(segmentation.get_num_threads(), 1);
+    if (free_cores >= 2) {
+      EXPECT_EQ(pool.num_free_cores(), free_cores - 2);
+    }
+
+    cv::Mat image(300, 300, CV_8UC3, cv::Scalar::all(128));
+    auto [locations, classes, scores, num_detections] = detection.infer(image);
+    EXPECT_NE(num_detections, nullptr);
+
+    // Reloading gives the previous cores back first
+    ASSERT_EQ(detection.load_model(model_path, options),
+              InferenceStatus::SUCCESS);
+    if (free_cores >= 2) {
+      EXPECT_EQ(pool.num_free_cores(), free_cores - 2);
+    }
+  }
+  EXPECT_EQ(pool.num_free_cores(), free_cores);
+}
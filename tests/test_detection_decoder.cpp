@@ -0,0 +1,209 @@
+/**
+ * @file test_detection_decoder.hpp
+ * @details Test cases for decoding SSD outputs into a reused buffer
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <postprocess/detection_decoder.hpp>
+#include <vector>
+
+using namespace tflite::postprocess;
+
+namespace {
+// Allocations made through the global operator new, counted per thread
+thread_local size_t allocations = 0;
+
+struct SsdOutputs {
+  std::vector<float> locations;
+  std::vector<float> classes;
+  std::vector<float> scores;
+  std::vector<float> num_detections;
+
+  void add(float ymin, float xmin, float ymax, float xmax, int class_id,
+           float score) {
+    this->locations.insert(this->locations.end(), {ymin, xmin, ymax, xmax});
+    this->classes.push_back(static_cast<float>(class_id));
+    this->scores.push_back(score);
+    this->num_detections = {static_cast<float>(this->scores.size())};
+  }
+
+  size_t decode(const DetectionDecoder &decoder, const cv::Size &size,
+                Detections &detections) const {
+    return decoder.decode(size, this->locations.data(), this->classes.data(),
+                          this->scores.data(), this->num_detections.data(),
+                          detections);
+  }
+};
+
+SsdOutputs make_outputs(int count) {
+  SsdOutputs outputs;
+  for (int i = 0; i < count; ++i) {
+    const float offset = 0.01f * static_cast<float>(i % 50);
+    // Scores out of order so top-k has to insert in the middle
+    outputs.add(offset, offset, offset + 0.3f, offset + 0.4f, i % 7,
+                static_cast<float>((i * 37) % 100) / 100.0f);
+  }
+  return outputs;
+}
+} // namespace
+
+void *operator new(size_t size) {
+  ++allocations;
+  if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+
+TEST(DetectionDecoderTest, CoordinatesFollowWidthAndHeight) {
+  SsdOutputs outputs;
+  // [ymin, xmin, ymax, xmax]
+  outputs.add(0.1f, 0.2f, 0.5f, 0.6f, 3, 0.9f);
+
+  Detections detections;
+  ASSERT_EQ(outputs.decode(DetectionDecoder(), cv::Size(1000, 500), detections),
+            1);
+  EXPECT_EQ(detections.boxes[0], cv::Rect(200, 50, 400, 200));
+  EXPECT_EQ(detections.classes[0], 3);
+  EXPECT_FLOAT_EQ(detections.scores[0], 0.9f);
+
+  // Decoding into a region offsets the boxes
+  DetectionDecoder().decode(cv::Rect(100, 40, 1000, 500),
+                            outputs.locations.data(), outputs.classes.data(),
+                            outputs.scores.data(),
+                            outputs.num_detections.data(), detections);
+  EXPECT_EQ(detections.boxes[0], cv::Rect(300, 90, 400, 200));
+}
+
+TEST(DetectionDecoderTest, ThresholdAndAllowlist) {
+  SsdOutputs outputs;
+  outputs.add(0.0f, 0.0f, 0.1f, 0.1f, 0, 0.9f);
+  outputs.add(0.0f, 0.0f, 0.1f, 0.1f, 1, 0.4f);
+  outputs.add(0.0f, 0.0f, 0.1f, 0.1f, 2, 0.3f);
+  outputs.add(0.0f, 0.0f, 0.1f, 0.1f, 17, 0.2f);
+
+  Detections detections;
+  EXPECT_EQ(outputs.decode(DetectionDecoder(), cv::Size(100, 100), detections),
+            1);
+
+  DecoderOptions options;
+  options.score_threshold = 0.25f;
+  EXPECT_EQ(outputs.decode(DetectionDecoder(options), cv::Size(100, 100),
+                           detections),
+            3);
+  EXPECT_EQ(detections.classes, std::vector<int>({0, 1, 2}));
+
+  options.score_threshold = 0.0f;
+  options.classes = {17, 1};
+  EXPECT_EQ(outputs.decode(DetectionDecoder(options), cv::Size(100, 100),
+                           detections),
+            2);
+  EXPECT_EQ(detections.classes, std::vector<int>({1, 17}));
+}
+
+TEST(DetectionDecoderTest, ScoreEqualToThresholdIsSkipped) {
+  SsdOutputs outputs;
+  outputs.add(0.0f, 0.0f, 0.1f, 0.1f, 0, 0.5f);
+  outputs.add(0.0f, 0.0f, 0.1f, 0.1f, 1, 0.75f);
+
+  DecoderOptions options;
+  options.score_threshold = 0.5f;
+  Detections detections;
+  EXPECT_EQ(outputs.decode(DetectionDecoder(options), cv::Size(100, 100),
+                           detections),
+            1);
+  EXPECT_EQ(detections.classes, std::vector<int>({1}));
+}
+
+TEST(DetectionDecoderTest, QuantizedScoresAreFilteredBeforeDequantizing) {
+  SsdOutputs outputs;
+  outputs.add(0.0f, 0.0f, 0.1f, 0.1f, 0, 0.0f);
+  outputs.add(0.0f, 0.0f, 0.5f, 0.5f, 1, 0.0f);
+  outputs.add(0.0f, 0.0f, 0.2f, 0.2f, 2, 0.0f);
+  // 0.25, 0.5 and 0.78125
+  std::vector<uint8_t> scores = {64, 128, 200};
+
+  const auto make_tensor = [](TfLiteType type, void *data, size_t bytes,
+                              float scale) {
+    TfLiteTensor tensor{};
+    tensor.type = type;
+    tensor.data.raw = static_cast<char *>(data);
+    tensor.bytes = bytes;
+    tensor.params = {scale, 0};
+    return tensor;
+  };
+  TfLiteTensor locations =
+      make_tensor(kTfLiteFloat32, outputs.locations.data(),
+                  outputs.locations.size() * sizeof(float), 0.0f);
+  TfLiteTensor classes =
+      make_tensor(kTfLiteFloat32, outputs.classes.data(),
+                  outputs.classes.size() * sizeof(float), 0.0f);
+  TfLiteTensor num_detections =
+      make_tensor(kTfLiteFloat32, outputs.num_detections.data(),
+                  sizeof(float), 0.0f);
+  TfLiteTensor quantized_scores = make_tensor(
+      kTfLiteUInt8, scores.data(), scores.size(), 1.0f / 256.0f);
+
+  DecoderOptions options;
+  options.score_threshold = 0.5f;
+  Detections detections;
+  ASSERT_EQ(DetectionDecoder(options).decode(
+                cv::Size(100, 100),
+                tflite::inference::OutputTensor(&locations),
+                tflite::inference::OutputTensor(&classes),
+                tflite::inference::OutputTensor(&quantized_scores),
+                tflite::inference::OutputTensor(&num_detections), detections),
+            1);
+  EXPECT_EQ(detections.classes, std::vector<int>({2}));
+  EXPECT_FLOAT_EQ(detections.scores[0], 200.0f / 256.0f);
+  EXPECT_EQ(detections.boxes[0], cv::Rect(0, 0, 20, 20));
+}
+
+TEST(DetectionDecoderTest, TopKKeepsHighestScores) {
+  const SsdOutputs outputs = make_outputs(100);
+  DecoderOptions options;
+  options.score_threshold = 0.0f;
+  options.top_k = 5;
+
+  Detections detections;
+  ASSERT_EQ(outputs.decode(DetectionDecoder(options), cv::Size(640, 480),
+                           detections),
+            5);
+  EXPECT_EQ(detections.scores,
+            std::vector<float>({0.99f, 0.98f, 0.97f, 0.96f, 0.95f}));
+  EXPECT_EQ(detections.boxes.size(), 5);
+  EXPECT_EQ(detections.classes.size(), 5);
+}
+
+TEST(DetectionDecoderTest, SteadyStateDoesNotAllocate) {
+  const SsdOutputs outputs = make_outputs(100);
+  DecoderOptions options;
+  options.score_threshold = 0.1f;
+  const DetectionDecoder decoder(options);
+  options.top_k = 10;
+  const DetectionDecoder top_k_decoder(options);
+
+  Detections detections;
+  Detections top_detections;
+  outputs.decode(decoder, cv::Size(1920, 1080), detections);
+  outputs.decode(top_k_decoder, cv::Size(1920, 1080), top_detections);
+
+  const size_t before = allocations;
+  for (int i = 0; i < 100; ++i) {
+    outputs.decode(decoder, cv::Size(1920, 1080), detections);
+    outputs.decode(top_k_decoder, cv::Size(1920, 1080), top_detections);
+  }
+  EXPECT_EQ(allocations, before);
+  EXPECT_EQ(detections.size(), 90);
+  EXPECT_EQ(top_detections.size(), 10);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file test_detection_overlay.hpp
+ * @details Test cases for drawing detections with cached labels
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include <visualizer/detection_overlay.hpp>
+
+using namespace tflite;
+using namespace tflite::visualizer;
+
+namespace {
+postprocess::Detections make_detections() {
+  postprocess::Detections detections;
+  // The label of the last box is above the image
+  detections.boxes = {cv::Rect(100, 100, 200, 150), cv::Rect(400, 50, 80, 80),
+                      cv::Rect(10, 0, 50, 50)};
+  detections.classes = {1, 1, 2};
+  detections.scores = {0.871f, 0.879f, 0.5f};
+  return detections;
+}
+} // namespace
+
+TEST(DetectionOverlayTest, MatchesPutText) {
+  postprocess::Detections detections;
+  detections.boxes = {cv::Rect(100, 100, 200, 150)};
+  detections.classes = {1};
+  detections.scores = {0.871f};
+
+  cv::Mat expected = cv::Mat::zeros(480, 640, CV_8UC3);
+  cv::rectangle(expected, detections.boxes[0], cv::Scalar(0, 255, 0), 2);
+  cv::putText(expected, "1 : 0.87", cv::Point(100, 95),
+              cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 2);
+
+  DetectionOverlay overlay;
+  cv::Mat image = cv::Mat::zeros(480, 640, CV_8UC3);
+  ASSERT_EQ(overlay.draw(image, detections), VisualizationStatus::SUCCESS);
+  EXPECT_EQ(cv::norm(image, expected, cv::NORM_INF), 0.0);
+}
+
+TEST(DetectionOverlayTest, ReusesBufferAndMatchesInPlace) {
+  const postprocess::Detections detections = make_detections();
+  cv::Mat image(480, 640, CV_8UC3, cv::Scalar(30, 60, 90));
+  const cv::Mat original = image.clone();
+  DetectionOverlay overlay;
+
+  cv::Mat output;
+  ASSERT_EQ(overlay.draw(image, detections, output),
+            VisualizationStatus::SUCCESS);
+  const uchar *data = output.data;
+  ASSERT_EQ(overlay.draw(image, detections, output),
+            VisualizationStatus::SUCCESS);
+  EXPECT_EQ(output.data, data);
+  // The input is left untouched
+  EXPECT_EQ(cv::norm(image, original, cv::NORM_INF), 0.0);
+
+  ASSERT_EQ(overlay.draw(image, detections), VisualizationStatus::SUCCESS);
+  EXPECT_EQ(cv::norm(image, output, cv::NORM_INF), 0.0);
+}
+
+TEST(DetectionOverlayTest, CachesLabelsPerClassAndScore) {
+  const postprocess::Detections detections = make_detections();
+  cv::Mat image = cv::Mat::zeros(480, 640, CV_8UC3);
+
+  DetectionOverlay overlay;
+  overlay.draw(image, detections);
+  // 0.871 and 0.879 share the label "1 : 0.87"
+  EXPECT_EQ(overlay.get_cache_size(), 2);
+  overlay.draw(image, detections);
+  EXPECT_EQ(overlay.get_cache_size(), 2);
+
+  DetectionOverlayOptions options;
+  options.score_decimals = -1;
+  options.labels = {"background", "person"};
+  DetectionOverlay class_only(options);
+  class_only.draw(image, detections);
+  EXPECT_EQ(class_only.get_cache_size(), 2);
+  class_only.clear_cache();
+  EXPECT_EQ(class_only.get_cache_size(), 0);
+}
+
+TEST(DetectionOverlayTest, CacheKeepsMostRecentLabels) {
+  DetectionOverlayOptions options;
+  options.max_cached_labels = 2;
+  DetectionOverlay overlay(options);
+  cv::Mat image = cv::Mat::zeros(480, 640, CV_8UC3);
+
+  // Every score a distinct label
+  postprocess::Detections detections;
+  for (int i = 0; i < 50; ++i) {
+    detections.boxes.push_back(cv::Rect(100, 100, 50, 50));
+    detections.classes.push_back(1);
+    detections.scores.push_back(0.5f + 0.01f * static_cast<float>(i));
+  }
+  ASSERT_EQ(overlay.draw(image, detections), VisualizationStatus::SUCCESS);
+  EXPECT_EQ(overlay.get_cache_size(), 2);
+
+  // Drawing with evicted labels matches drawing with a fresh cache
+  cv::Mat expected = cv::Mat::zeros(480, 640, CV_8UC3);
+  DetectionOverlay().draw(expected, make_detections());
+  cv::Mat output = cv::Mat::zeros(480, 640, CV_8UC3);
+  overlay.draw(output, make_detections());
+  EXPECT_EQ(cv::norm(output, expected, cv::NORM_INF), 0.0);
+  EXPECT_EQ(overlay.get_cache_size(), 2);
+}
+
+TEST(DetectionOverlayTest, RejectsEmptyImage) {
+  DetectionOverlay overlay;
+  cv::Mat image;
+  EXPECT_EQ(overlay.draw(image, make_detections()),
+            VisualizationStatus::INPUT_IMAGE_EMPTY);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_engine_pool.hpp
+ * @details Test cases for the inference engine pool
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <infer/engine_pool.hpp>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+using namespace tflite::inference;
+
+class InferenceEnginePoolTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    EngineOptions options;
+    options.num_threads = 1;
+    auto status = pool.load_model(this->model_path, this->pool_size, options);
+    assert(status == InferenceStatus::SUCCESS);
+  }
+
+  InferenceEnginePool pool;
+  const size_t pool_size = 2;
+  std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v1.tflite";
+};
+
+TEST_F(InferenceEnginePoolTest, LoadModelReturnsErrorForInvalidPath) {
+  InferenceEnginePool invalid_pool;
+  auto status = invalid_pool.load_model("invalid/path/to/model.tflite", 2);
+  EXPECT_EQ(status, InferenceStatus::MODEL_LOAD_ERROR);
+}
+
+TEST_F(InferenceEnginePoolTest, AcquireReturnsEmptyLeaseForUnloadedPool) {
+  InferenceEnginePool unloaded_pool;
+  auto lease = unloaded_pool.acquire();
+  EXPECT_FALSE(lease);
+  EXPECT_FALSE(unloaded_pool.try_acquire().has_value());
+}
+
+TEST_F(InferenceEnginePoolTest, SizeReturnsNumberOfEngines) {
+  EXPECT_EQ(pool.size(), this->pool_size);
+}
+
+TEST_F(InferenceEnginePoolTest, TryAcquireFailsWhenAllEnginesAreLeased) {
+  auto first = pool.try_acquire();
+  auto second = pool.try_acquire();
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_NE(&**first, &**second);
+
+  EXPECT_FALSE(pool.try_acquire().has_value());
+  EXPECT_EQ(pool.get_stats().failed_acquisitions, 1);
+}
+
+TEST_F(InferenceEnginePoolTest, LeaseReturnsEngineOnDestruction) {
+  {
+    auto first = pool.try_acquire();
+    auto second = pool.try_acquire();
+    EXPECT_FALSE(pool.try_acquire().has_value());
+  }
+  EXPECT_TRUE(pool.try_acquire().has_value());
+}
+
+TEST_F(InferenceEnginePoolTest, ConcurrentInferenceReturnsValidTensors) {
+  std::vector<std::thread> workers;
+  std::atomic<int> failures{0};
+  for (int t = 0; t < 4; ++t) {
+    workers.emplace_back([&] {
+      for (int i = 0; i < 5; ++i) {
+        auto engine = pool.acquire();
+        cv::Mat image = cv::Mat::zeros(engine->get_input_height(),
+                                       engine->get_input_width(), CV_8UC3);
+        auto [locations, classes, scores, num_detections] =
+            engine->infer(image);
+        if (locations == nullptr || num_detections == nullptr) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  EXPECT_EQ(failures, 0);
+  auto stats = pool.get_stats();
+  EXPECT_EQ(stats.acquisitions, 20);
+  EXPECT_GT(stats.utilization, 0.0);
+  EXPECT_LE(stats.utilization, 1.0);
+}
@@ -108,7 +108,7 @@ TEST_F(TFLiteInferenceEngineTest, InferReturnsNullptrsForInvalidImageType) {
 
 TEST_F(TFLiteInferenceEngineTest, InferReturnsValidTensorsForValidImage) {
   engine.load_model(this->model_path);
-  cv::Mat valid_image(224, 224, CV_8UC3, cv::Scalar(0, 0, 0));
+  cv::Mat valid_image(300, 300, CV_8UC3, cv::Scalar(0, 0, 0));
   auto result = engine.infer(valid_image);
   EXPECT_NE(std::get<0>(result), nullptr);
   EXPECT_NE(std::get<1>(result), nullptr);
@@ -130,3 +130,131 @@ TEST_F(TFLiteInferenceEngineTest, LoadModelReturnsErrorForEmptyPath) {
   auto status = engine.load_model("");
   EXPECT_EQ(status, tflite::inference::InferenceStatus::MODEL_LOAD_ERROR);
 }
+
+TEST_F(TFLiteInferenceEngineTest, InferBatchReturnsEmptyForEmptyBatch) {
+  engine.load_model(this->model_path);
+  auto result = engine.infer_batch({});
+  EXPECT_TRUE(result.empty());
+}
+
+TEST_F(TFLiteInferenceEngineTest, InferBatchReturnsEmptyForUnloadedModel) {
+  cv::Mat image(300, 300, CV_8UC3, cv::Scalar(0, 0, 0));
+  auto result = engine.infer_batch({image});
+  EXPECT_TRUE(result.empty());
+}
+
+TEST_F(TFLiteInferenceEngineTest, InferBatchReturnsEmptyForMismatchedImage) {
+  engine.load_model(this->model_path);
+  cv::Mat image(224, 224, CV_8UC3, cv::Scalar(0, 0, 0));
+  auto result = engine.infer_batch({image});
+  EXPECT_TRUE(result.empty());
+}
+
+TEST_F(TFLiteInferenceEngineTest, InputViewReturnsEmptyForUnloadedModel) {
+  EXPECT_TRUE(engine.input_view().empty());
+}
+
+TEST_F(TFLiteInferenceEngineTest, InputViewMatchesInputTensor) {
+  engine.load_model(this->model_path);
+  cv::Mat input = engine.input_view();
+  EXPECT_EQ(input.rows, this->input_height);
+  EXPECT_EQ(input.cols, this->input_width);
+  EXPECT_EQ(input.channels(), this->input_channels);
+  EXPECT_TRUE(input.isContinuous());
+}
+
+TEST_F(TFLiteInferenceEngineTest, InferInPlaceMatchesInfer) {
+  engine.load_model(this->model_path);
+  cv::Mat image = engine.input_view().clone();
+  cv::randu(image, 0, 255);
+
+  auto [locations, classes, scores, num_detections] = engine.infer(image);
+  ASSERT_NE(num_detections, nullptr);
+  const float expected_detections = *num_detections;
+  const float expected_score = scores[0];
+
+  cv::Mat input = engine.input_view();
+  image.copyTo(input);
+  auto result = engine.infer_in_place();
+  ASSERT_NE(std::get<3>(result), nullptr);
+  EXPECT_EQ(*std::get<3>(result), expected_detections);
+  EXPECT_FLOAT_EQ(std::get<2>(result)[0], expected_score);
+}
+
+TEST_F(TFLiteInferenceEngineTest, SetInputReturnsErrorForMismatchedShape) {
+  engine.load_model(this->model_path);
+  cv::Mat image(224, 224, CV_8UC3, cv::Scalar(0, 0, 0));
+  EXPECT_EQ(engine.set_input(image), InferenceStatus::INPUT_ERROR);
+  EXPECT_EQ(std::get<0>(engine.infer(image)), nullptr);
+}
+
+TEST_F(TFLiteInferenceEngineTest, SetInputReturnsErrorForMismatchedType) {
+  engine.load_model(this->model_path);
+  cv::Mat image(300, 300, CV_16UC3, cv::Scalar(0, 0, 0));
+  EXPECT_EQ(engine.set_input(image), InferenceStatus::INPUT_ERROR);
+}
+
+TEST_F(TFLiteInferenceEngineTest, InferReturnsNullptrsForOversizedImage) {
+  engine.load_model(this->model_path);
+  cv::Mat image(600, 600, CV_8UC3, cv::Scalar(0, 0, 0));
+  auto result = engine.infer(image);
+  EXPECT_EQ(std::get<0>(result), nullptr);
+}
+
+TEST_F(TFLiteInferenceEngineTest, LoadModelWithoutDelegateRunsOnCpu) {
+  EngineOptions options;
+  options.delegate = DelegateType::NONE;
+  options.num_threads = 1;
+  auto status = engine.load_model(this->model_path, options);
+  EXPECT_EQ(status, InferenceStatus::SUCCESS);
+  EXPECT_FALSE(engine.is_delegate_applied());
+  EXPECT_EQ(engine.get_num_delegated_nodes(), 0);
+}
+
+TEST_F(TFLiteInferenceEngineTest, LoadModelWithXNNPackReturnsOk) {
+  EngineOptions options;
+  options.delegate = DelegateType::XNNPACK;
+  options.xnnpack.fp16 = true;
+  auto status = engine.load_model(this->model_path, options);
+  EXPECT_EQ(status, InferenceStatus::SUCCESS);
+  if (engine.is_delegate_applied()) {
+    EXPECT_GT(engine.get_num_delegated_nodes(), 0);
+  } else {
+    EXPECT_EQ(engine.get_num_delegated_nodes(), 0);
+  }
+
+  cv::Mat image = cv::Mat::zeros(this->input_height, this->input_width,
+                                 CV_8UC3);
+  auto result = engine.infer(image);
+  EXPECT_NE(std::get<3>(result), nullptr);
+}
+
+TEST_F(TFLiteInferenceEngineTest, WeightsCachePathDependsOnModelContent) {
+  auto model = tflite::FlatBufferModel::BuildFromFile(this->model_path.c_str());
+  ASSERT_NE(model, nullptr);
+  const std::string path = WeightsCache::get_path(this->model_path, *model);
+  EXPECT_EQ(path, WeightsCache::get_path(this->model_path, *model));
+  EXPECT_EQ(std::filesystem::path(path).parent_path(),
+            std::filesystem::path(this->model_path).parent_path());
+  EXPECT_EQ(std::filesystem::path(path).extension(), ".xnnpack_cache");
+}
+
+TEST_F(TFLiteInferenceEngineTest, LoadModelWithWeightsCacheWritesCache) {
+  EngineOptions options;
+  options.delegate = DelegateType::XNNPACK;
+  options.xnnpack.persistent_weights_cache = true;
+  ASSERT_EQ(engine.load_model(this->model_path, options),
+            InferenceStatus::SUCCESS);
+
+  auto model = tflite::FlatBufferModel::BuildFromFile(this->model_path.c_str());
+  const std::string path = WeightsCache::get_path(this->model_path, *model);
+  if (engine.get_num_delegated_nodes() > 0) {
+    EXPECT_TRUE(std::filesystem::exists(path));
+  }
+
+  // A second load reads the cache
+  TFLiteInferenceEngine warm_engine;
+  EXPECT_EQ(warm_engine.load_model(this->model_path, options),
+            InferenceStatus::SUCCESS);
+  std::filesystem::remove(path);
+}
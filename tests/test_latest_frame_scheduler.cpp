@@ -0,0 +1,196 @@
+/**
+ * @file test_latest_frame_scheduler.hpp
+ * @details Test cases for the latest frame mailbox and scheduler
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include <pipeline/latest_frame_scheduler.hpp>
+#include <pipeline/latest_mailbox.hpp>
+#include <thread>
+#include <vector>
+
+using namespace tflite::pipeline;
+
+TEST(LatestMailboxTest, TakeReturnsLatestValue) {
+  LatestMailbox<int> mailbox;
+  EXPECT_FALSE(mailbox.take().has_value());
+
+  EXPECT_TRUE(mailbox.post(1));
+  EXPECT_FALSE(mailbox.post(2));
+  EXPECT_FALSE(mailbox.post(3));
+  EXPECT_TRUE(mailbox.has_value());
+
+  auto value = mailbox.take();
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(*value, 3);
+  EXPECT_FALSE(mailbox.take().has_value());
+
+  EXPECT_TRUE(mailbox.post(4));
+  EXPECT_EQ(*mailbox.take(), 4);
+}
+
+TEST(LatestMailboxTest, ConsumerSeesIncreasingValues) {
+  LatestMailbox<int> mailbox;
+  constexpr int count = 100000;
+  std::atomic<bool> done{false};
+
+  std::thread producer([&mailbox, &done] {
+    for (int i = 1; i <= count; ++i) {
+      mailbox.post(i);
+    }
+    done = true;
+  });
+
+  int last = 0;
+  while (!done || mailbox.has_value()) {
+    if (auto value = mailbox.take()) {
+      ASSERT_GT(*value, last);
+      last = *value;
+    }
+  }
+  producer.join();
+  EXPECT_EQ(last, count);
+}
+
+TEST(LatestMailboxTest, TakeInPlaceReusesSlots) {
+  LatestMailbox<std::vector<int>> mailbox;
+  EXPECT_EQ(mailbox.take_in_place(), nullptr);
+
+  std::vector<int> *back = &mailbox.back();
+  back->assign(4, 1);
+  EXPECT_TRUE(mailbox.publish());
+  std::vector<int> *front = mailbox.take_in_place();
+  ASSERT_EQ(front, back);
+  EXPECT_EQ(*front, std::vector<int>(4, 1));
+
+  // The consumer's slot is never handed back to the producer
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NE(&mailbox.back(), front);
+    mailbox.back().assign(4, 2);
+    mailbox.publish();
+  }
+  EXPECT_EQ(*front, std::vector<int>(4, 1));
+}
+
+class LatestFrameSchedulerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    engine = std::make_shared<tflite::inference::TFLiteInferenceEngine>();
+    auto status = engine->load_model(this->model_path);
+    assert(status == tflite::inference::InferenceStatus::SUCCESS);
+    preprocessor = std::make_shared<tflite::preprocess::Preprocessor>(
+        tflite::preprocess::PreprocessSpec::from_engine(*engine));
+    image = cv::Mat(480, 640, CV_8UC3);
+    cv::randu(image, 0, 255);
+  }
+
+  std::shared_ptr<tflite::inference::TFLiteInferenceEngine> engine;
+  std::shared_ptr<tflite::preprocess::Preprocessor> preprocessor;
+  cv::Mat image;
+  std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v1.tflite";
+};
+
+TEST_F(LatestFrameSchedulerTest, StartFailsWithoutEngine) {
+  LatestFrameScheduler scheduler;
+  EXPECT_FALSE(scheduler.start(nullptr, nullptr, nullptr));
+}
+
+TEST_F(LatestFrameSchedulerTest, FastCaptureDropsFramesAndBoundsLatency) {
+  LatestFrameScheduler scheduler;
+  std::atomic<uint64_t> last_id{0};
+  std::atomic<int> failures{0};
+  ASSERT_TRUE(scheduler.start(engine, preprocessor, [&](Frame &frame) {
+    if (frame.result.status != tflite::inference::InferenceStatus::SUCCESS) {
+      ++failures;
+    }
+    last_id = frame.id;
+  }));
+
+  // Capture much faster than the model runs
+  for (int i = 0; i < 500; ++i) {
+    scheduler.submit(image);
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  scheduler.stop();
+
+  auto stats = scheduler.get_stats();
+  EXPECT_EQ(stats.submitted, 500);
+  EXPECT_EQ(stats.skipped, 0);
+  EXPECT_GT(stats.overwritten, 0);
+  EXPECT_EQ(stats.processed + stats.overwritten, stats.submitted);
+  EXPECT_EQ(last_id, 499);
+  EXPECT_EQ(failures, 0);
+  // A result is never older than the frame in progress plus the latest one
+  EXPECT_LT(stats.max_latency_ms, 1000.0);
+}
+
+TEST_F(LatestFrameSchedulerTest, SubmitCopiesTheImage) {
+  LatestFrameScheduler scheduler;
+  std::atomic<bool> matches{true};
+  std::atomic<int> calls{0};
+  cv::Mat original = image.clone();
+  ASSERT_TRUE(scheduler.start(engine, preprocessor, [&](Frame &frame) {
+    if (cv::norm(frame.image, original, cv::NORM_INF) != 0) {
+      matches = false;
+    }
+    ++calls;
+  }));
+
+  // The capture buffer is overwritten while the worker still runs
+  scheduler.submit(image);
+  image.setTo(cv::Scalar::all(0));
+  scheduler.stop();
+
+  EXPECT_EQ(calls, 1);
+  EXPECT_TRUE(matches);
+}
+
+TEST_F(LatestFrameSchedulerTest, EveryNthSkipsFrames) {
+  SchedulerOptions options;
+  options.policy = FramePolicy::EVERY_NTH;
+  options.every_n = 5;
+  LatestFrameScheduler scheduler(options);
+
+  std::vector<uint64_t> ids;
+  ASSERT_TRUE(scheduler.start(engine, preprocessor,
+                              [&ids](Frame &frame) { ids.push_back(frame.id); }));
+  int accepted = 0;
+  for (int i = 0; i < 20; ++i) {
+    accepted += scheduler.submit(image) ? 1 : 0;
+  }
+  scheduler.stop();
+
+  EXPECT_EQ(accepted, 4);
+  auto stats = scheduler.get_stats();
+  EXPECT_EQ(stats.skipped, 16);
+  for (auto id : ids) {
+    EXPECT_EQ(id % 5, 0);
+  }
+}
+
+TEST_F(LatestFrameSchedulerTest, TargetFpsLimitsAcceptedFrames) {
+  SchedulerOptions options;
+  options.policy = FramePolicy::TARGET_FPS;
+  options.target_fps = 10.0;
+  LatestFrameScheduler scheduler(options);
+  ASSERT_TRUE(scheduler.start(engine, preprocessor, nullptr));
+
+  int accepted = 0;
+  const auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start <
+         std::chrono::milliseconds(500)) {
+    accepted += scheduler.submit(image) ? 1 : 0;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  scheduler.stop();
+
+  EXPECT_GE(accepted, 4);
+  EXPECT_LE(accepted, 6);
+  EXPECT_GT(scheduler.get_stats().skipped, 0);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file test_logger.hpp
+ * @details Test cases for the synchronous and asynchronous logger
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <log/log.hpp>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace tflite::logging;
+
+namespace {
+size_t count_lines(const std::string &text, const std::string &pattern) {
+  size_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+} // namespace
+
+class LoggerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    auto &logger = Logger::get_instance();
+    logger.setOutput(this->m_output);
+    logger.set_level(Logger::Level::DEBUG);
+    logger.set_rate_limit(0);
+  }
+  void TearDown() override {
+    auto &logger = Logger::get_instance();
+    logger.stop_async();
+    logger.setOutput(std::cout);
+    logger.set_rate_limit(-1);
+  }
+
+  std::stringstream m_output;
+};
+
+TEST_F(LoggerTest, SynchronousMessage) {
+  LOG_WARNING("value ", 42, " ratio ", 0.5);
+  const std::string text = this->m_output.str();
+  EXPECT_NE(text.find("[WARNING]"), std::string::npos);
+  EXPECT_NE(text.find("value 42 ratio 0.5"), std::string::npos);
+}
+
+TEST_F(LoggerTest, RuntimeLevel) {
+  Logger::get_instance().set_level(Logger::Level::ERROR);
+  LOG_INFO("hidden");
+  LOG_ERROR("shown");
+  EXPECT_EQ(this->m_output.str().find("hidden"), std::string::npos);
+  EXPECT_NE(this->m_output.str().find("shown"), std::string::npos);
+}
+
+TEST_F(LoggerTest, LongMessageIsTruncated) {
+  LOG_INFO(std::string(2 * Logger::MAX_MESSAGE_LENGTH, 'x'));
+  const std::string text = this->m_output.str();
+  EXPECT_EQ(count_lines(text, "x"), Logger::MAX_MESSAGE_LENGTH - 3);
+  EXPECT_NE(text.find("x..."), std::string::npos);
+}
+
+TEST(RateLimiterTest, ReportsSuppressedMessages) {
+  RateLimiter limiter;
+  EXPECT_EQ(limiter.acquire(2, 10), 0);
+  EXPECT_EQ(limiter.acquire(2, 10), 0);
+  EXPECT_EQ(limiter.acquire(2, 10), RateLimiter::SUPPRESSED);
+  EXPECT_EQ(limiter.acquire(2, 10), RateLimiter::SUPPRESSED);
+  // The first message of the next second carries the count
+  EXPECT_EQ(limiter.acquire(2, 11), 2);
+  EXPECT_EQ(limiter.acquire(0, 11), 0);
+}
+
+TEST_F(LoggerTest, RateLimitPerCallSite) {
+  Logger::get_instance().set_rate_limit(5);
+  for (int i = 0; i < 50; ++i) {
+    LOG_ERROR("storm");
+  }
+  LOG_ERROR("other call site");
+  // Messages of a call site spread over a second boundary may exceed 5
+  EXPECT_LE(count_lines(this->m_output.str(), "storm"), 10);
+  EXPECT_EQ(count_lines(this->m_output.str(), "other call site"), 1);
+}
+
+TEST_F(LoggerTest, DefaultRateLimitOnlyAppliesAsynchronously) {
+  auto &logger = Logger::get_instance();
+  logger.set_rate_limit(-1);
+  EXPECT_EQ(logger.get_rate_limit(), 0);
+  for (int i = 0; i < 2 * Logger::DEFAULT_ASYNC_RATE_LIMIT; ++i) {
+    LOG_ERROR("synchronous storm");
+  }
+  EXPECT_EQ(count_lines(this->m_output.str(), "synchronous storm"),
+            2 * Logger::DEFAULT_ASYNC_RATE_LIMIT);
+
+  logger.start_async(1024);
+  EXPECT_EQ(logger.get_rate_limit(), Logger::DEFAULT_ASYNC_RATE_LIMIT);
+  logger.stop_async();
+  EXPECT_EQ(logger.get_rate_limit(), 0);
+}
+
+TEST_F(LoggerTest, AsynchronousMessagesFromThreads) {
+  auto &logger = Logger::get_instance();
+  logger.start_async(1024);
+
+  constexpr int THREADS = 4;
+  constexpr int MESSAGES = 100;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([t] {
+      for (int i = 0; i < MESSAGES; ++i) {
+        LOG_INFO("async ", t, ":", i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  logger.flush();
+
+  const std::string text = this->m_output.str();
+  EXPECT_EQ(count_lines(text, "async "), THREADS * MESSAGES);
+  EXPECT_NE(text.find("async 3:99"), std::string::npos);
+}
+
+TEST_F(LoggerTest, FullBufferDropsInsteadOfBlocking) {
+  auto &logger = Logger::get_instance();
+  logger.start_async(4);
+  const uint64_t dropped = logger.get_num_dropped();
+
+  // A new thread gets a buffer of the new capacity
+  std::thread([] {
+    for (int i = 0; i < 10000; ++i) {
+      LOG_DEBUG("flood ", i);
+    }
+  }).join();
+  logger.stop_async();
+
+  const size_t written = count_lines(this->m_output.str(), "flood ");
+  EXPECT_EQ(written + (logger.get_num_dropped() - dropped), 10000);
+}
+
+TEST_F(LoggerTest, BuffersOfExitedThreadsAreDropped) {
+  auto &logger = Logger::get_instance();
+  logger.start_async(16);
+  const size_t buffers = logger.num_buffers();
+
+  constexpr int THREADS = 50;
+  for (int t = 0; t < THREADS; ++t) {
+    std::thread([t] { LOG_INFO("short-lived ", t); }).join();
+  }
+  logger.flush();
+  EXPECT_EQ(count_lines(this->m_output.str(), "short-lived "), THREADS);
+
+  // The writer drops the drained buffers on its next pass
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (logger.num_buffers() > buffers &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_LE(logger.num_buffers(), buffers);
+}
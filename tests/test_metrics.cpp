@@ -0,0 +1,229 @@
+/**
+ * @file test_metrics.hpp
+ * @details Test cases for the latency histograms and the metrics registry
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <arpa/inet.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <gtest/gtest.h>
+#include <infer/infer.hpp>
+#include <memory>
+#include <metrics/metrics_registry.hpp>
+#include <metrics/metrics_server.hpp>
+#include <metrics/per_thread.hpp>
+#include <metrics/stage_metrics.hpp>
+#include <netinet/in.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <utils/scoped_timer.hpp>
+#include <vector>
+
+using namespace tflite::metrics;
+
+TEST(HistogramTest, BucketValueWithinResolution) {
+  for (uint64_t value : {0ULL, 1ULL, 31ULL, 32ULL, 100ULL, 1000ULL,
+                         123456ULL, 987654321ULL, 1ULL << 40}) {
+    const uint64_t bucket =
+        Histogram::bucket_value(Histogram::bucket_index(value));
+    const double error =
+        std::abs(static_cast<double>(bucket) - static_cast<double>(value));
+    EXPECT_LE(error, 0.03 * static_cast<double>(value)) << value;
+  }
+  EXPECT_EQ(Histogram::bucket_index(UINT64_MAX), Histogram::NUM_BUCKETS - 1);
+}
+
+TEST(HistogramTest, Percentiles) {
+  Histogram histogram;
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.record(i * 1000);
+  }
+  const HistogramSnapshot snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 1000);
+  EXPECT_EQ(snapshot.max, 1000000);
+  EXPECT_DOUBLE_EQ(snapshot.mean(), 500500.0);
+  EXPECT_NEAR(snapshot.percentile(0.5), 500000, 500000 * 0.03);
+  EXPECT_NEAR(snapshot.percentile(0.99), 990000, 990000 * 0.03);
+  EXPECT_EQ(snapshot.percentile(1.0), 1000000);
+  EXPECT_EQ(HistogramSnapshot().percentile(0.5), 0);
+}
+
+TEST(HistogramTest, ConcurrentRecording) {
+  Histogram histogram;
+  Counter counter;
+  constexpr int THREADS = 4;
+  constexpr int RECORDS = 10000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&histogram, &counter] {
+      for (int i = 0; i < RECORDS; ++i) {
+        histogram.record(uint64_t{100});
+        counter.increment();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  const HistogramSnapshot snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, THREADS * RECORDS);
+  EXPECT_EQ(snapshot.sum, uint64_t{100} * THREADS * RECORDS);
+  EXPECT_EQ(counter.value(), THREADS * RECORDS);
+}
+
+namespace {
+struct CountShard {
+  std::atomic<uint64_t> value{0};
+};
+} // namespace
+
+TEST(PerThreadTest, ShardsOfExitedThreadsAreReused) {
+  PerThread<CountShard> shards;
+  constexpr int THREADS = 8;
+  for (int t = 0; t < THREADS; ++t) {
+    std::thread([&shards] {
+      add_single_writer(shards.local().value, 1);
+    }).join();
+  }
+
+  EXPECT_EQ(shards.num_shards(), 1);
+  uint64_t total = 0;
+  shards.for_each([&total](const CountShard &shard) {
+    total += shard.value.load(std::memory_order_relaxed);
+  });
+  EXPECT_EQ(total, THREADS);
+}
+
+TEST(PerThreadTest, ThreadMayOutliveInstance) {
+  auto shards = std::make_unique<PerThread<CountShard>>();
+  std::thread thread;
+  {
+    std::promise<void> recorded;
+    std::future<void> done = recorded.get_future();
+    std::promise<void> destroyed;
+    std::shared_future<void> release = destroyed.get_future().share();
+    thread = std::thread([&shards, &recorded, release] {
+      add_single_writer(shards->local().value, 1);
+      recorded.set_value();
+      release.wait();
+    });
+    done.wait();
+    shards.reset();
+    destroyed.set_value();
+  }
+  thread.join();
+}
+
+TEST(HistogramTest, ScopedTimerRecordsOnce) {
+  Histogram histogram;
+  {
+    utils::timer::ScopedTimer timer(histogram);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  const HistogramSnapshot snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 1);
+  EXPECT_GE(snapshot.sum, 2000000);
+}
+
+TEST(MetricsRegistryTest, SameNameAndLabelsSameMetric) {
+  auto &registry = MetricsRegistry::get_instance();
+  auto &first = registry.histogram("test_lookup_seconds", "Lookup",
+                                   {{"model", "a"}});
+  auto &second = registry.histogram("test_lookup_seconds", "Lookup",
+                                    {{"model", "a"}});
+  auto &other = registry.histogram("test_lookup_seconds", "Lookup",
+                                   {{"model", "b"}});
+  EXPECT_EQ(&first, &second);
+  EXPECT_NE(&first, &other);
+}
+
+TEST(MetricsRegistryTest, PrometheusText) {
+  auto &registry = MetricsRegistry::get_instance();
+  registry.histogram("test_export_seconds", "Export", {{"stage", "x"}})
+      .record(uint64_t{2000000});
+  registry.counter("test_export_total", "Export").increment(3);
+
+  const std::string text = registry.to_prometheus();
+  EXPECT_NE(text.find("# TYPE test_export_seconds summary"), std::string::npos);
+  EXPECT_NE(text.find("test_export_seconds{stage=\"x\",quantile=\"0.99\"}"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_export_seconds_sum{stage=\"x\"} 0.002"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_export_seconds_count{stage=\"x\"} 1"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_export_total counter"), std::string::npos);
+  EXPECT_NE(text.find("test_export_total 3"), std::string::npos);
+}
+
+TEST(MetricsRegistryTest, WritePrometheusFile) {
+  auto &registry = MetricsRegistry::get_instance();
+  registry.counter("test_file_total", "File").increment();
+
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "test_metrics.prom").string();
+  ASSERT_TRUE(registry.write_prometheus(path));
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  EXPECT_NE(content.str().find("test_file_total"), std::string::npos);
+  std::remove(path.c_str());
+}
+
+TEST(MetricsServerTest, ServesMetrics) {
+  MetricsRegistry::get_instance().counter("test_server_total", "Server");
+  MetricsServer server;
+  ASSERT_TRUE(server.start(0));
+  ASSERT_NE(server.get_port(), 0);
+
+  const int client = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_GE(client, 0);
+  sockaddr_in endpoint{};
+  endpoint.sin_family = AF_INET;
+  endpoint.sin_port = htons(server.get_port());
+  inet_pton(AF_INET, "127.0.0.1", &endpoint.sin_addr);
+  ASSERT_EQ(connect(client, reinterpret_cast<sockaddr *>(&endpoint),
+                    sizeof(endpoint)),
+            0);
+
+  const std::string request = "GET /metrics HTTP/1.1\r\n\r\n";
+  send(client, request.data(), request.size(), 0);
+  std::string response;
+  char buffer[4096];
+  ssize_t received;
+  while ((received = recv(client, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, static_cast<size_t>(received));
+  }
+  close(client);
+  server.stop();
+
+  EXPECT_EQ(response.rfind("HTTP/1.1 200 OK", 0), 0);
+  EXPECT_NE(response.find("test_server_total"), std::string::npos);
+}
+
+TEST(StageMetricsTest, InvokeIsRecorded) {
+  tflite::inference::TFLiteInferenceEngine engine;
+  const std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v1.tflite";
+  ASSERT_EQ(engine.load_model(model_path),
+            tflite::inference::InferenceStatus::SUCCESS);
+
+  auto &metrics = StageMetrics::get();
+  const uint64_t loads = metrics.model_load.snapshot().count;
+  const uint64_t invokes = metrics.invoke.snapshot().count;
+  EXPECT_GE(loads, 1);
+
+  cv::Mat image(300, 300, CV_8UC3, cv::Scalar(0, 0, 0));
+  ASSERT_EQ(engine.set_input(image),
+            tflite::inference::InferenceStatus::SUCCESS);
+  ASSERT_EQ(engine.invoke(), tflite::inference::InferenceStatus::SUCCESS);
+  EXPECT_EQ(metrics.invoke.snapshot().count, invokes + 1);
+}
@@ -0,0 +1,89 @@
+/**
+ * @file test_model_registry.hpp
+ * @details Test cases for the model registry
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <infer/infer.hpp>
+#include <infer/model_registry.hpp>
+#include <iterator>
+#include <vector>
+
+using namespace tflite::inference;
+
+class ModelRegistryTest : public ::testing::Test {
+protected:
+  std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v1.tflite";
+};
+
+TEST_F(ModelRegistryTest, LoadReturnsNullptrForInvalidPath) {
+  EXPECT_EQ(ModelRegistry::get_instance().load("invalid/model.tflite"),
+            nullptr);
+}
+
+TEST_F(ModelRegistryTest, LoadSharesModelForSamePath) {
+  auto first = ModelRegistry::get_instance().load(this->model_path);
+  auto second = ModelRegistry::get_instance().load(
+      std::string(PROJECT_SOURCE_DIR) + "/models/../models/" +
+      "mobilenet_ssd_v1.tflite");
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first, second);
+}
+
+TEST_F(ModelRegistryTest, LoadReleasesModelWithoutEngines) {
+  const tflite::FlatBufferModel *address = nullptr;
+  {
+    TFLiteInferenceEngine engine;
+    ASSERT_EQ(engine.load_model(this->model_path), InferenceStatus::SUCCESS);
+    address = ModelRegistry::get_instance().load(this->model_path).get();
+  }
+  EXPECT_EQ(ModelRegistry::get_instance().size(), 0);
+  EXPECT_NE(address, nullptr);
+}
+
+TEST_F(ModelRegistryTest, LoadModelFromBufferReturnsOk) {
+  std::ifstream file(this->model_path, std::ios::binary);
+  std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+
+  TFLiteInferenceEngine first;
+  TFLiteInferenceEngine second;
+  EXPECT_EQ(first.load_model_from_buffer(buffer.data(), buffer.size()),
+            InferenceStatus::SUCCESS);
+  EXPECT_EQ(second.load_model_from_buffer(buffer.data(), buffer.size()),
+            InferenceStatus::SUCCESS);
+  EXPECT_EQ(first.get_input_height(), 300);
+  EXPECT_EQ(ModelRegistry::get_instance().size(), 1);
+}
+
+TEST_F(ModelRegistryTest, LoadFromBufferKeepsSeparateBuffersApart) {
+  std::ifstream file(this->model_path, std::ios::binary);
+  std::vector<char> first_buffer((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+  std::vector<char> second_buffer = first_buffer;
+
+  auto &registry = ModelRegistry::get_instance();
+  auto first = registry.load_from_buffer(first_buffer.data(),
+                                         first_buffer.size());
+  auto second = registry.load_from_buffer(second_buffer.data(),
+                                          second_buffer.size());
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(second->allocation()->base(),
+            static_cast<const void *>(second_buffer.data()));
+  EXPECT_EQ(registry.load_from_buffer(first_buffer.data(),
+                                      first_buffer.size()),
+            first);
+}
+
+TEST_F(ModelRegistryTest, LoadModelFromBufferReturnsErrorForEmptyBuffer) {
+  TFLiteInferenceEngine engine;
+  EXPECT_EQ(engine.load_model_from_buffer(nullptr, 0),
+            InferenceStatus::MODEL_LOAD_ERROR);
+}
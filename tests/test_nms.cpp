@@ -0,0 +1,164 @@
+/**
+ * @file test_nms.hpp
+ * @details Test cases for the structure-of-arrays non-maximum suppression
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <postprocess/nms.hpp>
+#include <random>
+#include <vector>
+
+using namespace tflite::postprocess;
+using utils::cpu::SimdLevel;
+
+namespace {
+BoxStore make_random_boxes(size_t count, int num_classes, unsigned seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> position(0.0f, 1000.0f);
+  std::uniform_real_distribution<float> size(10.0f, 120.0f);
+  std::uniform_real_distribution<float> score(0.0f, 1.0f);
+  std::uniform_int_distribution<int> class_id(0, num_classes - 1);
+  BoxStore boxes(count);
+  for (size_t i = 0; i < count; ++i) {
+    boxes.push_back_center(position(generator), position(generator),
+                           size(generator), size(generator), score(generator),
+                           class_id(generator));
+  }
+  return boxes;
+}
+
+// Straightforward O(n^2) suppression with a division per pair
+std::vector<uint32_t> reference_nms(const BoxStore &boxes,
+                                    const NmsOptions &options) {
+  std::vector<uint32_t> order;
+  for (uint32_t i = 0; i < boxes.size(); ++i) {
+    if (boxes.scores()[i] >= options.score_threshold) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return boxes.scores()[a] > boxes.scores()[b];
+  });
+  std::vector<uint32_t> keep;
+  for (uint32_t candidate : order) {
+    bool suppressed = false;
+    for (uint32_t kept : keep) {
+      if (options.class_aware &&
+          boxes.classes()[kept] != boxes.classes()[candidate]) {
+        continue;
+      }
+      const float width =
+          std::min(boxes.x2()[kept], boxes.x2()[candidate]) -
+          std::max(boxes.x1()[kept], boxes.x1()[candidate]);
+      const float height =
+          std::min(boxes.y2()[kept], boxes.y2()[candidate]) -
+          std::max(boxes.y1()[kept], boxes.y1()[candidate]);
+      if (width <= 0.0f || height <= 0.0f) {
+        continue;
+      }
+      const float intersection = width * height;
+      const float area_a = (boxes.x2()[kept] - boxes.x1()[kept]) *
+                           (boxes.y2()[kept] - boxes.y1()[kept]);
+      const float area_b = (boxes.x2()[candidate] - boxes.x1()[candidate]) *
+                           (boxes.y2()[candidate] - boxes.y1()[candidate]);
+      if (intersection / (area_a + area_b - intersection) >
+          options.threshold) {
+        suppressed = true;
+        break;
+      }
+    }
+    if (!suppressed) {
+      keep.push_back(candidate);
+    }
+  }
+  return keep;
+}
+} // namespace
+
+TEST(NonMaxSuppressionTest, SuppressesWithinClass) {
+  BoxStore boxes;
+  boxes.push_back(0, 0, 100, 100, 0.9f, 0);
+  boxes.push_back(10, 10, 110, 110, 0.8f, 0);
+  boxes.push_back(10, 10, 110, 110, 0.7f, 1);
+  boxes.push_back(300, 300, 400, 400, 0.6f, 0);
+
+  NonMaxSuppression nms;
+  std::vector<uint32_t> keep;
+  nms.run(boxes, NmsOptions(), keep);
+  EXPECT_EQ(keep, std::vector<uint32_t>({0, 2, 3}));
+
+  NmsOptions class_agnostic;
+  class_agnostic.class_aware = false;
+  nms.run(boxes, class_agnostic, keep);
+  EXPECT_EQ(keep, std::vector<uint32_t>({0, 3}));
+}
+
+TEST(NonMaxSuppressionTest, ScoreThresholdTopKAndMaxDetections) {
+  BoxStore boxes;
+  for (int i = 0; i < 10; ++i) {
+    // Disjoint boxes, score increasing with the index
+    boxes.push_back(200.0f * i, 0, 200.0f * i + 100, 100, 0.1f * i, i % 2);
+  }
+
+  NonMaxSuppression nms;
+  std::vector<uint32_t> keep;
+  NmsOptions options;
+  options.score_threshold = 0.45f;
+  nms.run(boxes, options, keep);
+  EXPECT_EQ(keep, std::vector<uint32_t>({9, 8, 7, 6, 5}));
+
+  options.top_k = 3;
+  nms.run(boxes, options, keep);
+  EXPECT_EQ(keep, std::vector<uint32_t>({9, 8, 7}));
+
+  options.top_k = 0;
+  options.max_detections = 2;
+  nms.run(boxes, options, keep);
+  EXPECT_EQ(keep, std::vector<uint32_t>({9, 8}));
+}
+
+TEST(NonMaxSuppressionTest, MatchesReferenceOnEveryKernel) {
+  const BoxStore boxes = make_random_boxes(3000, 5, 7);
+  for (bool class_aware : {true, false}) {
+    NmsOptions options;
+    options.threshold = 0.45f;
+    options.score_threshold = 0.2f;
+    options.class_aware = class_aware;
+    const std::vector<uint32_t> expected = reference_nms(boxes, options);
+
+    for (SimdLevel level :
+         {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2}) {
+      NonMaxSuppression nms;
+      nms.set_simd_level(level);
+      std::vector<uint32_t> keep;
+      nms.run(boxes, options, keep);
+      EXPECT_EQ(keep, expected) << utils::cpu::to_string(nms.get_simd_level());
+    }
+  }
+}
+
+TEST(NonMaxSuppressionTest, Batch) {
+  std::vector<BoxStore> batch;
+  batch.push_back(make_random_boxes(500, 3, 1));
+  batch.push_back(BoxStore());
+  batch.push_back(make_random_boxes(800, 3, 2));
+
+  NonMaxSuppression nms;
+  std::vector<std::vector<uint32_t>> keep;
+  nms.run_batch(batch, NmsOptions(), keep);
+  ASSERT_EQ(keep.size(), 3);
+  EXPECT_EQ(keep[0], reference_nms(batch[0], NmsOptions()));
+  EXPECT_TRUE(keep[1].empty());
+  EXPECT_EQ(keep[2], reference_nms(batch[2], NmsOptions()));
+}
+
+TEST(NonMaxSuppressionTest, RectOverload) {
+  const std::vector<cv::Rect> boxes = {cv::Rect(0, 0, 100, 100),
+                                       cv::Rect(5, 5, 100, 100)};
+  EXPECT_EQ(nms(boxes, {3, 3}, {0.2f, 0.9f}, 0.5f),
+            std::vector<size_t>({1}));
+  EXPECT_FLOAT_EQ(overlap(boxes[0], boxes[0]), 1.0f);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file test_op_profiler.hpp
+ * @details Test cases for the per-operator profiler
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <infer/infer.hpp>
+#include <infer/op_profiler.hpp>
+#include <opencv2/opencv.hpp>
+
+using namespace tflite::inference;
+
+TEST(OpProfilerTest, SummarizeComputesNearestRankPercentiles) {
+  std::vector<double> samples;
+  for (int i = 100; i >= 1; --i) {
+    samples.push_back(static_cast<double>(i));
+  }
+  auto stats = OpProfiler::summarize("CONV_2D", 3, OpBackend::CPU, samples);
+  EXPECT_EQ(stats.type, "CONV_2D");
+  EXPECT_EQ(stats.node, 3);
+  EXPECT_EQ(stats.count, 100);
+  EXPECT_DOUBLE_EQ(stats.total_us, 5050.0);
+  EXPECT_DOUBLE_EQ(stats.mean_us, 50.5);
+  EXPECT_DOUBLE_EQ(stats.p50_us, 50.0);
+  EXPECT_DOUBLE_EQ(stats.p99_us, 99.0);
+}
+
+TEST(OpProfilerTest, SummarizeHandlesSingleAndNoSample) {
+  auto single = OpProfiler::summarize("ADD", 0, OpBackend::CPU, {7.0});
+  EXPECT_DOUBLE_EQ(single.p50_us, 7.0);
+  EXPECT_DOUBLE_EQ(single.p99_us, 7.0);
+
+  auto none = OpProfiler::summarize("ADD", 0, OpBackend::CPU, {});
+  EXPECT_EQ(none.count, 0);
+  EXPECT_DOUBLE_EQ(none.mean_us, 0.0);
+}
+
+TEST(OpProfilerTest, ReportSortsByKey) {
+  ProfileReport report;
+  report.ops.push_back(OpProfiler::summarize("B", 1, OpBackend::CPU, {1.0}));
+  report.ops.push_back(OpProfiler::summarize("A", 0, OpBackend::CPU, {5.0}));
+  report.ops.push_back(OpProfiler::summarize("C", 2, OpBackend::CPU, {3.0}));
+
+  report.sort(ProfileReport::SortKey::TOTAL);
+  EXPECT_EQ(report.ops[0].type, "A");
+  EXPECT_EQ(report.ops[2].type, "B");
+
+  report.sort(ProfileReport::SortKey::NODE);
+  EXPECT_EQ(report.ops[0].node, 0);
+  EXPECT_EQ(report.ops[2].node, 2);
+
+  report.sort(ProfileReport::SortKey::TYPE);
+  EXPECT_EQ(report.ops[1].type, "B");
+}
+
+TEST(OpProfilerTest, ProfilingDisabledByDefault) {
+  TFLiteInferenceEngine engine;
+  ASSERT_EQ(engine.load_model(std::string(PROJECT_SOURCE_DIR) +
+                              "/models/deeplabv3.tflite"),
+            InferenceStatus::SUCCESS);
+  cv::Mat image(257, 257, CV_32FC3, cv::Scalar::all(0.5));
+  engine.infer(image);
+  EXPECT_EQ(engine.get_profile().invocations, 0);
+  EXPECT_TRUE(engine.get_profile().ops.empty());
+}
+
+TEST(OpProfilerTest, EngineReportsEveryOperator) {
+  EngineOptions options;
+  options.enable_profiling = true;
+  options.delegate = DelegateType::NONE;
+
+  TFLiteInferenceEngine engine;
+  ASSERT_EQ(engine.load_model(std::string(PROJECT_SOURCE_DIR) +
+                                  "/models/deeplabv3.tflite",
+                              options),
+            InferenceStatus::SUCCESS);
+
+  cv::Mat image(257, 257, CV_32FC3, cv::Scalar::all(0.5));
+  engine.infer(image);
+  engine.reset_profile();
+  for (int i = 0; i < 5; ++i) {
+    engine.infer(image);
+  }
+
+  auto report = engine.get_profile(ProfileReport::SortKey::MEAN);
+  EXPECT_EQ(report.invocations, 5);
+  ASSERT_FALSE(report.ops.empty());
+  ASSERT_FALSE(report.op_types.empty());
+  EXPECT_LE(report.op_types.size(), report.ops.size());
+  EXPECT_DOUBLE_EQ(report.delegate_us, 0.0);
+  EXPECT_GT(report.cpu_us, 0.0);
+  for (const auto &op : report.ops) {
+    EXPECT_EQ(op.count, 5);
+    EXPECT_EQ(op.backend, OpBackend::CPU);
+    EXPECT_LE(op.p50_us, op.p99_us);
+  }
+  for (size_t i = 1; i < report.ops.size(); ++i) {
+    EXPECT_GE(report.ops[i - 1].mean_us, report.ops[i].mean_us);
+  }
+
+  const std::string json = report.to_json();
+  EXPECT_EQ(json.front(), '{');
+  EXPECT_EQ(json.back(), '}');
+  EXPECT_NE(json.find("\"op_types\""), std::string::npos);
+  EXPECT_NE(report.to_text().find("CONV_2D"), std::string::npos);
+}
+
+TEST(OpProfilerTest, DelegatedNodesAreSplitFromCpu) {
+  EngineOptions options;
+  options.enable_profiling = true;
+  options.delegate = DelegateType::XNNPACK;
+
+  TFLiteInferenceEngine engine;
+  ASSERT_EQ(engine.load_model(std::string(PROJECT_SOURCE_DIR) +
+                                  "/models/deeplabv3.tflite",
+                              options),
+            InferenceStatus::SUCCESS);
+  if (engine.get_num_delegated_nodes() == 0) {
+    GTEST_SKIP() << "XNNPACK delegate not available";
+  }
+
+  cv::Mat image(257, 257, CV_32FC3, cv::Scalar::all(0.5));
+  engine.infer(image);
+  auto report = engine.get_profile();
+  EXPECT_GT(report.delegate_us, 0.0);
+}
@@ -0,0 +1,201 @@
+/**
+ * @file test_pipeline.hpp
+ * @details Test cases for the multi-stage video pipeline
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <atomic>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include <pipeline/pipeline.hpp>
+#include <pipeline/spsc_queue.hpp>
+#include <pipeline/stages.hpp>
+#include <thread>
+#include <vector>
+
+using namespace tflite::pipeline;
+
+TEST(SPSCQueueTest, CapacityIsRoundedUpToPowerOfTwo) {
+  SPSCQueue<int> queue(3);
+  EXPECT_EQ(queue.capacity(), 4);
+}
+
+TEST(SPSCQueueTest, PushFailsWhenFullAndKeepsValue) {
+  SPSCQueue<std::vector<int>> queue(2);
+  std::vector<int> value{1, 2, 3};
+  EXPECT_TRUE(queue.try_push(value));
+  value = {4, 5, 6};
+  EXPECT_TRUE(queue.try_push(value));
+  value = {7, 8, 9};
+  EXPECT_FALSE(queue.try_push(value));
+  EXPECT_EQ(value.size(), 3);
+  EXPECT_EQ(queue.size(), 2);
+
+  EXPECT_EQ(queue.try_pop()->front(), 1);
+  EXPECT_EQ(queue.try_pop()->front(), 4);
+  EXPECT_FALSE(queue.try_pop().has_value());
+}
+
+TEST(SPSCQueueTest, KeepsOrderAcrossThreads) {
+  SPSCQueue<int> queue(8);
+  constexpr int count = 100000;
+
+  std::thread producer([&queue] {
+    for (int i = 0; i < count; ++i) {
+      int value = i;
+      while (!queue.try_push(value)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  while (expected < count) {
+    if (auto value = queue.try_pop()) {
+      ASSERT_EQ(*value, expected);
+      ++expected;
+    }
+  }
+  producer.join();
+}
+
+TEST(PipelineTest, StartFailsWithoutStages) {
+  Pipeline pipeline;
+  EXPECT_FALSE(pipeline.start());
+  pipeline.set_source("source", [](Frame &) { return false; });
+  EXPECT_FALSE(pipeline.start());
+}
+
+TEST(PipelineTest, FramesPassAllStagesInOrder) {
+  Pipeline pipeline(2);
+  pipeline.set_source("source", [](Frame &frame) {
+    if (frame.id >= 50) {
+      return false;
+    }
+    frame.image = cv::Mat(8, 8, CV_8UC1, cv::Scalar(frame.id % 256));
+    return true;
+  });
+  pipeline.add_stage("double", [](Frame &frame) { frame.image *= 2; });
+
+  std::vector<uint64_t> ids;
+  std::vector<int> values;
+  pipeline.add_stage("sink", [&ids, &values](Frame &frame) {
+    ids.push_back(frame.id);
+    values.push_back(frame.image.at<uchar>(0, 0));
+  });
+
+  ASSERT_TRUE(pipeline.start());
+  pipeline.wait();
+
+  ASSERT_EQ(ids.size(), 50);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    EXPECT_EQ(ids[i], i);
+    EXPECT_EQ(values[i], static_cast<int>(2 * i));
+  }
+
+  auto stats = pipeline.get_stats();
+  ASSERT_EQ(stats.size(), 3);
+  EXPECT_EQ(stats[0].name, "source");
+  EXPECT_EQ(stats[2].name, "sink");
+  for (const auto &stage : stats) {
+    EXPECT_EQ(stage.frames, 50);
+  }
+  EXPECT_EQ(stats[1].queue_capacity, 2);
+  EXPECT_LE(stats[1].max_queue_depth, 2);
+}
+
+TEST(PipelineTest, StopEndsEndlessSource) {
+  Pipeline pipeline;
+  pipeline.set_source("source", [](Frame &frame) {
+    frame.image = cv::Mat(4, 4, CV_8UC1);
+    return true;
+  });
+  pipeline.add_stage("sink", [](Frame &) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  });
+
+  ASSERT_TRUE(pipeline.start());
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  pipeline.stop();
+  EXPECT_GT(pipeline.get_stats()[1].frames, 0);
+}
+
+TEST(PipelineTest, VideoSourceReadsFile) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "test_pipeline.avi").string();
+  {
+    cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'),
+                           10, cv::Size(64, 48));
+    if (!writer.isOpened()) {
+      GTEST_SKIP() << "No video encoder available";
+    }
+    for (int i = 0; i < 12; ++i) {
+      writer.write(cv::Mat(48, 64, CV_8UC3, cv::Scalar::all(i * 20)));
+    }
+  }
+
+  VideoSource source(path, 10);
+  ASSERT_TRUE(source.is_opened());
+
+  Pipeline pipeline;
+  pipeline.set_source("video", source);
+  std::atomic<int> frames{0};
+  pipeline.add_stage("sink", [&frames](Frame &frame) {
+    EXPECT_EQ(frame.image.size(), cv::Size(64, 48));
+    ++frames;
+  });
+  ASSERT_TRUE(pipeline.start());
+  pipeline.wait();
+
+  EXPECT_EQ(frames, 10);
+  std::filesystem::remove(path);
+}
+
+TEST(PipelineTest, DetectionPipelineMatchesSynchronousInference) {
+  const std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v1.tflite";
+  auto engine = std::make_shared<tflite::inference::TFLiteInferenceEngine>();
+  ASSERT_EQ(engine->load_model(model_path),
+            tflite::inference::InferenceStatus::SUCCESS);
+  auto preprocessor = std::make_shared<tflite::preprocess::Preprocessor>(
+      tflite::preprocess::PreprocessSpec::from_engine(*engine));
+
+  cv::Mat image(300, 300, CV_8UC3);
+  cv::randu(image, 0, 255);
+
+  tflite::inference::TFLiteInferenceEngine sync_engine;
+  ASSERT_EQ(sync_engine.load_model(model_path),
+            tflite::inference::InferenceStatus::SUCCESS);
+  cv::Mat input = sync_engine.input_view();
+  ASSERT_EQ(preprocessor->run(image, input),
+            tflite::inference::InferenceStatus::SUCCESS);
+  auto [locations, classes, scores, num_detections] =
+      sync_engine.infer_in_place();
+  ASSERT_NE(scores, nullptr);
+
+  Pipeline pipeline;
+  pipeline.set_source("source", [&image](Frame &frame) {
+    frame.image = image;
+    return frame.id < 3;
+  });
+  pipeline.add_stage("preprocess", make_preprocess_stage(preprocessor));
+  pipeline.add_stage("inference", make_inference_stage(engine));
+  pipeline.add_stage("postprocess", make_detection_postprocess_stage());
+
+  std::vector<Frame> frames;
+  pipeline.add_stage("sink",
+                     [&frames](Frame &frame) { frames.push_back(frame); });
+  ASSERT_TRUE(pipeline.start());
+  pipeline.wait();
+
+  ASSERT_EQ(frames.size(), 3);
+  for (const auto &frame : frames) {
+    ASSERT_EQ(frame.result.status,
+              tflite::inference::InferenceStatus::SUCCESS);
+    EXPECT_FLOAT_EQ(frame.result.output(2)[0], scores[0]);
+    EXPECT_EQ(frame.result.output(3)[0], num_detections[0]);
+  }
+}
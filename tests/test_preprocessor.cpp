@@ -0,0 +1,113 @@
+/**
+ * @file test_preprocessor.hpp
+ * @details Test cases for the fused preprocessor
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include <preprocess/preprocessor.hpp>
+
+using namespace tflite::preprocess;
+
+class PreprocessorTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    image = cv::Mat(480, 640, CV_8UC3);
+    cv::randu(image, 0, 255);
+    spec.width = 257;
+    spec.height = 193;
+  }
+
+  cv::Mat image;
+  PreprocessSpec spec;
+};
+
+TEST_F(PreprocessorTest, RunReturnsErrorForEmptyImage) {
+  Preprocessor preprocessor(spec);
+  cv::Mat output;
+  EXPECT_EQ(preprocessor.run(cv::Mat(), output),
+            tflite::inference::InferenceStatus::INPUT_ERROR);
+}
+
+TEST_F(PreprocessorTest, RunReturnsErrorForWrongChannels) {
+  Preprocessor preprocessor(spec);
+  cv::Mat gray(480, 640, CV_8UC1, cv::Scalar(0));
+  cv::Mat output;
+  EXPECT_EQ(preprocessor.run(gray, output),
+            tflite::inference::InferenceStatus::INPUT_ERROR);
+}
+
+TEST_F(PreprocessorTest, FloatOutputMatchesOpenCVChain) {
+  spec.mean = {0.5f, 0.5f, 0.5f};
+  spec.std = {0.5f, 0.5f, 0.5f};
+  spec.swap_rb = true;
+  Preprocessor preprocessor(spec);
+  cv::Mat output;
+  ASSERT_EQ(preprocessor.run(image, output),
+            tflite::inference::InferenceStatus::SUCCESS);
+  ASSERT_EQ(output.type(), CV_32FC3);
+  ASSERT_EQ(output.size(), cv::Size(spec.width, spec.height));
+
+  cv::Mat expected;
+  cv::resize(image, expected, cv::Size(spec.width, spec.height));
+  cv::cvtColor(expected, expected, cv::COLOR_BGR2RGB);
+  expected.convertTo(expected, CV_32FC3, 2.0 / 255.0, -1.0);
+
+  // OpenCV rounds the resized image to 8 bit, allow one level of difference
+  EXPECT_LE(cv::norm(output, expected, cv::NORM_INF), 2.0 / 255.0 + 1e-4);
+}
+
+TEST_F(PreprocessorTest, QuantizedOutputMatchesOpenCVChain) {
+  spec.type = kTfLiteUInt8;
+  spec.mean = {0.5f, 0.5f, 0.5f};
+  spec.std = {0.5f, 0.5f, 0.5f};
+  spec.scale = 1.0f / 127.5f;
+  spec.zero_point = 127;
+  Preprocessor preprocessor(spec);
+  cv::Mat output;
+  ASSERT_EQ(preprocessor.run(image, output),
+            tflite::inference::InferenceStatus::SUCCESS);
+  ASSERT_EQ(output.type(), CV_8UC3);
+
+  cv::Mat expected;
+  cv::resize(image, expected, cv::Size(spec.width, spec.height));
+  EXPECT_LE(cv::norm(output, expected, cv::NORM_INF), 2.0);
+}
+
+TEST_F(PreprocessorTest, RunWritesIntoPreallocatedOutput) {
+  Preprocessor preprocessor(spec);
+  cv::Mat output(spec.height, spec.width, CV_32FC3);
+  const uchar *data = output.data;
+  ASSERT_EQ(preprocessor.run(image, output),
+            tflite::inference::InferenceStatus::SUCCESS);
+  EXPECT_EQ(output.data, data);
+}
+
+TEST_F(PreprocessorTest, RunReturnsErrorForMismatchedOutput) {
+  Preprocessor preprocessor(spec);
+  cv::Mat output(spec.height + 1, spec.width, CV_32FC3);
+  const uchar *data = output.data;
+  EXPECT_EQ(preprocessor.run(image, output),
+            tflite::inference::InferenceStatus::INPUT_ERROR);
+  EXPECT_EQ(output.data, data);
+}
+
+TEST_F(PreprocessorTest, AlphaChannelIsScaledWithoutNormalization) {
+  spec.channels = 4;
+  spec.mean = {0.5f, 0.5f, 0.5f};
+  spec.std = {0.5f, 0.5f, 0.5f};
+  Preprocessor preprocessor(spec);
+  cv::Mat bgra;
+  cv::cvtColor(image, bgra, cv::COLOR_BGR2BGRA);
+  cv::Mat output;
+  ASSERT_EQ(preprocessor.run(bgra, output),
+            tflite::inference::InferenceStatus::SUCCESS);
+  ASSERT_EQ(output.type(), CV_32FC4);
+
+  std::vector<cv::Mat> channels;
+  cv::split(output, channels);
+  EXPECT_LE(cv::norm(channels[3], cv::Scalar(1.0), cv::NORM_INF), 1e-5);
+}
@@ -0,0 +1,155 @@
+/**
+ * @file test_quantization.hpp
+ * @details Test cases for quantized models and output tensors
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <infer/infer.hpp>
+#include <infer/output_tensor.hpp>
+#include <opencv2/opencv.hpp>
+#include <preprocess/preprocessor.hpp>
+#include <vector>
+
+using namespace tflite::inference;
+
+namespace {
+struct Detection {
+  cv::Rect2f box;
+  int label;
+  float score;
+};
+
+/**
+ * @brief Run an SSD model on the image and read the detections above the
+ * threshold through the output views
+ */
+std::vector<Detection> detect(TFLiteInferenceEngine &engine,
+                              const cv::Mat &image, float threshold) {
+  tflite::preprocess::Preprocessor preprocessor(
+      tflite::preprocess::PreprocessSpec::from_engine(
+          engine, {0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}));
+  cv::Mat input = engine.input_view();
+  preprocessor.run(image, input);
+  engine.infer_in_place();
+
+  const OutputTensor locations = engine.get_output(0);
+  const OutputTensor classes = engine.get_output(1);
+  const OutputTensor scores = engine.get_output(2);
+  const OutputTensor num_detections = engine.get_output(3);
+
+  std::vector<Detection> detections;
+  const float quantized_threshold = scores.quantize(threshold);
+  for (int i = 0; i < static_cast<int>(num_detections[0]); ++i) {
+    if (scores.greater(i, quantized_threshold)) {
+      detections.push_back(
+          {cv::Rect2f(cv::Point2f(locations[4 * i + 1], locations[4 * i]),
+                      cv::Point2f(locations[4 * i + 3], locations[4 * i + 2])),
+           static_cast<int>(classes[i]), scores[i]});
+    }
+  }
+  return detections;
+}
+} // namespace
+
+TEST(OutputTensorTest, DequantizesUInt8Elements) {
+  std::vector<uint8_t> data = {0, 128, 255};
+  TfLiteTensor tensor{};
+  tensor.type = kTfLiteUInt8;
+  tensor.data.raw = reinterpret_cast<char *>(data.data());
+  tensor.bytes = data.size();
+  tensor.params = {0.5f, 128};
+
+  OutputTensor output(&tensor);
+  ASSERT_EQ(output.size(), 3);
+  EXPECT_TRUE(output.is_quantized());
+  EXPECT_FLOAT_EQ(output[0], -64.0f);
+  EXPECT_FLOAT_EQ(output[1], 0.0f);
+  EXPECT_FLOAT_EQ(output[2], 63.5f);
+}
+
+TEST(OutputTensorTest, DequantizesInt8Elements) {
+  std::vector<int8_t> data = {-128, 0, 127};
+  TfLiteTensor tensor{};
+  tensor.type = kTfLiteInt8;
+  tensor.data.raw = reinterpret_cast<char *>(data.data());
+  tensor.bytes = data.size();
+  tensor.params = {1.0f / 256.0f, -128};
+
+  OutputTensor output(&tensor);
+  EXPECT_FLOAT_EQ(output[0], 0.0f);
+  EXPECT_FLOAT_EQ(output[1], 0.5f);
+  EXPECT_FLOAT_EQ(output[2], 255.0f / 256.0f);
+}
+
+TEST(OutputTensorTest, GreaterComparesInQuantizedDomain) {
+  std::vector<int8_t> data = {-128, 0, 127};
+  TfLiteTensor tensor{};
+  tensor.type = kTfLiteInt8;
+  tensor.data.raw = reinterpret_cast<char *>(data.data());
+  tensor.bytes = data.size();
+  tensor.params = {1.0f / 256.0f, -128};
+
+  OutputTensor output(&tensor);
+  const float threshold = output.quantize(0.25f);
+  EXPECT_FALSE(output.greater(0, threshold));
+  EXPECT_TRUE(output.greater(1, threshold));
+  EXPECT_TRUE(output.greater(2, threshold));
+}
+
+TEST(OutputTensorTest, ReadsFloatElementsUnchanged) {
+  std::vector<float> data = {-1.5f, 0.25f};
+  TfLiteTensor tensor{};
+  tensor.type = kTfLiteFloat32;
+  tensor.data.raw = reinterpret_cast<char *>(data.data());
+  tensor.bytes = data.size() * sizeof(float);
+
+  OutputTensor output(&tensor);
+  ASSERT_EQ(output.size(), 2);
+  EXPECT_FALSE(output.is_quantized());
+  EXPECT_FLOAT_EQ(output[0], -1.5f);
+  EXPECT_FLOAT_EQ(output.quantize(0.5f), 0.5f);
+}
+
+TEST(QuantizedModelTest, Int8DetectionsMatchFloatDetections) {
+  const std::string float_model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/ssd_mobilenet_v1_float.tflite";
+  const std::string int8_model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/ssd_mobilenet_v1_int8.tflite";
+  if (!std::filesystem::exists(float_model_path) ||
+      !std::filesystem::exists(int8_model_path)) {
+    GTEST_SKIP() << "Float and int8 MobileNet-SSD models not available";
+  }
+
+  TFLiteInferenceEngine float_engine;
+  TFLiteInferenceEngine int8_engine;
+  ASSERT_EQ(float_engine.load_model(float_model_path),
+            InferenceStatus::SUCCESS);
+  ASSERT_EQ(int8_engine.load_model(int8_model_path), InferenceStatus::SUCCESS);
+
+  cv::Mat image =
+      cv::imread(std::string(PROJECT_SOURCE_DIR) + "/data/person_1.jpg");
+  ASSERT_FALSE(image.empty());
+
+  const auto expected = detect(float_engine, image, 0.5f);
+  const auto detections = detect(int8_engine, image, 0.4f);
+  ASSERT_FALSE(expected.empty());
+
+  for (const auto &reference : expected) {
+    bool matched = false;
+    for (const auto &detection : detections) {
+      const float intersection = (reference.box & detection.box).area();
+      const float iou = intersection / (reference.box.area() +
+                                        detection.box.area() - intersection);
+      if (detection.label == reference.label && iou > 0.5f) {
+        EXPECT_NEAR(detection.score, reference.score, 0.15f);
+        matched = true;
+        break;
+      }
+    }
+    EXPECT_TRUE(matched) << "No int8 detection for class " << reference.label;
+  }
+}
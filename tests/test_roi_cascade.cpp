@@ -0,0 +1,150 @@
+/**
+ * @file test_roi_cascade.hpp
+ * @details Test cases for the batched detection to ROI cascade
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <infer/infer.hpp>
+#include <pipeline/roi_cascade.hpp>
+#include <preprocess/preprocessor.hpp>
+
+using namespace tflite;
+using DetectionOutput = visualizer::ObjectDetectionVisualizer::DetectionOutput;
+
+namespace {
+DetectionOutput make_detections(int count) {
+  DetectionOutput detections;
+  for (int i = 0; i < count; ++i) {
+    detections.boxes.emplace_back(20 * i, 10 * i, 120 + 10 * i, 100);
+    detections.classes.push_back(i % 3);
+    detections.scores.push_back(0.9f);
+  }
+  return detections;
+}
+} // namespace
+
+class RoiCascadeTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    this->engine = std::make_shared<inference::TFLiteInferenceEngine>();
+    ASSERT_EQ(this->engine->load_model(std::string(PROJECT_SOURCE_DIR) +
+                                       "/models/deeplabv3.tflite"),
+              inference::InferenceStatus::SUCCESS);
+    this->spec = preprocess::PreprocessSpec::from_engine(*this->engine);
+    this->frame = cv::Mat(480, 640, CV_8UC3);
+    cv::randu(this->frame, 0, 255);
+  }
+
+  std::shared_ptr<inference::TFLiteInferenceEngine> engine;
+  preprocess::PreprocessSpec spec;
+  cv::Mat frame;
+};
+
+TEST(RoiCascadeHelpersTest, BatchSizeRoundsUpToPowerOfTwo) {
+  EXPECT_EQ(pipeline::RoiCascade::get_batch_size(1, 16), 1);
+  EXPECT_EQ(pipeline::RoiCascade::get_batch_size(3, 16), 4);
+  EXPECT_EQ(pipeline::RoiCascade::get_batch_size(9, 16), 16);
+  EXPECT_EQ(pipeline::RoiCascade::get_batch_size(5, 6), 6);
+}
+
+TEST(RoiCascadeHelpersTest, ExpandPadsAndClips) {
+  const cv::Size frame(100, 100);
+  EXPECT_EQ(pipeline::RoiCascade::expand(cv::Rect(10, 10, 20, 40), 0.5f,
+                                         frame),
+            cv::Rect(0, 0, 40, 70));
+  EXPECT_EQ(pipeline::RoiCascade::expand(cv::Rect(90, 90, 20, 20), 0.0f,
+                                         frame),
+            cv::Rect(90, 90, 10, 10));
+  EXPECT_TRUE(pipeline::RoiCascade::expand(cv::Rect(200, 0, 20, 20), 0.0f,
+                                           frame)
+                  .empty());
+}
+
+TEST_F(RoiCascadeTest, OneInvocationPerBatch) {
+  pipeline::CascadeOptions options;
+  options.max_batch_size = 4;
+  pipeline::RoiCascade cascade(this->engine, this->spec, options);
+
+  const auto results = cascade.run(this->frame, make_detections(10));
+  ASSERT_EQ(results.size(), 10);
+  // 4 + 4 + 2
+  EXPECT_EQ(cascade.get_num_invocations(), 3);
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].detection, i);
+    EXPECT_EQ(results[i].result.status, inference::InferenceStatus::SUCCESS);
+    ASSERT_EQ(results[i].result.outputs.size(), 1);
+    EXPECT_EQ(results[i].result.outputs[0].size(),
+              this->engine->get_output_height() *
+                  this->engine->get_output_width() *
+                  this->engine->get_output_channels());
+  }
+}
+
+TEST_F(RoiCascadeTest, MatchesSingleInference) {
+  const DetectionOutput detections = make_detections(3);
+  pipeline::CascadeOptions options;
+  options.padding = 0.1f;
+  pipeline::RoiCascade cascade(this->engine, this->spec, options);
+  const auto results = cascade.run(this->frame, detections);
+  ASSERT_EQ(results.size(), 3);
+
+  preprocess::Preprocessor preprocessor(this->spec);
+  for (const auto &roi : results) {
+    cv::Mat input = this->engine->input_view();
+    ASSERT_EQ(preprocessor.run(this->frame(roi.roi), input),
+              inference::InferenceStatus::SUCCESS);
+    ASSERT_EQ(this->engine->invoke(), inference::InferenceStatus::SUCCESS);
+    const auto expected = this->engine->get_output_view<float>(0);
+    const auto &output = roi.result.outputs[0];
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t i = 0; i < output.size(); i += 997) {
+      EXPECT_NEAR(output[i], expected[i], 1e-4);
+    }
+  }
+}
+
+TEST_F(RoiCascadeTest, FiltersAndClipsDetections) {
+  DetectionOutput detections = make_detections(6);
+  detections.scores[1] = 0.1f;
+  // Partly outside the frame, clipped
+  detections.boxes[2] = cv::Rect(600, 400, 100, 100);
+  // Outside the frame, skipped
+  detections.boxes[3] = cv::Rect(700, 0, 50, 50);
+
+  pipeline::CascadeOptions options;
+  options.classes = {0, 2};
+  pipeline::RoiCascade cascade(this->engine, this->spec, options);
+  const auto results = cascade.run(this->frame, detections);
+
+  // Detections 1 and 4 are of class 1, 3 is outside the frame
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[0].detection, 0);
+  EXPECT_EQ(results[1].detection, 2);
+  EXPECT_EQ(results[1].roi, cv::Rect(600, 400, 40, 80));
+  EXPECT_EQ(results[2].detection, 5);
+  EXPECT_EQ(cascade.get_num_invocations(), 1);
+}
+
+TEST_F(RoiCascadeTest, MismatchedSpecFails) {
+  preprocess::PreprocessSpec spec = this->spec;
+  spec.width /= 2;
+  pipeline::RoiCascade cascade(this->engine, spec);
+
+  std::vector<pipeline::RoiResult> results;
+  EXPECT_EQ(cascade.run(this->frame, make_detections(3), results),
+            inference::InferenceStatus::INPUT_ERROR);
+  ASSERT_EQ(results.size(), 3);
+  for (const auto &result : results) {
+    EXPECT_EQ(result.result.status, inference::InferenceStatus::INPUT_ERROR);
+  }
+  EXPECT_EQ(cascade.get_num_invocations(), 0);
+}
+
+TEST_F(RoiCascadeTest, NoDetections) {
+  pipeline::RoiCascade cascade(this->engine, this->spec);
+  EXPECT_TRUE(cascade.run(this->frame, DetectionOutput()).empty());
+  EXPECT_EQ(cascade.get_num_invocations(), 0);
+}
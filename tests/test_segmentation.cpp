@@ -11,6 +11,7 @@
 #include <log/log.hpp>
 #include <opencv2/opencv.hpp>
 #include <utils/scoped_timer.hpp>
+#include <vector>
 #include <visualizer/segmentation.hpp>
 
 using namespace tflite::inference;
@@ -109,6 +110,7 @@ TEST_F(SegmentationTest, InferSegmentationWONormalizationReturnsCorrectOutput) {
   cv::resize(image, image,
              cv::Size(segmentation.get_input_height(),
                       segmentation.get_input_width()));
+  image.convertTo(image, CV_32FC3);
   auto [output_locations, output_classes, output_scores, num_detections] =
       segmentation.infer(image);
   EXPECT_NE(output_locations, nullptr);
@@ -123,4 +125,79 @@ TEST_F(SegmentationTest, InferSegmentationReturnsNullptrForEmptyImage) {
   EXPECT_EQ(std::get<3>(result), nullptr);
 }
 
+TEST_F(SegmentationTest, InferBatchReturnsOneOutputPerImage) {
+  cv::Mat image = cv::imread(this->image_path);
+  assert(!image.empty());
+  cv::resize(image, image,
+             cv::Size(segmentation.get_input_width(),
+                      segmentation.get_input_height()));
+  image.convertTo(image, CV_32FC3, 1.0 / 255.0);
+
+  auto single = segmentation.infer_batch({image});
+  ASSERT_EQ(single.size(), 1);
+  const size_t output_size = segmentation.get_output_height() *
+                             segmentation.get_output_width() *
+                             segmentation.get_output_channels();
+  std::vector<float> expected(std::get<0>(single[0]),
+                              std::get<0>(single[0]) + output_size);
+
+  auto batch = segmentation.infer_batch({image, image, image, image});
+  ASSERT_EQ(batch.size(), 4);
+  for (const auto &output : batch) {
+    ASSERT_NE(std::get<0>(output), nullptr);
+    EXPECT_EQ(std::get<1>(output), nullptr);
+    for (size_t i = 0; i < output_size; i += 997) {
+      EXPECT_NEAR(std::get<0>(output)[i], expected[i], 1e-4);
+    }
+  }
+}
 
+TEST_F(SegmentationTest, InferBatchPadsToPowerOfTwo) {
+  cv::Mat image = cv::imread(this->image_path);
+  assert(!image.empty());
+  cv::resize(image, image,
+             cv::Size(segmentation.get_input_width(),
+                      segmentation.get_input_height()));
+  image.convertTo(image, CV_32FC3, 1.0 / 255.0);
+  cv::Mat other = cv::Mat::zeros(image.size(), image.type());
+
+  auto single = segmentation.infer_batch({image});
+  ASSERT_EQ(single.size(), 1);
+  const size_t output_size = segmentation.get_output_height() *
+                             segmentation.get_output_width() *
+                             segmentation.get_output_channels();
+  std::vector<float> expected(std::get<0>(single[0]),
+                              std::get<0>(single[0]) + output_size);
+
+  // Runs on the interpreter of batch size 4, the padding image is ignored
+  auto batch = segmentation.infer_batch({other, other, image});
+  ASSERT_EQ(batch.size(), 3);
+  ASSERT_NE(std::get<0>(batch[2]), nullptr);
+  for (size_t i = 0; i < output_size; i += 997) {
+    EXPECT_NEAR(std::get<0>(batch[2])[i], expected[i], 1e-4);
+  }
+}
+
+TEST(SegmentationVisualizerTest, MapSpreadsClassesOver8Bits) {
+  // Three pixels of three classes, each won by a different class
+  const std::vector<float> scores = {0.9f, 0.1f, 0.0f, 0.2f, 0.7f,
+                                     0.1f, 0.0f, 0.3f, 0.6f};
+  const cv::Mat map =
+      tflite::visualizer::SegmentationVisualizer::generate_segmentation_map(
+          scores.data(), 1, 3, 3);
+  ASSERT_EQ(map.type(), CV_8UC1);
+  EXPECT_EQ(map.at<uchar>(0, 0), 0);
+  EXPECT_NEAR(map.at<uchar>(0, 1), 127.5, 0.5);
+  EXPECT_EQ(map.at<uchar>(0, 2), 255);
+}
+
+TEST(SegmentationVisualizerTest, OverlayUpsamplesToTheImageSize) {
+  // 2x2 output of two classes onto a larger frame
+  const std::vector<float> scores = {0.9f, 0.1f, 0.2f, 0.8f,
+                                     0.3f, 0.7f, 0.6f, 0.4f};
+  const cv::Mat image(48, 64, CV_8UC3, cv::Scalar(10, 20, 30));
+  const cv::Mat output = tflite::visualizer::SegmentationVisualizer::overlay(
+      image, scores.data(), 2, 2, 2);
+  ASSERT_EQ(output.size(), image.size());
+  EXPECT_EQ(output.type(), CV_8UC3);
+}
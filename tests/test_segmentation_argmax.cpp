@@ -0,0 +1,166 @@
+/**
+ * @file test_segmentation_argmax.hpp
+ * @details Test cases for the vectorized segmentation argmax
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <postprocess/segmentation_argmax.hpp>
+#include <random>
+#include <vector>
+
+using namespace tflite::postprocess;
+using tflite::inference::InferenceStatus;
+using utils::cpu::SimdLevel;
+
+namespace {
+template <typename T>
+std::vector<T> make_scores(int height, int width, int channels, int low,
+                           int high, unsigned seed) {
+  std::mt19937 generator(seed);
+  // Few distinct values so ties between classes are frequent
+  std::uniform_int_distribution<int> value(low, high);
+  std::vector<T> scores(static_cast<size_t>(height) * width * channels);
+  for (T &score : scores) {
+    score = static_cast<T>(value(generator));
+  }
+  return scores;
+}
+
+template <typename T>
+void expect_matches_reference(const std::vector<T> &scores, int height,
+                              int width, int channels, float scale = 1.0f,
+                              int zero_point = 0) {
+  for (SimdLevel level :
+       {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2}) {
+    SegmentationArgmax argmax;
+    argmax.set_simd_level(level);
+    cv::Mat classes;
+    cv::Mat confidence;
+    ASSERT_EQ(argmax.run(scores.data(), height, width, channels, classes,
+                         &confidence, scale, zero_point),
+              InferenceStatus::SUCCESS);
+
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const T *pixel = scores.data() + (y * width + x) * channels;
+        const int expected = static_cast<int>(
+            std::max_element(pixel, pixel + channels) - pixel);
+        ASSERT_EQ(classes.at<uchar>(y, x), expected)
+            << utils::cpu::to_string(argmax.get_simd_level()) << " at " << x
+            << ", " << y << " with " << channels << " classes";
+        ASSERT_FLOAT_EQ(confidence.at<float>(y, x),
+                        scale * (static_cast<float>(pixel[expected]) -
+                                 static_cast<float>(zero_point)));
+      }
+    }
+  }
+}
+} // namespace
+
+TEST(SegmentationArgmaxTest, FloatMatchesReferenceOnEveryKernel) {
+  // Fewer classes than a vector, not a multiple of it and DeepLab's 21
+  for (int channels : {1, 3, 5, 8, 12, 21, 150}) {
+    expect_matches_reference(
+        make_scores<float>(7, 33, channels, -20, 20, channels), 7, 33,
+        channels);
+  }
+}
+
+TEST(SegmentationArgmaxTest, QuantizedMatchesReferenceOnEveryKernel) {
+  for (int channels : {2, 16, 21, 32, 45, 256}) {
+    expect_matches_reference(
+        make_scores<uint8_t>(5, 19, channels, 0, 255, channels), 5, 19,
+        channels, 0.05f, 128);
+    expect_matches_reference(
+        make_scores<int8_t>(5, 19, channels, -128, 127, channels), 5, 19,
+        channels, 0.1f, -3);
+  }
+}
+
+TEST(SegmentationArgmaxTest, VectorKernelsMatchScalarKernel) {
+#if TFLITE_HAS_X86_DISPATCH
+  const SimdLevel supported = utils::cpu::detect_simd_level();
+  if (supported == SimdLevel::SCALAR) {
+    GTEST_SKIP() << "The CPU has no SSE4.1";
+  }
+  // Calls the kernels directly, so a CPU without a level is not silently
+  // tested with the scalar kernel. Up to 300 classes covers several 64-class
+  // windows and every remainder of the vector widths.
+  for (int channels = 1; channels <= 300; ++channels) {
+    const auto floats = make_scores<float>(1, 64, channels, -3, 3, channels);
+    const auto bytes =
+        make_scores<uint8_t>(1, 64, channels, 250, 255, channels);
+    const auto signed_bytes =
+        make_scores<int8_t>(1, 64, channels, -128, -125, channels);
+    for (int x = 0; x < 64; ++x) {
+      const float *f = floats.data() + x * channels;
+      const uint8_t *u = bytes.data() + x * channels;
+      const int8_t *s = signed_bytes.data() + x * channels;
+      if (channels >= 4) {
+        ASSERT_EQ(detail::argmax_sse41(f, channels),
+                  detail::argmax_scalar(f, channels))
+            << "SSE4.1 float with " << channels << " classes";
+      }
+      if (channels >= 16) {
+        ASSERT_EQ(detail::argmax_sse41(u, channels),
+                  detail::argmax_scalar(u, channels))
+            << "SSE4.1 uint8 with " << channels << " classes";
+        ASSERT_EQ(detail::argmax_sse41(s, channels),
+                  detail::argmax_scalar(s, channels))
+            << "SSE4.1 int8 with " << channels << " classes";
+      }
+      if (supported != SimdLevel::AVX2) {
+        continue;
+      }
+      if (channels >= 4) {
+        ASSERT_EQ(detail::argmax_avx2(f, channels),
+                  detail::argmax_scalar(f, channels))
+            << "AVX2 float with " << channels << " classes";
+      }
+      if (channels >= 16) {
+        ASSERT_EQ(detail::argmax_avx2(u, channels),
+                  detail::argmax_scalar(u, channels))
+            << "AVX2 uint8 with " << channels << " classes";
+        ASSERT_EQ(detail::argmax_avx2(s, channels),
+                  detail::argmax_scalar(s, channels))
+            << "AVX2 int8 with " << channels << " classes";
+      }
+    }
+  }
+#else
+  GTEST_SKIP() << "No vector kernels on this architecture";
+#endif
+}
+
+TEST(SegmentationArgmaxTest, NegativeScoresAndTies) {
+  // All scores negative, the last class wins
+  const std::vector<float> negative = {-5.0f, -4.0f, -3.0f, -2.0f, -1.0f};
+  SegmentationArgmax argmax;
+  cv::Mat classes;
+  ASSERT_EQ(argmax.run(negative.data(), 1, 1, 5, classes),
+            InferenceStatus::SUCCESS);
+  EXPECT_EQ(classes.at<uchar>(0, 0), 4);
+
+  // Equal highest scores, the first class wins
+  std::vector<float> tied(24, 0.0f);
+  tied[9] = 1.0f;
+  tied[20] = 1.0f;
+  ASSERT_EQ(argmax.run(tied.data(), 1, 1, 24, classes),
+            InferenceStatus::SUCCESS);
+  EXPECT_EQ(classes.at<uchar>(0, 0), 9);
+}
+
+TEST(SegmentationArgmaxTest, RejectsInvalidInput) {
+  SegmentationArgmax argmax;
+  cv::Mat classes;
+  const std::vector<float> scores(300, 0.0f);
+  EXPECT_EQ(argmax.run(static_cast<const float *>(nullptr), 1, 1, 3, classes),
+            InferenceStatus::INPUT_ERROR);
+  EXPECT_EQ(argmax.run(scores.data(), 1, 1, 300, classes),
+            InferenceStatus::INPUT_ERROR);
+  EXPECT_EQ(argmax.run(tflite::inference::OutputTensor(), classes),
+            InferenceStatus::INPUT_ERROR);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file test_segmentation_overlay.hpp
+ * @details Test cases for the fused colorization and blending of class maps
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <random>
+#include <visualizer/segmentation_overlay.hpp>
+
+using namespace tflite::visualizer;
+
+namespace {
+cv::Mat make_image(int height, int width) {
+  std::mt19937 generator(3);
+  cv::Mat image(height, width, CV_8UC3);
+  for (int y = 0; y < height; ++y) {
+    uint8_t *row = image.ptr<uint8_t>(y);
+    for (int x = 0; x < 3 * width; ++x) {
+      row[x] = static_cast<uint8_t>(generator() % 256);
+    }
+  }
+  return image;
+}
+
+uint8_t blend(uint8_t value, uint8_t color, float alpha) {
+  return cv::saturate_cast<uint8_t>((1.0f - alpha) * value + alpha * color);
+}
+} // namespace
+
+TEST(SegmentationOverlayTest, BlendsPaletteAndUpsamples) {
+  OverlayOptions options;
+  options.palette = {cv::Vec3b(0, 0, 0), cv::Vec3b(255, 0, 0),
+                     cv::Vec3b(0, 255, 0)};
+  options.alpha = 0.25f;
+  options.background = -1;
+  SegmentationOverlay overlay(options);
+
+  // 2x3 class map onto a 5x7 image, not a multiple of it
+  cv::Mat classes(2, 3, CV_8UC1);
+  const uint8_t values[] = {0, 1, 2, 2, 1, 4};
+  for (int i = 0; i < 6; ++i) {
+    classes.ptr<uint8_t>(i / 3)[i % 3] = values[i];
+  }
+  const cv::Mat image = make_image(5, 7);
+  cv::Mat output;
+  ASSERT_EQ(overlay.run(image, classes, output), VisualizationStatus::SUCCESS);
+  ASSERT_EQ(output.size(), image.size());
+
+  for (int y = 0; y < 5; ++y) {
+    for (int x = 0; x < 7; ++x) {
+      // Nearest neighbour, rounded down
+      const int class_id = classes.at<uint8_t>(y * 2 / 5, x * 3 / 7);
+      // Classes past the palette reuse it cyclically
+      const cv::Vec3b &color = options.palette[class_id % 3];
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_EQ(output.at<cv::Vec3b>(y, x)[c],
+                  blend(image.at<cv::Vec3b>(y, x)[c], color[c], 0.25f))
+            << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST(SegmentationOverlayTest, BackgroundIsLeftUntouchedInPlace) {
+  OverlayOptions options;
+  options.alpha = 0.5f;
+  options.background = 0;
+  SegmentationOverlay overlay(options);
+  cv::Mat classes(1, 2, CV_8UC1);
+  classes.ptr<uint8_t>(0)[0] = 0;
+  classes.ptr<uint8_t>(0)[1] = 15;
+
+  const cv::Mat original = make_image(3, 8);
+  cv::Mat image = make_image(3, 8);
+  ASSERT_EQ(overlay.run(image, classes, image), VisualizationStatus::SUCCESS);
+
+  const cv::Vec3b person = SegmentationOverlay::default_palette()[15];
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        const uint8_t value = original.at<cv::Vec3b>(y, x)[c];
+        EXPECT_EQ(image.at<cv::Vec3b>(y, x)[c],
+                  x < 4 ? value : blend(value, person[c], 0.5f));
+      }
+    }
+  }
+}
+
+TEST(SegmentationOverlayTest, DefaultsMatchPreviousBlend) {
+  SegmentationOverlay overlay;
+  cv::Mat classes(1, 2, CV_8UC1);
+  classes.ptr<uint8_t>(0)[0] = 0;
+  classes.ptr<uint8_t>(0)[1] = 15;
+  const cv::Mat image = make_image(3, 8);
+  cv::Mat output;
+  ASSERT_EQ(overlay.run(image, classes, output), VisualizationStatus::SUCCESS);
+
+  // Every class is colored, the background too, with 10% opacity
+  const std::vector<cv::Vec3b> palette = SegmentationOverlay::default_palette();
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      const cv::Vec3b &color = palette[x < 4 ? 0 : 15];
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_EQ(output.at<cv::Vec3b>(y, x)[c],
+                  blend(image.at<cv::Vec3b>(y, x)[c], color[c], 0.1f));
+      }
+    }
+  }
+}
+
+TEST(SegmentationOverlayTest, DefaultPaletteIsPascalVoc) {
+  const std::vector<cv::Vec3b> palette = SegmentationOverlay::default_palette();
+  ASSERT_EQ(palette.size(), 256);
+  // BGR
+  EXPECT_EQ(palette[0], cv::Vec3b(0, 0, 0));
+  EXPECT_EQ(palette[1], cv::Vec3b(0, 0, 128));
+  EXPECT_EQ(palette[15], cv::Vec3b(128, 128, 192));
+}
+
+TEST(SegmentationOverlayTest, RejectsInvalidInput) {
+  SegmentationOverlay overlay;
+  cv::Mat output;
+  const cv::Mat classes(2, 2, CV_8UC1);
+  EXPECT_EQ(overlay.run(cv::Mat(), classes, output),
+            VisualizationStatus::INPUT_IMAGE_EMPTY);
+  EXPECT_EQ(overlay.run(cv::Mat(4, 4, CV_32FC1), classes, output),
+            VisualizationStatus::INPUT_TYPE_MISMATCH);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file test_tensor_view.hpp
+ * @details Test cases for the typed tensor views and output accessors
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <infer/infer.hpp>
+#include <infer/tensor_view.hpp>
+#include <numeric>
+#include <vector>
+
+using namespace tflite::inference;
+
+TEST(TensorViewTest, ShapeAndStrides) {
+  std::vector<float> data(2 * 3 * 4);
+  std::iota(data.begin(), data.end(), 0.0f);
+  TensorView<float> view(data.data(), {2, 3, 4});
+
+  EXPECT_EQ(view.rank(), 3);
+  EXPECT_EQ(view.size(), 24);
+  EXPECT_EQ(view.stride(0), 12);
+  EXPECT_EQ(view.stride(1), 4);
+  EXPECT_EQ(view.stride(2), 1);
+  EXPECT_FLOAT_EQ(view.at(1, 2, 3), 23.0f);
+  EXPECT_FLOAT_EQ(view.at(1, 0, 2), 14.0f);
+  EXPECT_EQ(view.type(), kTfLiteFloat32);
+  // Missing axes read as 1, so 3-D tensors have one channel
+  EXPECT_EQ(view.shape().dim(3), 1);
+  EXPECT_EQ(view.shape().dim(-1), 4);
+}
+
+TEST(TensorViewTest, SliceSelectsBatchRows) {
+  std::vector<float> data(2 * 10 * 4);
+  std::iota(data.begin(), data.end(), 0.0f);
+  TensorView<const float> view(data.data(), {2, 10, 4});
+
+  const auto second = view.slice(1);
+  EXPECT_EQ(second.dim(0), 1);
+  EXPECT_EQ(second.size(), 40);
+  EXPECT_FLOAT_EQ(second[0], 40.0f);
+  EXPECT_FLOAT_EQ(second.at(0, 9, 3), 79.0f);
+}
+
+TEST(TensorViewTest, FromTensorChecksType) {
+  std::vector<uint8_t> data = {0, 128, 255, 10};
+  TfLiteIntArray *dims = TfLiteIntArrayCreate(2);
+  dims->data[0] = 1;
+  dims->data[1] = 4;
+  TfLiteTensor tensor{};
+  tensor.type = kTfLiteUInt8;
+  tensor.data.raw = reinterpret_cast<char *>(data.data());
+  tensor.dims = dims;
+  tensor.bytes = data.size();
+  tensor.params = {0.5f, 128};
+
+  const auto view = TensorView<const uint8_t>::from_tensor(&tensor);
+  ASSERT_FALSE(view.empty());
+  EXPECT_EQ(view.shape(), TensorShape({1, 4}));
+  EXPECT_TRUE(view.quantization().is_quantized());
+  EXPECT_EQ(view[1], 128);
+  EXPECT_FLOAT_EQ(view.real(0), -64.0f);
+  EXPECT_FLOAT_EQ(view.real(2), 63.5f);
+
+  EXPECT_TRUE(TensorView<const float>::from_tensor(&tensor).empty());
+  EXPECT_TRUE(TensorView<const float>::from_tensor(nullptr).empty());
+
+  EXPECT_EQ(OutputTensor(&tensor).shape().rank(), 2);
+  TfLiteIntArrayFree(dims);
+}
+
+TEST(EngineOutputViewTest, DetectionOutputs) {
+  TFLiteInferenceEngine engine;
+  ASSERT_EQ(engine.load_model(std::string(PROJECT_SOURCE_DIR) +
+                              "/models/mobilenet_ssd_v1.tflite"),
+            InferenceStatus::SUCCESS);
+  cv::Mat image(300, 300, CV_8UC3, cv::Scalar(0, 0, 0));
+  ASSERT_EQ(engine.set_input(image), InferenceStatus::SUCCESS);
+  ASSERT_EQ(engine.invoke(), InferenceStatus::SUCCESS);
+
+  ASSERT_EQ(engine.get_num_outputs(), 4);
+  EXPECT_EQ(engine.get_outputs().size(), 4);
+
+  // Boxes are [1, N, 4], classes and scores [1, N]
+  const auto boxes = engine.get_output_view<float>(0);
+  const auto scores = engine.get_output_view<float>(2);
+  ASSERT_FALSE(boxes.empty());
+  ASSERT_FALSE(scores.empty());
+  EXPECT_EQ(boxes.rank(), 3);
+  EXPECT_EQ(boxes.dim(2), 4);
+  EXPECT_EQ(scores.rank(), 2);
+  EXPECT_EQ(boxes.dim(1), scores.dim(1));
+  EXPECT_EQ(engine.get_output_shape(0), boxes.shape());
+
+  EXPECT_TRUE(engine.get_output_view<uint8_t>(0).empty());
+  EXPECT_TRUE(engine.get_output_view<float>(4).empty());
+  EXPECT_EQ(engine.get_output_shape(4).rank(), 0);
+}
+
+TEST(EngineOutputViewTest, SingleOutputModel) {
+  TFLiteInferenceEngine engine;
+  ASSERT_EQ(engine.load_model(std::string(PROJECT_SOURCE_DIR) +
+                              "/models/deeplabv3.tflite"),
+            InferenceStatus::SUCCESS);
+  cv::Mat image(257, 257, CV_32FC3, cv::Scalar(0, 0, 0));
+  auto [output, missing_1, missing_2, missing_3] = engine.infer(image);
+  ASSERT_NE(output, nullptr);
+  EXPECT_EQ(missing_1, nullptr);
+  EXPECT_EQ(missing_2, nullptr);
+  EXPECT_EQ(missing_3, nullptr);
+
+  const auto view = engine.get_output_view<float>(0);
+  ASSERT_EQ(view.rank(), 4);
+  EXPECT_EQ(view.data(), output);
+  // deeplabv3 outputs [1, 257, 257, 21]
+  EXPECT_EQ(view.dim(1), 257);
+  EXPECT_EQ(view.dim(2), 257);
+  EXPECT_EQ(view.dim(3), 21);
+  EXPECT_EQ(view.dim(3), engine.get_output_channels());
+}
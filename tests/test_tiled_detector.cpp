@@ -0,0 +1,148 @@
+/**
+ * @file test_tiled_detector.hpp
+ * @details Test cases for tiled detection and the merging of detections
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <gtest/gtest.h>
+#include <infer/infer.hpp>
+#include <opencv2/opencv.hpp>
+#include <pipeline/tiled_detector.hpp>
+#include <postprocess/nms.hpp>
+
+using namespace tflite;
+
+TEST(TileLayoutTest, TilesOfModelInputSize) {
+  pipeline::TileOptions options;
+  options.overlap = 0.2f;
+  const auto tiles = pipeline::TiledDetector::make_tiles(
+      cv::Size(1000, 600), cv::Size(300, 300), options);
+
+  // 4 columns and 3 rows of at least 60 pixels of overlap
+  ASSERT_EQ(tiles.size(), 12);
+  const cv::Rect frame(0, 0, 1000, 600);
+  for (const cv::Rect &tile : tiles) {
+    EXPECT_EQ(tile.size(), cv::Size(300, 300));
+    EXPECT_EQ(tile & frame, tile);
+  }
+  EXPECT_EQ(tiles[0].tl(), cv::Point(0, 0));
+  EXPECT_EQ(tiles.back().br(), cv::Point(1000, 600));
+  EXPECT_GE(tiles[0].br().x - tiles[1].x, 60);
+  EXPECT_GE(tiles[0].br().y - tiles[4].y, 60);
+}
+
+TEST(TileLayoutTest, ConfiguredGrid) {
+  pipeline::TileOptions options;
+  options.cols = 4;
+  options.rows = 2;
+  options.overlap = 0.25f;
+  options.full_frame = true;
+  const auto tiles = pipeline::TiledDetector::make_tiles(
+      cv::Size(3840, 2160), cv::Size(300, 300), options);
+
+  ASSERT_EQ(tiles.size(), 9);
+  EXPECT_EQ(tiles[0], cv::Rect(0, 0, 1182, 1235));
+  EXPECT_EQ(tiles[7].br(), cv::Point(3840, 2160));
+  EXPECT_EQ(tiles[8], cv::Rect(0, 0, 3840, 2160));
+}
+
+TEST(TileLayoutTest, FrameSmallerThanTile) {
+  const auto tiles = pipeline::TiledDetector::make_tiles(
+      cv::Size(200, 100), cv::Size(300, 300), pipeline::TileOptions());
+  ASSERT_EQ(tiles.size(), 1);
+  EXPECT_EQ(tiles[0], cv::Rect(0, 0, 200, 100));
+}
+
+TEST(NmsTest, MergesBoxesCutByTileBorder) {
+  const std::vector<cv::Rect> boxes = {cv::Rect(100, 100, 100, 200),
+                                       cv::Rect(100, 100, 40, 200),
+                                       cv::Rect(100, 100, 40, 200)};
+  const std::vector<int> classes = {1, 1, 2};
+  const std::vector<float> scores = {0.9f, 0.8f, 0.7f};
+
+  // The cut box has an IoU of 0.4 but lies inside the full box
+  EXPECT_EQ(postprocess::nms(boxes, classes, scores, 0.5f,
+                             postprocess::OverlapMetric::IOU)
+                .size(),
+            3);
+  const auto keep = postprocess::nms(boxes, classes, scores, 0.5f,
+                                     postprocess::OverlapMetric::IOS);
+  ASSERT_EQ(keep.size(), 2);
+  EXPECT_EQ(keep[0], 0);
+  // Other class
+  EXPECT_EQ(keep[1], 2);
+}
+
+class TiledDetectorTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    for (int i = 0; i < 2; ++i) {
+      auto engine = std::make_shared<inference::TFLiteInferenceEngine>();
+      ASSERT_EQ(engine->load_model(std::string(PROJECT_SOURCE_DIR) +
+                                   "/models/mobilenet_ssd_v1.tflite"),
+                inference::InferenceStatus::SUCCESS);
+      this->engines.push_back(engine);
+    }
+    this->spec = preprocess::PreprocessSpec::from_engine(*this->engines[0]);
+
+    cv::Mat image =
+        cv::imread(std::string(PROJECT_SOURCE_DIR) + "/data/person_1.jpg");
+    ASSERT_FALSE(image.empty());
+    cv::resize(image, this->frame, cv::Size(), 3.0, 3.0);
+  }
+
+  std::vector<std::shared_ptr<inference::TFLiteInferenceEngine>> engines;
+  preprocess::PreprocessSpec spec;
+  cv::Mat frame;
+};
+
+TEST_F(TiledDetectorTest, DetectionsInFrameCoordinates) {
+  pipeline::TileOptions options;
+  options.cols = 2;
+  options.rows = 2;
+  options.full_frame = true;
+  pipeline::TiledDetector detector(this->engines, this->spec, options);
+
+  const auto detections = detector.run(this->frame);
+  const auto &stats = detector.get_last_stats();
+  EXPECT_EQ(stats.tiles, 5);
+  EXPECT_EQ(stats.invocations, 5);
+  EXPECT_EQ(stats.detections, detections.boxes.size());
+  EXPECT_LE(stats.detections, stats.raw_detections);
+  EXPECT_GT(stats.total_ms, 0.0);
+
+  ASSERT_FALSE(detections.boxes.empty());
+  const cv::Rect bounds(cv::Point(0, 0), this->frame.size());
+  for (size_t i = 0; i < detections.boxes.size(); ++i) {
+    EXPECT_EQ(detections.boxes[i] & bounds, detections.boxes[i]);
+    EXPECT_GE(detections.scores[i], options.score_threshold);
+  }
+}
+
+TEST_F(TiledDetectorTest, ParallelMatchesSingleEngine) {
+  pipeline::TileOptions options;
+  options.cols = 3;
+  options.rows = 2;
+  pipeline::TiledDetector parallel(this->engines, this->spec, options);
+  pipeline::TiledDetector single({this->engines[0]}, this->spec, options);
+
+  for (int run = 0; run < 3; ++run) {
+    const auto expected = single.run(this->frame);
+    const auto detections = parallel.run(this->frame);
+    ASSERT_EQ(detections.boxes.size(), expected.boxes.size());
+    for (size_t i = 0; i < detections.boxes.size(); ++i) {
+      EXPECT_EQ(detections.boxes[i], expected.boxes[i]);
+      EXPECT_EQ(detections.classes[i], expected.classes[i]);
+    }
+  }
+}
+
+TEST_F(TiledDetectorTest, EmptyFrame) {
+  pipeline::TiledDetector detector(this->engines, this->spec);
+  pipeline::TiledDetector::DetectionOutput detections;
+  EXPECT_EQ(detector.run(cv::Mat(), detections),
+            inference::InferenceStatus::INPUT_ERROR);
+  EXPECT_TRUE(detections.boxes.empty());
+}
@@ -0,0 +1,193 @@
+/**
+ * @file test_tracer.hpp
+ * @details Test cases for the span tracer and the Chrome trace export
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <infer/infer.hpp>
+#include <thread>
+#include <trace/tracer.hpp>
+
+using namespace tflite::trace;
+
+namespace {
+/**
+ * @brief Get the spans of one name
+ */
+std::vector<TraceEvent> find_events(const std::string &name) {
+  std::vector<TraceEvent> found;
+  for (const auto &[thread_id, events] :
+       Tracer::get_instance().get_events()) {
+    for (const auto &event : events) {
+      if (name == event.name) {
+        found.push_back(event);
+      }
+    }
+  }
+  return found;
+}
+} // namespace
+
+class TracerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+#ifndef TFLITE_ENABLE_TRACING
+    GTEST_SKIP() << "Built without TFLITE_ENABLE_TRACING";
+#endif
+    Tracer::get_instance().stop();
+    Tracer::get_instance().clear();
+  }
+  void TearDown() override {
+    Tracer::get_instance().stop();
+    Tracer::get_instance().clear();
+  }
+};
+
+TEST_F(TracerTest, SpansCarryFrameIds) {
+  Tracer::get_instance().start();
+  {
+    TFLITE_TRACE_FRAME(7);
+    TFLITE_TRACE_SCOPE("test_frame_span");
+  }
+  {
+    TFLITE_TRACE_SCOPE("test_no_frame_span");
+  }
+  Tracer::get_instance().stop();
+
+  const auto framed = find_events("test_frame_span");
+  ASSERT_EQ(framed.size(), 1);
+  EXPECT_EQ(framed[0].frame_id, 7);
+  EXPECT_GE(framed[0].duration_ns, 0);
+
+  const auto unframed = find_events("test_no_frame_span");
+  ASSERT_EQ(unframed.size(), 1);
+  EXPECT_EQ(unframed[0].frame_id, -1);
+}
+
+TEST_F(TracerTest, StoppedTracerRecordsNothing) {
+  {
+    TFLITE_TRACE_SCOPE("test_stopped_span");
+  }
+  EXPECT_TRUE(find_events("test_stopped_span").empty());
+}
+
+TEST_F(TracerTest, RingBufferKeepsNewestSpans) {
+  // Capacity applies to threads recording their first span afterwards
+  Tracer::get_instance().start(8);
+  std::thread([] {
+    for (int i = 0; i < 20; ++i) {
+      TFLITE_TRACE_FRAME(i);
+      TFLITE_TRACE_SCOPE("test_ring_span");
+    }
+  }).join();
+  Tracer::get_instance().stop();
+
+  const auto events = find_events("test_ring_span");
+  ASSERT_EQ(events.size(), 8);
+  EXPECT_EQ(events.front().frame_id, 12);
+  EXPECT_EQ(events.back().frame_id, 19);
+}
+
+TEST_F(TracerTest, ChromeTraceJson) {
+  Tracer::get_instance().start();
+  std::thread([] {
+    TFLITE_TRACE_THREAD_NAME("test \"worker\"");
+    TFLITE_TRACE_FRAME(3);
+    TFLITE_TRACE_SCOPE("test_json_span");
+  }).join();
+  Tracer::get_instance().stop();
+
+  const std::string json = Tracer::get_instance().to_chrome_trace();
+  EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0);
+  EXPECT_NE(json.find(R"("name":"test_json_span","cat":"tflite","ph":"X")"),
+            std::string::npos);
+  EXPECT_NE(json.find(R"("args":{"frame":3})"), std::string::npos);
+  EXPECT_NE(json.find(R"("args":{"name":"test \"worker\""})"),
+            std::string::npos);
+}
+
+TEST_F(TracerTest, EngineIsInstrumented) {
+  tflite::inference::TFLiteInferenceEngine engine;
+  const std::string model_path =
+      std::string(PROJECT_SOURCE_DIR) + "/models/mobilenet_ssd_v1.tflite";
+
+  Tracer::get_instance().start();
+  ASSERT_EQ(engine.load_model(model_path),
+            tflite::inference::InferenceStatus::SUCCESS);
+  cv::Mat image(300, 300, CV_8UC3, cv::Scalar(0, 0, 0));
+  {
+    TFLITE_TRACE_FRAME(42);
+    engine.infer(image);
+  }
+  Tracer::get_instance().stop();
+
+  EXPECT_EQ(find_events("load_model").size(), 1);
+  const auto infer = find_events("infer");
+  const auto invoke = find_events("invoke");
+  ASSERT_EQ(infer.size(), 1);
+  ASSERT_EQ(invoke.size(), 1);
+  EXPECT_EQ(invoke[0].frame_id, 42);
+  // invoke is nested in infer
+  EXPECT_GE(invoke[0].start_ns, infer[0].start_ns);
+  EXPECT_LE(invoke[0].start_ns + invoke[0].duration_ns,
+            infer[0].start_ns + infer[0].duration_ns);
+}
+
+TEST_F(TracerTest, ThreadNameAllocatesNoBufferWhileStopped) {
+  const size_t buffers = Tracer::get_instance().num_buffers();
+  for (int i = 0; i < 100; ++i) {
+    std::thread([] {
+      TFLITE_TRACE_THREAD_NAME("test_short_lived");
+      TFLITE_TRACE_SCOPE("test_short_lived_span");
+    }).join();
+  }
+  EXPECT_EQ(Tracer::get_instance().num_buffers(), buffers);
+}
+
+TEST_F(TracerTest, BuffersOfExitedThreadsAreReused) {
+  Tracer::get_instance().start(8);
+  std::thread([] { TFLITE_TRACE_SCOPE("test_reuse_span"); }).join();
+  const size_t buffers = Tracer::get_instance().num_buffers();
+  // Kept for the dump until cleared
+  EXPECT_EQ(find_events("test_reuse_span").size(), 1);
+
+  Tracer::get_instance().clear();
+  for (int i = 0; i < 10; ++i) {
+    std::thread([] { TFLITE_TRACE_SCOPE("test_reuse_span"); }).join();
+    Tracer::get_instance().clear();
+  }
+  Tracer::get_instance().stop();
+  EXPECT_EQ(Tracer::get_instance().num_buffers(), buffers);
+}
+
+TEST_F(TracerTest, LiveDumpSeesConsistentSpans) {
+  Tracer::get_instance().start(64);
+  std::atomic<bool> done{false};
+  std::thread writer([&done] {
+    for (int64_t i = 1; i <= 200000; ++i) {
+      const Tracer::Clock::time_point start{std::chrono::nanoseconds(i)};
+      Tracer::get_instance().record("test_live_span", start,
+                                    start + std::chrono::nanoseconds(i), i);
+    }
+    done = true;
+  });
+
+  int inconsistent = 0;
+  while (!done) {
+    int64_t last = 0;
+    for (const auto &event : find_events("test_live_span")) {
+      if (event.duration_ns != event.start_ns ||
+          event.frame_id != event.start_ns || event.frame_id <= last) {
+        ++inconsistent;
+      }
+      last = event.frame_id;
+    }
+  }
+  writer.join();
+  Tracer::get_instance().stop();
+  EXPECT_EQ(inconsistent, 0);
+}
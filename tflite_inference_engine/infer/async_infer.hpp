@@ -0,0 +1,278 @@
+/**
+ * @file async_infer.hpp
+ * @details Asynchronous inference on a dedicated worker thread per engine
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef ASYNC_INFERENCE_ENGINE_HPP
+#define ASYNC_INFERENCE_ENGINE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <infer/infer.hpp>
+
+namespace tflite::inference {
+/**
+ * @brief Results of one request. The outputs are copies owned by the
+ * request, quantized outputs are dequantized.
+ */
+struct InferenceResult {
+  InferenceStatus status = InferenceStatus::INVOCATION_ERROR;
+  std::vector<std::vector<float>> outputs;
+
+  /**
+   * @brief Get an output
+   * @param index Output index
+   * @return Pointer to the output, nullptr if it does not exist
+   */
+  [[nodiscard]] const float *output(size_t index) const {
+    return index < this->outputs.size() ? this->outputs[index].data()
+                                        : nullptr;
+  }
+
+  /**
+   * @brief Copy the outputs of the engine's last invocation
+   * @param engine Engine after a successful invoke()
+   * @return Results with SUCCESS status
+   */
+  static InferenceResult collect(const TFLiteInferenceEngine &engine) {
+    return from_outputs(engine.get_outputs());
+  }
+
+  /**
+   * @brief Copy output views, e.g. the slices of one image of a batch
+   * @param outputs Output views
+   * @return Results with SUCCESS status
+   */
+  static InferenceResult
+  from_outputs(const std::vector<OutputTensor> &outputs) {
+    InferenceResult result;
+    result.status = InferenceStatus::SUCCESS;
+    result.outputs.resize(outputs.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      const OutputTensor &output = outputs[i];
+      auto &values = result.outputs[i];
+      values.resize(output.size());
+      if (output.type() == kTfLiteFloat32) {
+        std::memcpy(values.data(), output.data(),
+                    values.size() * sizeof(float));
+      } else {
+        for (size_t j = 0; j < values.size(); ++j) {
+          values[j] = output[j];
+        }
+      }
+    }
+    return result;
+  }
+};
+
+class AsyncInferenceEngine {
+public:
+  using Callback = std::function<void(InferenceResult &&)>;
+
+public:
+  /**
+   * @brief Create the engine
+   * @param queue_capacity Maximum number of pending requests, further
+   *        requests block until a slot is free
+   */
+  explicit AsyncInferenceEngine(size_t queue_capacity = 2)
+      : m_capacity(std::max<size_t>(1, queue_capacity)) {}
+  ~AsyncInferenceEngine() { this->stop(); }
+
+  AsyncInferenceEngine(const AsyncInferenceEngine &) = delete;
+  AsyncInferenceEngine &operator=(const AsyncInferenceEngine &) = delete;
+  AsyncInferenceEngine(AsyncInferenceEngine &&) = delete;
+  AsyncInferenceEngine &operator=(AsyncInferenceEngine &&) = delete;
+
+public:
+  /**
+   * @brief Load the model and start the worker thread
+   * @param model_path Path to the model in the format of string
+   * @param options Threading and delegate options
+   * @return Status
+   */
+  InferenceStatus load_model(const std::string &model_path,
+                             const EngineOptions &options = EngineOptions()) {
+    this->stop();
+    auto status = this->m_engine.load_model(model_path, options);
+    if (status != InferenceStatus::SUCCESS) {
+      return status;
+    }
+
+    this->m_stopped = false;
+    this->m_worker = std::thread(&AsyncInferenceEngine::run, this);
+    return InferenceStatus::SUCCESS;
+  }
+
+public:
+  /**
+   * @brief Queue an image for inference. Blocks while the queue is full.
+   * The image is referenced, not copied, so the caller must not write into
+   * its buffer until the request is done; preprocess each frame into a new
+   * cv::Mat to overlap it with the running inference.
+   * @param input_image Input image in the format of cv::Mat
+   * @return Future of the results
+   */
+  std::future<InferenceResult> infer_async(const cv::Mat &input_image) {
+    Request request;
+    request.image = input_image;
+    auto future = request.promise.get_future();
+    this->push(std::move(request));
+    return future;
+  }
+
+public:
+  /**
+   * @brief Queue an image for inference and call back from the worker
+   * thread with the results. Blocks while the queue is full.
+   * @param input_image Input image in the format of cv::Mat
+   * @param callback Called with the results, must not block for long
+   */
+  void infer_async(const cv::Mat &input_image, Callback callback) {
+    Request request;
+    request.image = input_image;
+    request.callback = std::move(callback);
+    this->push(std::move(request));
+  }
+
+public:
+  /**
+   * @brief Get the number of pending requests
+   * @return Queue size
+   */
+  size_t queue_size() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    return this->m_queue.size();
+  }
+
+  /**
+   * @brief Get the wrapped engine, e.g. for the input size. Must not be used
+   * for inference while requests are pending.
+   * @return Engine
+   */
+  const TFLiteInferenceEngine &get_engine() const { return this->m_engine; }
+
+public:
+  /**
+   * @brief Finish the pending requests and stop the worker thread
+   */
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      this->m_stopped = true;
+    }
+    this->m_not_empty.notify_all();
+    this->m_not_full.notify_all();
+    if (this->m_worker.joinable()) {
+      this->m_worker.join();
+    }
+  }
+
+private:
+  struct Request {
+    cv::Mat image;
+    std::promise<InferenceResult> promise;
+    Callback callback;
+  };
+
+private:
+  /**
+   * @brief Add a request to the queue, waiting for a free slot
+   * @param request Request
+   */
+  void push(Request &&request) {
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    this->m_not_full.wait(lock, [this] {
+      return this->m_stopped || this->m_queue.size() < this->m_capacity;
+    });
+    if (this->m_stopped) {
+      lock.unlock();
+      LOG_EVERY_N(ERROR, 100) << "Async inference engine is not running";
+      this->complete(request, InferenceResult());
+      return;
+    }
+    this->m_queue.push_back(std::move(request));
+    lock.unlock();
+    this->m_not_empty.notify_one();
+  }
+
+private:
+  /**
+   * @brief Worker loop keeping the interpreter busy
+   */
+  void run() {
+    while (true) {
+      Request request;
+      {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        this->m_not_empty.wait(lock, [this] {
+          return this->m_stopped || !this->m_queue.empty();
+        });
+        if (this->m_queue.empty()) {
+          return;
+        }
+        request = std::move(this->m_queue.front());
+        this->m_queue.pop_front();
+      }
+      this->m_not_full.notify_one();
+      this->complete(request, this->process(request.image));
+    }
+  }
+
+private:
+  /**
+   * @brief Run the inference and copy the outputs out of the interpreter
+   * @param image Input image
+   * @return Results
+   */
+  InferenceResult process(const cv::Mat &image) {
+    InferenceStatus status = this->m_engine.set_input(image);
+    if (status == InferenceStatus::SUCCESS) {
+      status = this->m_engine.invoke();
+    }
+    if (status != InferenceStatus::SUCCESS) {
+      InferenceResult result;
+      result.status = status;
+      return result;
+    }
+    return InferenceResult::collect(this->m_engine);
+  }
+
+private:
+  /**
+   * @brief Hand the results to the future or the callback
+   * @param request Request
+   * @param result Results
+   */
+  static void complete(Request &request, InferenceResult &&result) {
+    if (request.callback) {
+      request.callback(std::move(result));
+    } else {
+      request.promise.set_value(std::move(result));
+    }
+  }
+
+private:
+  TFLiteInferenceEngine m_engine;
+  const size_t m_capacity;
+
+  std::mutex m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+  std::deque<Request> m_queue;
+  bool m_stopped = true;
+  std::thread m_worker;
+};
+} // namespace tflite::inference
+
+#endif // ASYNC_INFERENCE_ENGINE_HPP
@@ -0,0 +1,310 @@
+/**
+ * @file compute_thread_pool.hpp
+ * @details Process-wide pool of compute cores shared by all inference engines
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef COMPUTE_THREAD_POOL_HPP
+#define COMPUTE_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <log/glogging.hpp>
+
+namespace tflite::inference {
+class ComputeThreadPool;
+
+/**
+ * @brief Cores granted to one engine. Returned to the pool on destruction.
+ */
+class ThreadBudget {
+public:
+  ThreadBudget() = default;
+  ~ThreadBudget() { this->release(); }
+
+  ThreadBudget(const ThreadBudget &) = delete;
+  ThreadBudget &operator=(const ThreadBudget &) = delete;
+  ThreadBudget(ThreadBudget &&other) noexcept { *this = std::move(other); }
+  ThreadBudget &operator=(ThreadBudget &&other) noexcept {
+    if (this != &other) {
+      this->release();
+      this->m_pool = other.m_pool;
+      this->m_cores = std::move(other.m_cores);
+      this->m_pinned = other.m_pinned;
+      other.m_pool = nullptr;
+      other.m_cores.clear();
+    }
+    return *this;
+  }
+
+public:
+  /**
+   * @brief Get the number of compute threads the engine may run
+   * @return Number of threads, 0 if the budget is empty
+   */
+  [[nodiscard]] int num_threads() const {
+    return static_cast<int>(this->m_cores.size());
+  }
+
+  /**
+   * @brief Get the cores of the budget
+   * @return Core indices
+   */
+  [[nodiscard]] const std::vector<int> &cores() const { return this->m_cores; }
+
+  /**
+   * @brief Check if the engine threads are pinned to the cores
+   * @return True if pinned
+   */
+  [[nodiscard]] bool pinned() const { return this->m_pinned; }
+
+public:
+  /**
+   * @brief Return the cores to the pool
+   */
+  inline void release();
+
+private:
+  friend class ComputeThreadPool;
+
+  ComputeThreadPool *m_pool = nullptr;
+  std::vector<int> m_cores;
+  bool m_pinned = false;
+};
+
+/**
+ * @brief Restricts the calling thread to a set of cores for the lifetime of
+ * the scope. Threads created inside the scope inherit the affinity, which is
+ * how the TFLite and XNNPACK worker threads get pinned.
+ */
+class AffinityScope {
+public:
+  explicit AffinityScope(const std::vector<int> &cores) {
+#ifdef __linux__
+    if (cores.empty() ||
+        pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                               &this->m_previous) != 0) {
+      return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : cores) {
+      CPU_SET(core, &set);
+    }
+    this->m_active =
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0;
+    if (!this->m_active) {
+      LOG_FIRST_N(WARNING, 1) << "Failed to pin the thread to its cores";
+    }
+#else
+    (void)cores;
+#endif
+  }
+  ~AffinityScope() {
+#ifdef __linux__
+    if (this->m_active) {
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                             &this->m_previous);
+    }
+#endif
+  }
+
+  AffinityScope(const AffinityScope &) = delete;
+  AffinityScope &operator=(const AffinityScope &) = delete;
+  AffinityScope(AffinityScope &&) = delete;
+  AffinityScope &operator=(AffinityScope &&) = delete;
+
+private:
+#ifdef __linux__
+  cpu_set_t m_previous{};
+#endif
+  bool m_active = false;
+};
+
+/**
+ * @brief Hands out the cores of the process to the engines so that engines
+ * running side by side get disjoint cores instead of each starting one
+ * thread per core. The TFLite and XNNPACK thread pools are not reentrant, so
+ * every engine keeps its own threads and the pool shares the cores between
+ * them.
+ */
+class ComputeThreadPool {
+public:
+  /**
+   * @brief Get the instance of the pool
+   * @return Pool instance
+   */
+  static ComputeThreadPool &get_instance() {
+    static ComputeThreadPool instance;
+    return instance;
+  }
+
+public:
+  /**
+   * @brief Restrict the pool to a set of cores, e.g. to keep cores free for
+   * capture. Budgets already granted keep their cores and still count as
+   * load on the cores that remain in the pool.
+   * @param cores Core indices
+   */
+  void set_cores(const std::vector<int> &cores) {
+    if (cores.empty()) {
+      LOG(ERROR) << "Compute thread pool needs at least one core";
+      return;
+    }
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    this->m_cores = cores;
+  }
+
+public:
+  /**
+   * @brief Grant cores to an engine, the least loaded cores first. A
+   * default request takes every free core, so the first default engine gets
+   * all of them and the following ones a single shared core; engines that
+   * run side by side should request explicit thread counts.
+   * @param num_threads Requested number of threads, 0 for all cores no other
+   *        engine holds (at least one)
+   * @param pin Pin the engine threads to the granted cores
+   * @return Budget, released when destroyed
+   */
+  ThreadBudget acquire(int num_threads, bool pin = false) {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    if (num_threads <= 0) {
+      num_threads = std::max<int>(1, static_cast<int>(this->count_free()));
+    }
+
+    std::vector<size_t> order(this->m_cores.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return this->load(this->m_cores[a]) < this->load(this->m_cores[b]);
+    });
+
+    ThreadBudget budget;
+    budget.m_pool = this;
+    budget.m_pinned = pin;
+    for (int i = 0; i < num_threads; ++i) {
+      // More threads than cores share the cores round-robin
+      const int core = this->m_cores[order[i % order.size()]];
+      ++this->m_load[core];
+      budget.m_cores.push_back(core);
+    }
+    return budget;
+  }
+
+public:
+  /**
+   * @brief Get the number of cores of the pool
+   * @return Number of cores
+   */
+  size_t num_cores() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    return this->m_cores.size();
+  }
+
+  /**
+   * @brief Get the cores of the pool
+   * @return Core indices
+   */
+  std::vector<int> cores() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    return this->m_cores;
+  }
+
+  /**
+   * @brief Get the number of cores no engine holds
+   * @return Number of free cores
+   */
+  size_t num_free_cores() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    return this->count_free();
+  }
+
+private:
+  ComputeThreadPool() {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &set) == 0) {
+      for (int core = 0; core < CPU_SETSIZE; ++core) {
+        if (CPU_ISSET(core, &set)) {
+          this->m_cores.push_back(core);
+        }
+      }
+    }
+#endif
+    if (this->m_cores.empty()) {
+      this->m_cores.resize(std::max(1u, std::thread::hardware_concurrency()));
+      std::iota(this->m_cores.begin(), this->m_cores.end(), 0);
+    }
+  }
+  ComputeThreadPool(const ComputeThreadPool &) = delete;
+  ComputeThreadPool &operator=(const ComputeThreadPool &) = delete;
+
+private:
+  friend class ThreadBudget;
+
+  /**
+   * @brief Return the cores of a budget
+   * @param cores Core indices
+   */
+  void release(const std::vector<int> &cores) {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    for (int core : cores) {
+      auto it = this->m_load.find(core);
+      if (it != this->m_load.end() && --it->second == 0) {
+        this->m_load.erase(it);
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief Get the number of budgets holding a core, the caller holds the
+   * mutex
+   * @param core Core index
+   * @return Number of budgets
+   */
+  int load(int core) const {
+    auto it = this->m_load.find(core);
+    return it == this->m_load.end() ? 0 : it->second;
+  }
+
+  /**
+   * @brief Count the cores of the pool no budget holds, the caller holds the
+   * mutex
+   * @return Number of free cores
+   */
+  size_t count_free() const {
+    return std::count_if(this->m_cores.begin(), this->m_cores.end(),
+                         [this](int core) { return this->load(core) == 0; });
+  }
+
+private:
+  std::mutex m_mutex;
+  std::vector<int> m_cores;
+  // Number of budgets holding each core, by core index. Kept across
+  // set_cores() so budgets granted before still count
+  std::unordered_map<int, int> m_load;
+};
+
+void ThreadBudget::release() {
+  if (this->m_pool != nullptr) {
+    this->m_pool->release(this->m_cores);
+  }
+  this->m_pool = nullptr;
+  this->m_cores.clear();
+}
+} // namespace tflite::inference
+
+#endif // COMPUTE_THREAD_POOL_HPP
@@ -0,0 +1,54 @@
+/**
+ * @file engine_options.hpp
+ * @details Options of the inference engine for threading and delegates
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef ENGINE_OPTIONS_HPP
+#define ENGINE_OPTIONS_HPP
+
+#include <string>
+
+namespace tflite::inference {
+enum class DelegateType {
+  DEFAULT, // Delegates TFLite applies on its own (XNNPACK when built in)
+  NONE,    // Builtin CPU kernels only
+  XNNPACK  // XNNPACK applied explicitly with the options below
+};
+
+struct XNNPackOptions {
+  // Run float models with fp16 arithmetic where the CPU supports it
+  bool fp16 = false;
+  // Delegate signed and unsigned 8-bit quantized operators
+  bool qs8 = true;
+  bool qu8 = true;
+  // Delegate fully connected operators with non-constant weights
+  bool dynamic_fully_connected = false;
+  // Keep the packed weights in a file and memory-map it on later loads
+  // instead of repacking them
+  bool persistent_weights_cache = false;
+  // Cache file, derived from the model path and content when empty
+  std::string weights_cache_path;
+};
+
+struct EngineOptions {
+  // Number of interpreter threads, 0 to use the cores no other engine holds,
+  // which leaves a single core to every later default engine. Cores are
+  // granted by the process-wide ComputeThreadPool
+  int num_threads = 0;
+  // Pin the interpreter threads to the granted cores
+  bool pin_threads = false;
+  DelegateType delegate = DelegateType::DEFAULT;
+  XNNPackOptions xnnpack;
+  // Run on the builtin CPU kernels if the delegate cannot be applied,
+  // otherwise loading the model fails
+  bool fallback_to_cpu = true;
+  // Record the time of every operator on each invocation, read with
+  // TFLiteInferenceEngine::get_profile()
+  bool enable_profiling = false;
+};
+} // namespace tflite::inference
+
+#endif // ENGINE_OPTIONS_HPP
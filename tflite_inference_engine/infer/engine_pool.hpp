@@ -0,0 +1,336 @@
+/**
+ * @file engine_pool.hpp
+ * @details Pool of inference engines sharing one model for concurrent
+ * inference from several threads
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef INFERENCE_ENGINE_POOL_HPP
+#define INFERENCE_ENGINE_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <infer/infer.hpp>
+
+namespace tflite::inference {
+class InferenceEnginePool {
+public:
+  /**
+   * @brief Statistics to size the pool against the available cores
+   */
+  struct Stats {
+    size_t size = 0;
+    uint64_t acquisitions = 0;
+    uint64_t failed_acquisitions = 0;
+    double total_wait_ms = 0.0;
+    double max_wait_ms = 0.0;
+    double utilization = 0.0;
+  };
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+public:
+  /**
+   * @brief Exclusive checkout of one engine of the pool. The engine is
+   * returned to the pool when the lease is destroyed.
+   */
+  class Lease {
+  public:
+    ~Lease() { this->release(); }
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+    Lease(Lease &&other) noexcept
+        : m_pool(other.m_pool), m_index(other.m_index),
+          m_start(other.m_start) {
+      other.m_pool = nullptr;
+    }
+    Lease &operator=(Lease &&other) noexcept {
+      if (this != &other) {
+        this->release();
+        this->m_pool = other.m_pool;
+        this->m_index = other.m_index;
+        this->m_start = other.m_start;
+        other.m_pool = nullptr;
+      }
+      return *this;
+    }
+
+  public:
+    /**
+     * @brief Check if the lease holds an engine
+     * @return False for the empty lease of an unloaded pool
+     */
+    explicit operator bool() const { return this->m_pool != nullptr; }
+
+    TFLiteInferenceEngine &operator*() const {
+      return *this->m_pool->m_engines[this->m_index];
+    }
+    TFLiteInferenceEngine *operator->() const {
+      return this->m_pool->m_engines[this->m_index].get();
+    }
+
+  private:
+    friend class InferenceEnginePool;
+    Lease() : m_pool(nullptr), m_index(0) {}
+    Lease(InferenceEnginePool *pool, size_t index)
+        : m_pool(pool), m_index(index), m_start(Clock::now()) {}
+
+    void release() {
+      if (this->m_pool) {
+        this->m_pool->release(this->m_index, Clock::now() - this->m_start);
+        this->m_pool = nullptr;
+      }
+    }
+
+  private:
+    InferenceEnginePool *m_pool;
+    size_t m_index;
+    Clock::time_point m_start;
+  };
+
+public:
+  InferenceEnginePool() = default;
+  ~InferenceEnginePool() = default;
+
+  InferenceEnginePool(const InferenceEnginePool &) = delete;
+  InferenceEnginePool &operator=(const InferenceEnginePool &) = delete;
+  InferenceEnginePool(InferenceEnginePool &&) = delete;
+  InferenceEnginePool &operator=(InferenceEnginePool &&) = delete;
+
+public:
+  /**
+   * @brief Load the model once and create one interpreter per pool slot.
+   * Must not be called while leases are held.
+   * @param model_path Path to the model in the format of string
+   * @param size Number of engines in the pool
+   * @param options Options of each engine. With 0 threads the cores are
+   *        split evenly between the engines
+   */
+  InferenceStatus load_model(const std::string &model_path, size_t size,
+                             EngineOptions options = EngineOptions()) {
+    if (model_path.empty() || !std::filesystem::exists(model_path)) {
+      LOG(ERROR) << "Model path is empty or does not exist";
+      return InferenceStatus::MODEL_LOAD_ERROR;
+    }
+
+    if (size == 0) {
+      LOG(ERROR) << "Pool size must be greater than 0";
+      return InferenceStatus::INTERPRETER_ERROR;
+    }
+
+    std::shared_ptr<tflite::FlatBufferModel> model =
+        ModelRegistry::get_instance().load(model_path);
+    if (!model) {
+      LOG(ERROR) << "Failed to load model: " << model_path;
+      return InferenceStatus::MODEL_LOAD_ERROR;
+    }
+
+    options.xnnpack =
+        WeightsCache::resolve(options.xnnpack, model_path, *model);
+
+    if (options.num_threads <= 0) {
+      options.num_threads = std::max(
+          1, static_cast<int>(ComputeThreadPool::get_instance().num_cores() /
+                              size));
+    }
+
+    std::vector<std::unique_ptr<TFLiteInferenceEngine>> engines;
+    for (size_t i = 0; i < size; ++i) {
+      auto engine = std::make_unique<TFLiteInferenceEngine>();
+      auto status = engine->load_model(model, options);
+      if (status != InferenceStatus::SUCCESS) {
+        return status;
+      }
+      engines.push_back(std::move(engine));
+    }
+
+    this->m_engines = std::move(engines);
+    this->m_busy = std::make_unique<std::atomic<bool>[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+      this->m_busy[i].store(false, std::memory_order_relaxed);
+    }
+    this->reset_stats();
+
+    LOG(INFO) << "Created inference pool with " << size << " engines and "
+              << options.num_threads << " threads each";
+    return InferenceStatus::SUCCESS;
+  }
+
+public:
+  /**
+   * @brief Check out a free engine without blocking
+   * @return Lease of the engine, empty if all engines are busy
+   */
+  std::optional<Lease> try_acquire() {
+    const auto index = this->try_acquire_slot();
+    if (!index) {
+      this->m_failed_acquisitions.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    return Lease(this, *index);
+  }
+
+public:
+  /**
+   * @brief Check out an engine, waiting until one becomes free. The waiting
+   * time is accounted in the statistics.
+   * @return Lease of the engine, empty if the pool is not loaded
+   */
+  Lease acquire() {
+    if (this->m_engines.empty()) {
+      LOG_EVERY_N(ERROR, 100)
+          << "Inference pool has no engines, load a model first";
+      return Lease();
+    }
+
+    auto index = this->try_acquire_slot();
+    if (index) {
+      return Lease(this, *index);
+    }
+
+    const auto start = Clock::now();
+    {
+      std::unique_lock<std::mutex> lock(this->m_mutex);
+      this->m_cv.wait(lock, [&] {
+        index = this->try_acquire_slot();
+        return index.has_value();
+      });
+    }
+    this->record_wait(Clock::now() - start);
+    return Lease(this, *index);
+  }
+
+public:
+  /**
+   * @brief Get the number of engines in the pool
+   * @return Pool size
+   */
+  [[nodiscard]] size_t size() const { return this->m_engines.size(); }
+
+public:
+  /**
+   * @brief Get the pool statistics since the last reset
+   * @return Statistics
+   */
+  [[nodiscard]] Stats get_stats() const {
+    Stats stats;
+    stats.size = this->m_engines.size();
+    stats.acquisitions = this->m_acquisitions.load(std::memory_order_relaxed);
+    stats.failed_acquisitions =
+        this->m_failed_acquisitions.load(std::memory_order_relaxed);
+    stats.total_wait_ms = this->m_wait_ns.load(std::memory_order_relaxed) / 1e6;
+    stats.max_wait_ms =
+        this->m_max_wait_ns.load(std::memory_order_relaxed) / 1e6;
+
+    const auto elapsed_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch())
+            .count() -
+        this->m_stats_start_ns.load(std::memory_order_relaxed);
+    if (elapsed_ns > 0 && stats.size > 0) {
+      stats.utilization =
+          static_cast<double>(this->m_busy_ns.load(std::memory_order_relaxed)) /
+          (static_cast<double>(elapsed_ns) * stats.size);
+    }
+    return stats;
+  }
+
+public:
+  /**
+   * @brief Reset the pool statistics
+   */
+  void reset_stats() {
+    this->m_acquisitions = 0;
+    this->m_failed_acquisitions = 0;
+    this->m_wait_ns = 0;
+    this->m_max_wait_ns = 0;
+    this->m_busy_ns = 0;
+    this->m_stats_start_ns.store(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch())
+            .count(),
+        std::memory_order_relaxed);
+  }
+
+private:
+  /**
+   * @brief Mark the first free engine as busy
+   * @return Index of the engine, empty if all engines are busy
+   */
+  std::optional<size_t> try_acquire_slot() {
+    for (size_t i = 0; i < this->m_engines.size(); ++i) {
+      if (!this->m_busy[i].load(std::memory_order_relaxed) &&
+          !this->m_busy[i].exchange(true, std::memory_order_acquire)) {
+        this->m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+        return i;
+      }
+    }
+    return std::nullopt;
+  }
+
+private:
+  /**
+   * @brief Return an engine to the pool and wake up a waiting caller
+   * @param index Index of the engine
+   * @param busy Time the engine was checked out
+   */
+  void release(size_t index, Clock::duration busy) {
+    this->m_busy_ns.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(),
+        std::memory_order_relaxed);
+    {
+      // Taking the lock orders the release against a waiter's predicate check
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      this->m_busy[index].store(false, std::memory_order_release);
+    }
+    this->m_cv.notify_one();
+  }
+
+private:
+  /**
+   * @brief Account the time a caller waited for an engine
+   * @param wait Waiting time
+   */
+  void record_wait(Clock::duration wait) {
+    const uint64_t wait_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+    this->m_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+    uint64_t max_wait_ns = this->m_max_wait_ns.load(std::memory_order_relaxed);
+    while (wait_ns > max_wait_ns &&
+           !this->m_max_wait_ns.compare_exchange_weak(
+               max_wait_ns, wait_ns, std::memory_order_relaxed)) {
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<TFLiteInferenceEngine>> m_engines;
+  std::unique_ptr<std::atomic<bool>[]> m_busy;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+
+  std::atomic<uint64_t> m_acquisitions{0};
+  std::atomic<uint64_t> m_failed_acquisitions{0};
+  std::atomic<uint64_t> m_wait_ns{0};
+  std::atomic<uint64_t> m_max_wait_ns{0};
+  std::atomic<uint64_t> m_busy_ns{0};
+  // Clock::time_since_epoch() of the last reset, read without the lock
+  std::atomic<int64_t> m_stats_start_ns{
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          Clock::now().time_since_epoch())
+          .count()};
+};
+} // namespace tflite::inference
+
+#endif // INFERENCE_ENGINE_POOL_HPP
@@ -9,21 +9,35 @@
 #ifndef INFERENCE_ENGINE_HPP
 #define INFERENCE_ENGINE_HPP
 
+#include <cstring>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <opencv2/opencv.hpp>
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
 #include <tensorflow/lite/interpreter.h>
 #include <tensorflow/lite/kernels/register.h>
 #include <tensorflow/lite/model.h>
 
 #include <filesystem>
+#include <infer/compute_thread_pool.hpp>
+#include <infer/engine_options.hpp>
+#include <infer/model_registry.hpp>
+#include <infer/op_profiler.hpp>
+#include <infer/output_tensor.hpp>
+#include <infer/tensor_view.hpp>
+#include <infer/weights_cache.hpp>
 #include <log/glogging.hpp>
 #include <log/log.hpp>
+#include <metrics/stage_metrics.hpp>
+#include <trace/tracer.hpp>
 #include <tuple>
 #include <utils/inference_status.hpp>
+#include <utils/scoped_timer.hpp>
 
 namespace tflite ::inference {
 class TFLiteInferenceEngine {
@@ -57,6 +71,30 @@ public:
     return this->m_input_channels;
   }
 
+  /**
+   * @brief Get the input tensor type
+   * @return Input tensor type, kTfLiteNoType if no model is loaded
+   */
+  [[nodiscard]] TfLiteType get_input_type() const {
+    if (!this->m_interpreter) {
+      return kTfLiteNoType;
+    }
+    return this->m_interpreter->tensor(this->m_interpreter->inputs()[0])->type;
+  }
+
+  /**
+   * @brief Get the input quantization parameters
+   * @return Scale and zero point of the input tensor, scale is 0 for
+   *         non-quantized inputs
+   */
+  [[nodiscard]] TfLiteQuantizationParams get_input_quantization() const {
+    if (!this->m_interpreter) {
+      return {0.0f, 0};
+    }
+    return this->m_interpreter->tensor(this->m_interpreter->inputs()[0])
+        ->params;
+  }
+
 public:
   /**
    * @brief Get the output height
@@ -87,39 +125,366 @@ public:
    */
   std::tuple<float *, float *, float *, float *>
   infer(const cv::Mat &input_image) {
-    if (input_image.empty()) {
-      LOG(ERROR) << "Input image is empty";
+    TFLITE_TRACE_SCOPE("infer");
+    if (this->set_input(input_image) != inference::InferenceStatus::SUCCESS) {
       return {nullptr, nullptr, nullptr, nullptr};
     }
+    return this->infer_in_place();
+  }
+
+public:
+  /**
+   * @brief Copy the image into the input tensor without invoking
+   * @param input_image Input image in the format of cv::Mat
+   * @return SUCCESS, INPUT_ERROR or INTERPRETER_ERROR
+   */
+  inference::InferenceStatus set_input(const cv::Mat &input_image) {
+    TFLITE_TRACE_SCOPE("set_input");
+    if (input_image.empty()) {
+      LOG_EVERY_N(ERROR, 100) << "Input image is empty";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
 
     if (!this->m_interpreter) {
-      LOG(ERROR) << "Interpreter not initialized";
-      return {nullptr, nullptr, nullptr, nullptr};
+      LOG_EVERY_N(ERROR, 100) << "Interpreter not initialized";
+      return inference::InferenceStatus::INTERPRETER_ERROR;
+    }
+
+    cv::Mat input = this->input_view();
+    if (input.empty()) {
+      LOG_EVERY_N(ERROR, 100) << "Failed to get input tensor";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+
+    const auto quantization = this->get_input_quantization();
+    if (input_image.size() == input.size() &&
+        input_image.type() == input.type()) {
+      // Writes through the view, also handles non-continuous images
+      input_image.copyTo(input);
+    } else if (input_image.size() == input.size() &&
+               input_image.channels() == input.channels() &&
+               input_image.depth() == CV_32F && input.depth() != CV_32F &&
+               quantization.scale > 0.0f) {
+      // Quantize real valued images into the integer input tensor
+      input_image.convertTo(input, input.type(), 1.0 / quantization.scale,
+                            quantization.zero_point);
+    } else {
+      LOG_EVERY_N(ERROR, 100)
+          << "Input image " << input_image.cols << "x" << input_image.rows
+          << " (type " << input_image.type()
+          << ") does not match the input tensor " << input.cols << "x"
+          << input.rows << " (type " << input.type() << ")";
+      return inference::InferenceStatus::INPUT_ERROR;
     }
+    return inference::InferenceStatus::SUCCESS;
+  }
 
+public:
+  /**
+   * @brief Get a writable view of the input tensor. Preprocessing can write
+   * directly into it (e.g. as the destination of cv::resize or convertTo,
+   * with matching size and type) before calling infer_in_place(). The view
+   * is invalidated by load_model().
+   * @return Input tensor as cv::Mat of input height x width with one channel
+   *         per input channel, empty if the interpreter is not initialized
+   */
+  cv::Mat input_view() {
+    if (!this->m_interpreter) {
+      LOG_EVERY_N(ERROR, 100) << "Interpreter not initialized";
+      return cv::Mat();
+    }
+
+    const int type = this->get_input_cv_type();
     auto *input = this->get_input_tensor();
-    if (!input) {
-      LOG(ERROR) << "Failed to get input tensor";
-      return {nullptr, nullptr, nullptr, nullptr};
+    if (type < 0 || !input) {
+      return cv::Mat();
     }
+    return cv::Mat(this->m_input_height, this->m_input_width, type, input);
+  }
 
-    memcpy(input, input_image.data,
-           input_image.total() * input_image.elemSize());
+  /**
+   * @brief Get a writable view of one image of a batched input tensor, to
+   * preprocess a batch in place before invoke_batch(). The interpreter for
+   * the batch size is created on first use.
+   * @param batch_size Number of images in the batch
+   * @param batch_index Index of the image in the batch
+   * @return Input tensor slice as cv::Mat, empty on failure
+   */
+  cv::Mat input_view(int batch_size, int batch_index) {
+    if (!this->m_interpreter || batch_index < 0 ||
+        batch_index >= batch_size) {
+      LOG_EVERY_N(ERROR, 100)
+          << "Interpreter not initialized or batch index out of range";
+      return cv::Mat();
+    }
 
-    if (this->m_interpreter->Invoke() != kTfLiteOk) {
-      LOG(ERROR) << "Failed to invoke the interpreter";
-      return {nullptr, nullptr, nullptr, nullptr};
+    const int type = this->get_input_cv_type();
+    const int allocated = this->get_allocated_batch_size(batch_size);
+    tflite::Interpreter *interpreter = this->get_batch_interpreter(allocated);
+    if (type < 0 || !interpreter) {
+      return cv::Mat();
     }
+    TfLiteTensor *input = interpreter->tensor(interpreter->inputs()[0]);
+    const size_t image_bytes = input->bytes / allocated;
+    return cv::Mat(this->m_input_height, this->m_input_width, type,
+                   input->data.raw + batch_index * image_bytes);
+  }
 
-    if (this->m_interpreter->typed_output_tensor<float>(0) == nullptr) {
-      LOG(ERROR) << "Output tensor is nullptr";
+public:
+  /**
+   * @brief Get the inference results for the data already written into the
+   * input tensor through input_view()
+   * @return Tuple of output locations, output classes, output scores
+   *         and number of detections
+   */
+  std::tuple<float *, float *, float *, float *> infer_in_place() {
+    if (this->invoke() != inference::InferenceStatus::SUCCESS) {
       return {nullptr, nullptr, nullptr, nullptr};
     }
 
-    return {this->m_interpreter->typed_output_tensor<float>(0),
-            this->m_interpreter->typed_output_tensor<float>(1),
-            this->m_interpreter->typed_output_tensor<float>(2),
-            this->m_interpreter->typed_output_tensor<float>(3)};
+    if (this->m_interpreter->output_tensor(0)->type != kTfLiteFloat32) {
+      LOG_FIRST_N(WARNING, 1) << "Output tensors are quantized, read them "
+                                 "with get_output()";
+    }
+
+    return {get_batch_output(this->m_interpreter.get(), 0, 0, 1),
+            get_batch_output(this->m_interpreter.get(), 1, 0, 1),
+            get_batch_output(this->m_interpreter.get(), 2, 0, 1),
+            get_batch_output(this->m_interpreter.get(), 3, 0, 1)};
+  }
+
+public:
+  /**
+   * @brief Invoke the interpreter on the current input tensor. The results
+   * are read with get_output().
+   * @return SUCCESS, INTERPRETER_ERROR or INVOCATION_ERROR
+   */
+  inference::InferenceStatus invoke() {
+    TFLITE_TRACE_SCOPE("invoke");
+    if (!this->m_interpreter) {
+      LOG_EVERY_N(ERROR, 100) << "Interpreter not initialized";
+      return inference::InferenceStatus::INTERPRETER_ERROR;
+    }
+
+    AffinityScope affinity(this->get_pinned_cores());
+    if (this->m_profiler) {
+      this->m_profiler->begin();
+    }
+    TfLiteStatus invoke_status;
+    {
+      utils::timer::ScopedTimer timer(metrics::StageMetrics::get().invoke);
+      invoke_status = this->m_interpreter->Invoke();
+    }
+    if (this->m_profiler) {
+      this->m_profiler->end(*this->m_interpreter);
+    }
+    if (invoke_status != kTfLiteOk) {
+      metrics::StageMetrics::get().invoke_errors.increment();
+      LOG_EVERY_N(ERROR, 100) << "Failed to invoke the interpreter";
+      return inference::InferenceStatus::INVOCATION_ERROR;
+    }
+
+    if (this->m_interpreter->outputs().empty()) {
+      LOG_EVERY_N(ERROR, 100) << "Output tensor is nullptr";
+      return inference::InferenceStatus::INVOCATION_ERROR;
+    }
+    return inference::InferenceStatus::SUCCESS;
+  }
+
+public:
+  /**
+   * @brief Invoke the interpreter of a batch size on the inputs written
+   * through input_view(batch_size, i). The results are read with
+   * get_output(index, batch_size, batch_index).
+   * @param batch_size Number of images in the batch
+   * @return SUCCESS, INTERPRETER_ERROR or INVOCATION_ERROR
+   */
+  inference::InferenceStatus invoke_batch(int batch_size) {
+    TFLITE_TRACE_SCOPE("invoke_batch");
+    if (!this->m_interpreter) {
+      LOG_EVERY_N(ERROR, 100) << "Interpreter not initialized";
+      return inference::InferenceStatus::INTERPRETER_ERROR;
+    }
+    tflite::Interpreter *interpreter = this->get_batch_interpreter(
+        this->get_allocated_batch_size(batch_size));
+    if (!interpreter) {
+      LOG_EVERY_N(ERROR, 100)
+          << "Failed to get interpreter for batch size " << batch_size;
+      return inference::InferenceStatus::INTERPRETER_ERROR;
+    }
+
+    AffinityScope affinity(this->get_pinned_cores());
+    TfLiteStatus invoke_status;
+    {
+      utils::timer::ScopedTimer timer(metrics::StageMetrics::get().invoke);
+      invoke_status = interpreter->Invoke();
+    }
+    if (invoke_status != kTfLiteOk) {
+      metrics::StageMetrics::get().invoke_errors.increment();
+      LOG_EVERY_N(ERROR, 100) << "Failed to invoke the interpreter";
+      return inference::InferenceStatus::INVOCATION_ERROR;
+    }
+    return inference::InferenceStatus::SUCCESS;
+  }
+
+public:
+  /**
+   * @brief Get the number of output tensors
+   * @return Number of outputs, 0 if no model is loaded
+   */
+  [[nodiscard]] size_t get_num_outputs() const {
+    return this->m_interpreter ? this->m_interpreter->outputs().size() : 0;
+  }
+
+public:
+  /**
+   * @brief Get an output tensor of the last invocation. Works for float and
+   * quantized outputs, quantized elements are dequantized only when read.
+   * The view is overwritten by the next invocation.
+   * @param index Output index
+   * @return View of the output, empty if the output does not exist
+   */
+  [[nodiscard]] OutputTensor get_output(size_t index) const {
+    if (index >= this->get_num_outputs()) {
+      return OutputTensor();
+    }
+    return OutputTensor(this->m_interpreter->output_tensor(index));
+  }
+
+  /**
+   * @brief Get the slice of an output tensor belonging to one image of the
+   * last invoke_batch() of the batch size
+   * @param index Output index
+   * @param batch_size Number of images in the batch
+   * @param batch_index Index of the image in the batch
+   * @return View of the image's output, empty if it does not exist
+   */
+  [[nodiscard]] OutputTensor get_output(size_t index, int batch_size,
+                                        int batch_index) const {
+    const int allocated = this->get_allocated_batch_size(batch_size);
+    const tflite::Interpreter *interpreter =
+        this->find_batch_interpreter(allocated);
+    if (interpreter == nullptr || index >= interpreter->outputs().size() ||
+        batch_index < 0 || batch_index >= batch_size) {
+      return OutputTensor();
+    }
+    const OutputTensor output(interpreter->output_tensor(index));
+    return output.shape().dim(0) == allocated ? output.slice(batch_index)
+                                              : output;
+  }
+
+  /**
+   * @brief Get views of all output tensors of the last invocation
+   * @return One view per output, in the model's output order
+   */
+  [[nodiscard]] std::vector<OutputTensor> get_outputs() const {
+    std::vector<OutputTensor> outputs;
+    outputs.reserve(this->get_num_outputs());
+    for (size_t i = 0; i < this->get_num_outputs(); ++i) {
+      outputs.push_back(this->get_output(i));
+    }
+    return outputs;
+  }
+
+  /**
+   * @brief Get a typed view of an output tensor of the last invocation, with
+   * its shape, strides and quantization. The view is overwritten by the next
+   * invocation.
+   * @tparam T Element type, e.g. float, uint8_t or int8_t
+   * @param index Output index
+   * @return View, empty if the output does not exist or is not of type T
+   */
+  template <typename T>
+  [[nodiscard]] TensorView<const T> get_output_view(size_t index) const {
+    if (index >= this->get_num_outputs()) {
+      return TensorView<const T>();
+    }
+    const TfLiteTensor *tensor = this->m_interpreter->output_tensor(index);
+    if (tensor->type != tensor_type_v<T>) {
+      LOG_FIRST_N(WARNING, 1)
+          << "Output " << index << " is of type "
+          << TfLiteTypeGetName(tensor->type) << ", not "
+          << TfLiteTypeGetName(tensor_type_v<T>);
+      return TensorView<const T>();
+    }
+    return TensorView<const T>::from_tensor(tensor);
+  }
+
+  /**
+   * @brief Get the shape of an output tensor
+   * @param index Output index
+   * @return Shape, rank 0 if the output does not exist
+   */
+  [[nodiscard]] TensorShape get_output_shape(size_t index) const {
+    if (index >= this->get_num_outputs()) {
+      return TensorShape();
+    }
+    return TensorShape(this->m_interpreter->output_tensor(index)->dims);
+  }
+
+public:
+  /**
+   * @brief Get the inference results for a batch of input images in a single
+   * invocation. The interpreter for each batch size is created and allocated
+   * once and reused on subsequent calls.
+   * @param input_images Input images in the format of cv::Mat. Every image
+   *        must match the size and type of the model input
+   * @return One tuple of output locations, output classes, output scores
+   *         and number of detections per input image, in the input order.
+   *         Empty vector on failure
+   */
+  std::vector<std::tuple<float *, float *, float *, float *>>
+  infer_batch(const std::vector<cv::Mat> &input_images) {
+    TFLITE_TRACE_SCOPE("infer_batch");
+    if (input_images.empty()) {
+      LOG_EVERY_N(ERROR, 100) << "Input batch is empty";
+      return {};
+    }
+
+    if (!this->m_interpreter) {
+      LOG_EVERY_N(ERROR, 100) << "Interpreter not initialized";
+      return {};
+    }
+
+    const int batch_size = static_cast<int>(input_images.size());
+    const int allocated = this->get_allocated_batch_size(batch_size);
+    tflite::Interpreter *interpreter = this->get_batch_interpreter(allocated);
+    if (!interpreter) {
+      LOG_EVERY_N(ERROR, 100)
+          << "Failed to get interpreter for batch size " << batch_size;
+      return {};
+    }
+
+    // Images past batch_size pad the rounded batch, their outputs are
+    // ignored
+    TfLiteTensor *input = interpreter->tensor(interpreter->inputs()[0]);
+    const size_t image_bytes = input->bytes / allocated;
+    for (int b = 0; b < batch_size; ++b) {
+      const cv::Mat &image = input_images[b];
+      if (image.empty() || !image.isContinuous() ||
+          image.total() * image.elemSize() != image_bytes) {
+        LOG_EVERY_N(ERROR, 100) << "Input image " << b
+                                << " does not match the input tensor size";
+        return {};
+      }
+      memcpy(input->data.raw + b * image_bytes, image.data, image_bytes);
+    }
+
+    AffinityScope affinity(this->get_pinned_cores());
+    if (interpreter->Invoke() != kTfLiteOk) {
+      LOG_EVERY_N(ERROR, 100) << "Failed to invoke the interpreter";
+      return {};
+    }
+
+    std::vector<std::tuple<float *, float *, float *, float *>> results;
+    results.reserve(batch_size);
+    for (int b = 0; b < batch_size; ++b) {
+      results.emplace_back(get_batch_output(interpreter, 0, b, allocated),
+                           get_batch_output(interpreter, 1, b, allocated),
+                           get_batch_output(interpreter, 2, b, allocated),
+                           get_batch_output(interpreter, 3, b, allocated));
+    }
+    return results;
   }
 
 public:
@@ -127,39 +492,123 @@ public:
    * @brief Load the model from the given path in the memory and allocate
    * tensors
    * @param model_path Path to the model in the format of string
+   * @param options Threading and delegate options
    */
-  inference::InferenceStatus load_model(const std::string &model_path) {
+  inference::InferenceStatus
+  load_model(const std::string &model_path,
+             const EngineOptions &options = EngineOptions()) {
+    TFLITE_TRACE_SCOPE("load_model");
+    utils::timer::ScopedTimer timer(metrics::StageMetrics::get().model_load);
     if (model_path.empty() || !std::filesystem::exists(model_path)) {
       LOG(ERROR) << "Model path is empty or does not exist";
       return inference::InferenceStatus::MODEL_LOAD_ERROR;
     }
-    // Load the model
-    this->m_model = tflite::FlatBufferModel::BuildFromFile(model_path.c_str());
+    // Load the model, shared with other engines using the same file
+    std::shared_ptr<tflite::FlatBufferModel> model =
+        ModelRegistry::get_instance().load(model_path);
 
-    if (!this->m_model) {
+    if (!model) {
       LOG(ERROR) << "Failed to load model: " << model_path;
       return inference::InferenceStatus::MODEL_LOAD_ERROR;
     }
 
+    EngineOptions resolved_options = options;
+    resolved_options.xnnpack =
+        WeightsCache::resolve(options.xnnpack, model_path, *model);
+    return this->prepare_model(std::move(model), resolved_options);
+  }
+
+public:
+  /**
+   * @brief Load the model from a caller-owned memory buffer, e.g. a model
+   * embedded in the binary, and allocate tensors
+   * @param data Model flatbuffer, must outlive the engine
+   * @param size Size of the buffer in bytes
+   * @param options Threading and delegate options
+   */
+  inference::InferenceStatus
+  load_model_from_buffer(const void *data, size_t size,
+                         const EngineOptions &options = EngineOptions()) {
+    TFLITE_TRACE_SCOPE("load_model");
+    utils::timer::ScopedTimer timer(metrics::StageMetrics::get().model_load);
+    std::shared_ptr<tflite::FlatBufferModel> model =
+        ModelRegistry::get_instance().load_from_buffer(data, size);
+    if (!model) {
+      LOG(ERROR) << "Failed to load model from buffer";
+      return inference::InferenceStatus::MODEL_LOAD_ERROR;
+    }
+    return this->prepare_model(std::move(model), options);
+  }
+
+public:
+  /**
+   * @brief Create the interpreter for an already loaded model and allocate
+   * tensors. The model can be shared between several engines.
+   * @param model Loaded model
+   * @param options Threading and delegate options
+   */
+  inference::InferenceStatus
+  load_model(std::shared_ptr<tflite::FlatBufferModel> model,
+             const EngineOptions &options = EngineOptions()) {
+    TFLITE_TRACE_SCOPE("load_model");
+    utils::timer::ScopedTimer timer(metrics::StageMetrics::get().model_load);
+    return this->prepare_model(std::move(model), options);
+  }
+
+private:
+  /**
+   * @brief Create the interpreter for a loaded model, apply the delegate and
+   * allocate tensors
+   * @param model Loaded model
+   * @param options Threading and delegate options
+   * @return Status
+   */
+  inference::InferenceStatus
+  prepare_model(std::shared_ptr<tflite::FlatBufferModel> model,
+                const EngineOptions &options) {
+    if (!model) {
+      LOG(ERROR) << "Model is nullptr";
+      return inference::InferenceStatus::MODEL_LOAD_ERROR;
+    }
+
+    // Interpreters of the previous model must not outlive it or their
+    // delegates
+    this->m_batch_interpreters.clear();
+    this->m_interpreter.reset();
+    this->m_delegates.clear();
+    this->m_profiler.reset();
+    this->m_model = std::move(model);
+    this->m_options = options;
+    if (options.enable_profiling) {
+      this->m_profiler = std::make_unique<OpProfiler>();
+    }
+
+    if (options.xnnpack.persistent_weights_cache &&
+        (options.delegate != DelegateType::XNNPACK ||
+         options.xnnpack.weights_cache_path.empty())) {
+      LOG(WARNING) << "Persistent weights cache needs the XNNPACK delegate "
+                      "and a cache path, weights are repacked";
+    }
+
+    // Give the cores of the previous model back before taking new ones
+    this->m_thread_budget.release();
+    this->m_thread_budget = ComputeThreadPool::get_instance().acquire(
+        options.num_threads, options.pin_threads);
+    this->m_num_threads = this->m_thread_budget.num_threads();
+
     // Create the interpreter
-    tflite::ops::builtin::BuiltinOpResolver resolver;
-    tflite::InterpreterBuilder(*this->m_model, resolver)(&this->m_interpreter);
+    this->m_interpreter = this->create_interpreter();
 
     if (!this->m_interpreter) {
       LOG(ERROR) << "Failed to create interpreter";
       return inference::InferenceStatus::INTERPRETER_ERROR;
     }
 
-    if (static_cast<int>(get_num_threads()) == 0) {
-      LOG(ERROR) << "Failed to get the number of threads";
-      return inference::InferenceStatus::INVOCATION_ERROR;
-    }
-
-    // Allocate tensor buffers and set the number of threads
-    this->m_interpreter->SetNumThreads(static_cast<int>(get_num_threads()));
-    if (this->m_interpreter->AllocateTensors() != kTfLiteOk) {
-      LOG(ERROR) << "Failed to allocate tensors";
-      return inference::InferenceStatus::TENSOR_ALLOCATION_ERROR;
+    // Set the number of threads, apply the delegate and allocate tensors
+    auto status = this->prepare_interpreter(this->m_interpreter, 0);
+    if (status != inference::InferenceStatus::SUCCESS) {
+      this->m_interpreter.reset();
+      return status;
     }
 
     // Set the input and output details
@@ -171,6 +620,314 @@ public:
     return inference::InferenceStatus::SUCCESS;
   }
 
+public:
+  /**
+   * @brief Get the number of nodes of the model executed by a delegate
+   * @return Number of delegated nodes
+   */
+  [[nodiscard]] int get_num_delegated_nodes() const {
+    return this->m_num_delegated_nodes;
+  }
+
+  /**
+   * @brief Check whether an explicitly requested delegate was applied, false
+   * if it was disabled or the engine fell back to CPU kernels
+   * @return True if a delegate is applied
+   */
+  [[nodiscard]] bool is_delegate_applied() const {
+    return !this->m_delegates.empty();
+  }
+
+  /**
+   * @brief Get the number of interpreter threads granted to the engine
+   * @return Number of threads
+   */
+  [[nodiscard]] int get_num_threads() const { return this->m_num_threads; }
+
+public:
+  /**
+   * @brief Get the operator timings of the invocations since the model was
+   * loaded or the profile was reset. Needs EngineOptions::enable_profiling;
+   * batched invocations are not profiled.
+   * @param key Sort key of the operators
+   * @return Report, empty if profiling is disabled
+   */
+  [[nodiscard]] ProfileReport
+  get_profile(ProfileReport::SortKey key = ProfileReport::SortKey::TOTAL) const {
+    return this->m_profiler ? this->m_profiler->get_report(key)
+                            : ProfileReport();
+  }
+
+  /**
+   * @brief Drop the recorded operator timings, e.g. after warm-up
+   */
+  void reset_profile() {
+    if (this->m_profiler) {
+      this->m_profiler->reset();
+    }
+  }
+
+private:
+  /**
+   * @brief Create a new interpreter for the loaded model
+   * @return Interpreter, nullptr on failure
+   */
+  std::unique_ptr<tflite::Interpreter> create_interpreter() const {
+    std::unique_ptr<tflite::Interpreter> interpreter;
+    if (this->m_options.delegate == DelegateType::DEFAULT) {
+      tflite::ops::builtin::BuiltinOpResolver resolver;
+      tflite::InterpreterBuilder(*this->m_model, resolver)(&interpreter);
+    } else {
+      tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+      tflite::InterpreterBuilder(*this->m_model, resolver)(&interpreter);
+    }
+    // Attached before delegation, delegates take the profiler on Prepare
+    if (interpreter && this->m_profiler) {
+      this->m_profiler->attach(*interpreter);
+    }
+    return interpreter;
+  }
+
+private:
+  /**
+   * @brief Set the number of threads, resize the input batch, apply the
+   * delegate and allocate tensors of a new interpreter. Falls back to a
+   * fresh interpreter without delegate if delegation fails and the options
+   * allow it.
+   * @param interpreter Interpreter, replaced on fallback
+   * @param batch_size Batch size of the input, 0 to keep the model's
+   * @return Status
+   */
+  inference::InferenceStatus
+  prepare_interpreter(std::unique_ptr<tflite::Interpreter> &interpreter,
+                      int batch_size) {
+    // Worker threads created from here on inherit the pinning
+    AffinityScope affinity(this->get_pinned_cores());
+    interpreter->SetNumThreads(this->m_num_threads);
+    if (batch_size > 0 &&
+        interpreter->ResizeInputTensor(
+            interpreter->inputs()[0],
+            {batch_size, this->m_input_height, this->m_input_width,
+             this->m_input_channels}) != kTfLiteOk) {
+      LOG(ERROR) << "Failed to resize input to batch size " << batch_size;
+      return inference::InferenceStatus::TENSOR_ALLOCATION_ERROR;
+    }
+
+    const size_t num_nodes = interpreter->execution_plan().size();
+    if (this->m_options.delegate == DelegateType::XNNPACK &&
+        !this->apply_xnnpack(*interpreter)) {
+      if (!this->m_options.fallback_to_cpu) {
+        LOG(ERROR) << "Failed to apply the XNNPACK delegate";
+        return inference::InferenceStatus::DELEGATE_ERROR;
+      }
+
+      LOG(WARNING) << "Failed to apply the XNNPACK delegate, falling back "
+                      "to CPU kernels";
+      interpreter = this->create_interpreter();
+      if (!interpreter) {
+        LOG(ERROR) << "Failed to create interpreter";
+        return inference::InferenceStatus::INTERPRETER_ERROR;
+      }
+      interpreter->SetNumThreads(this->m_num_threads);
+      if (batch_size > 0 &&
+          interpreter->ResizeInputTensor(
+              interpreter->inputs()[0],
+              {batch_size, this->m_input_height, this->m_input_width,
+               this->m_input_channels}) != kTfLiteOk) {
+        LOG(ERROR) << "Failed to resize input to batch size " << batch_size;
+        return inference::InferenceStatus::TENSOR_ALLOCATION_ERROR;
+      }
+    }
+
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+      LOG(ERROR) << "Failed to allocate tensors";
+      return inference::InferenceStatus::TENSOR_ALLOCATION_ERROR;
+    }
+
+    // Default delegates are applied lazily on allocation, count afterwards.
+    // Batch interpreters share the main interpreter's delegation
+    const int delegated_nodes = log_delegation(*interpreter, num_nodes);
+    if (batch_size == 0) {
+      this->m_num_delegated_nodes = delegated_nodes;
+    }
+    return inference::InferenceStatus::SUCCESS;
+  }
+
+private:
+  /**
+   * @brief Apply the XNNPACK delegate with the configured flags. The
+   * delegate is kept alive as long as the model is loaded.
+   * @param interpreter Interpreter
+   * @return True if the delegate was applied
+   */
+  bool apply_xnnpack(tflite::Interpreter &interpreter) {
+    TfLiteXNNPackDelegateOptions xnnpack_options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    xnnpack_options.num_threads = this->m_num_threads;
+    xnnpack_options.flags = 0;
+    if (this->m_options.xnnpack.qs8) {
+      xnnpack_options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_QS8;
+    }
+    if (this->m_options.xnnpack.qu8) {
+      xnnpack_options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_QU8;
+    }
+    if (this->m_options.xnnpack.fp16) {
+      xnnpack_options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_FORCE_FP16;
+    }
+    if (this->m_options.xnnpack.dynamic_fully_connected) {
+      xnnpack_options.flags |=
+          TFLITE_XNNPACK_DELEGATE_FLAG_DYNAMIC_FULLY_CONNECTED;
+    }
+    if (this->m_options.xnnpack.persistent_weights_cache &&
+        !this->m_options.xnnpack.weights_cache_path.empty()) {
+      // Written on the first load, memory-mapped on the following ones
+      xnnpack_options.weight_cache_file_path =
+          this->m_options.xnnpack.weights_cache_path.c_str();
+    }
+
+    tflite::Interpreter::TfLiteDelegatePtr delegate(
+        TfLiteXNNPackDelegateCreate(&xnnpack_options),
+        TfLiteXNNPackDelegateDelete);
+    if (!delegate) {
+      return false;
+    }
+
+    if (interpreter.ModifyGraphWithDelegate(delegate.get()) != kTfLiteOk) {
+      return false;
+    }
+    this->m_delegates.push_back(std::move(delegate));
+    return true;
+  }
+
+private:
+  /**
+   * @brief Log how many nodes of the model run on a delegate
+   * @param interpreter Interpreter after delegation
+   * @param num_nodes Number of nodes before delegation
+   * @return Number of delegated nodes
+   */
+  static int log_delegation(tflite::Interpreter &interpreter,
+                            size_t num_nodes) {
+    int cpu_nodes = 0;
+    int partitions = 0;
+    for (int node_index : interpreter.execution_plan()) {
+      const auto *node = interpreter.node_and_registration(node_index);
+      if (node && node->first.delegate != nullptr) {
+        ++partitions;
+      } else {
+        ++cpu_nodes;
+      }
+    }
+
+    const int delegated_nodes = static_cast<int>(num_nodes) - cpu_nodes;
+    LOG(INFO) << "Delegated " << delegated_nodes << " of " << num_nodes
+              << " nodes in " << partitions << " partitions, " << cpu_nodes
+              << " nodes run on CPU kernels";
+    return delegated_nodes;
+  }
+
+private:
+  /**
+   * @brief Get the batch size the interpreter of a batch is allocated for.
+   * Batch sizes other than the model's are rounded up to a power of two, so
+   * callers with varying batch sizes share a few cached interpreters.
+   * @param batch_size Number of images in the batch
+   * @return Allocated batch size
+   */
+  [[nodiscard]] int get_allocated_batch_size(int batch_size) const {
+    if (batch_size == this->m_input_shape.dim(0)) {
+      return batch_size;
+    }
+    int allocated = 1;
+    while (allocated < batch_size) {
+      allocated *= 2;
+    }
+    return allocated;
+  }
+
+  /**
+   * @brief Get the interpreter whose input tensor is allocated for the given
+   * batch size. The model's own batch size is served by the main interpreter,
+   * other batch sizes are created on first use and cached.
+   * @param batch_size Allocated batch size, see get_allocated_batch_size()
+   * @return Interpreter, nullptr if the model cannot be resized
+   */
+  tflite::Interpreter *get_batch_interpreter(int batch_size) {
+    if (batch_size == this->m_input_shape.dim(0)) {
+      return this->m_interpreter.get();
+    }
+
+    auto it = this->m_batch_interpreters.find(batch_size);
+    if (it != this->m_batch_interpreters.end()) {
+      return it->second.get();
+    }
+
+    auto interpreter = this->create_interpreter();
+    if (!interpreter) {
+      LOG(ERROR) << "Failed to create interpreter";
+      return nullptr;
+    }
+
+    if (this->prepare_interpreter(interpreter, batch_size) !=
+        inference::InferenceStatus::SUCCESS) {
+      LOG(ERROR) << "Failed to allocate tensors for batch size " << batch_size;
+      return nullptr;
+    }
+
+    LOG(INFO) << "Allocated tensors for batch size " << batch_size;
+    return (this->m_batch_interpreters[batch_size] = std::move(interpreter))
+        .get();
+  }
+
+private:
+  /**
+   * @brief Find the interpreter of a batch size without creating it
+   * @param batch_size Allocated batch size, see get_allocated_batch_size()
+   * @return Interpreter, nullptr if none was created for the batch size
+   */
+  [[nodiscard]] const tflite::Interpreter *
+  find_batch_interpreter(int batch_size) const {
+    if (!this->m_interpreter) {
+      return nullptr;
+    }
+    if (batch_size == this->m_input_shape.dim(0)) {
+      return this->m_interpreter.get();
+    }
+    auto it = this->m_batch_interpreters.find(batch_size);
+    return it != this->m_batch_interpreters.end() ? it->second.get()
+                                                  : nullptr;
+  }
+
+private:
+  /**
+   * @brief Get the slice of an output tensor belonging to one image of the
+   * batch
+   * @param interpreter Interpreter the batch was invoked on
+   * @param index Output index
+   * @param batch_index Index of the image in the batch
+   * @param batch_size Number of images in the batch
+   * @return Pointer to the image's output, nullptr if the output does not
+   *         exist or is not float
+   */
+  static float *get_batch_output(tflite::Interpreter *interpreter,
+                                 size_t index, int batch_index,
+                                 int batch_size) {
+    if (index >= interpreter->outputs().size()) {
+      return nullptr;
+    }
+
+    const auto output = TensorView<float>::from_tensor(
+        interpreter->output_tensor(index));
+    if (output.empty()) {
+      return nullptr;
+    }
+    if (output.dim(0) != batch_size) {
+      // Output without batch axis, shared by all images
+      return output.data();
+    }
+    return output.slice(batch_index).data();
+  }
+
 private:
   /**
    * @brief Get the input tensor
@@ -185,38 +942,59 @@ private:
     case kTfLiteFloat32:
       return this->m_interpreter->typed_input_tensor<float>(0);
     case kTfLiteInt8:
-      return this->m_interpreter->typed_input_tensor<uchar>(0);
+      return this->m_interpreter->typed_input_tensor<int8_t>(0);
     default:
       throw std::runtime_error("Unsupported input tensor type");
     }
   }
 
+private:
+  /**
+   * @brief Get the OpenCV type matching the input tensor
+   * @return OpenCV type, -1 if the tensor type is not supported
+   */
+  int get_input_cv_type() const {
+    int tensor_type =
+        this->m_interpreter->tensor(this->m_interpreter->inputs()[0])->type;
+    switch (tensor_type) {
+    case kTfLiteUInt8:
+      return CV_8UC(this->m_input_channels);
+    case kTfLiteFloat32:
+      return CV_32FC(this->m_input_channels);
+    case kTfLiteInt8:
+      return CV_8SC(this->m_input_channels);
+    default:
+      LOG_EVERY_N(ERROR, 100) << "Unsupported input tensor type";
+      return -1;
+    }
+  }
+
 private:
   /**
    * @brief Set the input details
    */
   void set_input_dims_array() {
-    this->m_input_dims =
-        this->m_interpreter->tensor(this->m_interpreter->inputs()[0])->dims;
+    this->m_input_shape = TensorShape(
+        this->m_interpreter->tensor(this->m_interpreter->inputs()[0])->dims);
   }
 
   /**
    * @brief Set the input height
    */
   void set_input_height() {
-    this->m_input_height = this->m_input_dims->data[1];
+    this->m_input_height = this->m_input_shape.dim(1);
   }
 
   /**
    * @brief Set the input width
    */
-  void set_input_width() { this->m_input_width = this->m_input_dims->data[2]; }
+  void set_input_width() { this->m_input_width = this->m_input_shape.dim(2); }
 
   /**
    * @brief Set the input channels
    */
   void set_input_channels() {
-    this->m_input_channels = this->m_input_dims->data[3];
+    this->m_input_channels = this->m_input_shape.dim(3);
   }
 
 private:
@@ -224,29 +1002,30 @@ private:
    * @brief Set the output details
    */
   void set_output_dims_array() {
-    this->m_output_dims =
-        this->m_interpreter->tensor(this->m_interpreter->outputs()[0])->dims;
+    this->m_output_shape = TensorShape(
+        this->m_interpreter->tensor(this->m_interpreter->outputs()[0])->dims);
   }
 
   /**
    * @brief Set the output height
    */
   void set_output_height() {
-    this->m_output_height = this->m_output_dims->data[1];
+    this->m_output_height = this->m_output_shape.dim(1);
   }
 
   /**
    * @brief Set the output width
    */
   void set_output_width() {
-    this->m_output_width = this->m_output_dims->data[2];
+    this->m_output_width = this->m_output_shape.dim(2);
   }
 
   /**
    * @brief Set the output channels
    */
   void set_output_channels() {
-    this->m_output_channels = this->m_output_dims->data[3];
+    // Outputs without a channel axis, e.g. SSD boxes, report 0 channels
+    this->m_output_channels = this->m_output_shape.dim(3, 0);
   }
 
 private:
@@ -302,11 +1081,13 @@ private:
 
 private:
   /**
-   * @brief Get the number of threads
-   * @return Number of threads
+   * @brief Get the cores to pin the interpreter threads to
+   * @return Cores of the thread budget, empty if not pinned
    */
-  static unsigned int get_num_threads() {
-    return std::thread::hardware_concurrency();
+  [[nodiscard]] const std::vector<int> &get_pinned_cores() const {
+    static const std::vector<int> none;
+    return this->m_thread_budget.pinned() ? this->m_thread_budget.cores()
+                                          : none;
   }
 
 private:
@@ -318,11 +1099,20 @@ private:
   int m_output_width = 0;
   int m_output_channels = 0;
 
-  TfLiteIntArray *m_input_dims{};
-  TfLiteIntArray *m_output_dims{};
+  int m_num_threads = 0;
+  int m_num_delegated_nodes = 0;
+  EngineOptions m_options;
+  ThreadBudget m_thread_budget;
 
+  TensorShape m_input_shape;
+  TensorShape m_output_shape;
+
+  std::shared_ptr<tflite::FlatBufferModel> m_model;
+  std::unique_ptr<OpProfiler> m_profiler;
+  std::vector<tflite::Interpreter::TfLiteDelegatePtr> m_delegates;
   std::unique_ptr<tflite::Interpreter> m_interpreter;
-  std::unique_ptr<tflite::FlatBufferModel> m_model;
+
+  std::map<int, std::unique_ptr<tflite::Interpreter>> m_batch_interpreters;
 };
 
 } // namespace tflite::inference
@@ -0,0 +1,155 @@
+/**
+ * @file model_registry.hpp
+ * @details Process-wide registry sharing loaded models between engines
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef MODEL_REGISTRY_HPP
+#define MODEL_REGISTRY_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <log/glogging.hpp>
+#include <tensorflow/lite/model.h>
+
+namespace tflite::inference {
+class ModelRegistry {
+public:
+  /**
+   * @brief Get the instance of the registry
+   * @return Registry instance
+   */
+  static ModelRegistry &get_instance() {
+    static ModelRegistry instance;
+    return instance;
+  }
+
+public:
+  /**
+   * @brief Get the model of the given file. The file is memory-mapped and
+   * verified once, every further call returns the same model as long as an
+   * engine still holds it.
+   * @param model_path Path to the model in the format of string
+   * @return Shared model, nullptr on failure
+   */
+  std::shared_ptr<tflite::FlatBufferModel> load(const std::string &model_path) {
+    std::error_code error;
+    const std::string key =
+        "file:" + std::filesystem::canonical(model_path, error).string();
+    if (error) {
+      LOG(ERROR) << "Model path does not exist: " << model_path;
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    if (auto model = this->find(key)) {
+      return model;
+    }
+
+    std::shared_ptr<tflite::FlatBufferModel> model =
+        tflite::FlatBufferModel::VerifyAndBuildFromFile(model_path.c_str());
+    if (!model) {
+      LOG(ERROR) << "Failed to load model: " << model_path;
+      return nullptr;
+    }
+    this->m_models[key] = model;
+    return model;
+  }
+
+public:
+  /**
+   * @brief Get the model of a caller-owned buffer, e.g. a model embedded in
+   * the binary. The buffer is not copied and must outlive every engine
+   * using the model. Loads of the same buffer share one model, separate
+   * buffers with equal content do not since each model reads its own.
+   * @param data Model flatbuffer
+   * @param size Size of the buffer in bytes
+   * @return Shared model, nullptr on failure
+   */
+  std::shared_ptr<tflite::FlatBufferModel> load_from_buffer(const void *data,
+                                                            size_t size) {
+    if (data == nullptr || size == 0) {
+      LOG(ERROR) << "Model buffer is empty";
+      return nullptr;
+    }
+
+    const std::string key =
+        "buffer:" + std::to_string(reinterpret_cast<uintptr_t>(data)) + ":" +
+        std::to_string(size);
+
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    if (auto model = this->find(key)) {
+      return model;
+    }
+
+    std::shared_ptr<tflite::FlatBufferModel> model =
+        tflite::FlatBufferModel::VerifyAndBuildFromBuffer(
+            static_cast<const char *>(data), size);
+    if (!model) {
+      LOG(ERROR) << "Failed to load model from buffer";
+      return nullptr;
+    }
+    this->m_models[key] = model;
+    return model;
+  }
+
+public:
+  /**
+   * @brief Get the number of models currently held by engines
+   * @return Number of live models
+   */
+  size_t size() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    this->remove_expired();
+    return this->m_models.size();
+  }
+
+private:
+  ModelRegistry() = default;
+  ModelRegistry(const ModelRegistry &) = delete;
+  ModelRegistry &operator=(const ModelRegistry &) = delete;
+
+private:
+  /**
+   * @brief Find a live model, the caller holds the mutex
+   * @param key Registry key
+   * @return Model, nullptr if unknown or released by all engines
+   */
+  std::shared_ptr<tflite::FlatBufferModel> find(const std::string &key) {
+    auto it = this->m_models.find(key);
+    if (it == this->m_models.end()) {
+      return nullptr;
+    }
+    auto model = it->second.lock();
+    if (!model) {
+      this->m_models.erase(it);
+    }
+    return model;
+  }
+
+private:
+  /**
+   * @brief Drop the entries of models no engine holds anymore, the caller
+   * holds the mutex
+   */
+  void remove_expired() {
+    for (auto it = this->m_models.begin(); it != this->m_models.end();) {
+      it = it->second.expired() ? this->m_models.erase(it) : std::next(it);
+    }
+  }
+
+private:
+  std::mutex m_mutex;
+  std::unordered_map<std::string, std::weak_ptr<tflite::FlatBufferModel>>
+      m_models;
+};
+} // namespace tflite::inference
+
+#endif // MODEL_REGISTRY_HPP
@@ -0,0 +1,376 @@
+/**
+ * @file op_profiler.hpp
+ * @details Per-operator profiling of the interpreter with text and JSON
+ * reports
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef OP_PROFILER_HPP
+#define OP_PROFILER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <tensorflow/lite/interpreter.h>
+#include <tensorflow/lite/profiling/buffered_profiler.h>
+#include <tensorflow/lite/schema/schema_generated.h>
+
+namespace tflite::inference {
+/**
+ * @brief Where an operator runs
+ */
+enum class OpBackend {
+  // Builtin CPU kernel
+  CPU,
+  // Delegate kernel running a whole partition of the graph
+  DELEGATE,
+  // Operator inside a delegate partition, only reported by delegates that
+  // support profiling. Its time is part of the DELEGATE entry.
+  DELEGATE_OP
+};
+
+inline const char *to_string(OpBackend backend) {
+  switch (backend) {
+  case OpBackend::CPU:
+    return "CPU";
+  case OpBackend::DELEGATE:
+    return "DELEGATE";
+  case OpBackend::DELEGATE_OP:
+    return "DELEGATE_OP";
+  }
+  return "UNKNOWN";
+}
+
+/**
+ * @brief Timing of one operator, or of all operators of one type
+ */
+struct OpStats {
+  std::string type;
+  // Node index, -1 for the statistics of an operator type
+  int node = -1;
+  OpBackend backend = OpBackend::CPU;
+  size_t count = 0;
+  // Times in microseconds, total over all executions, mean and percentiles
+  // of a single execution
+  double total_us = 0.0;
+  double mean_us = 0.0;
+  double p50_us = 0.0;
+  double p99_us = 0.0;
+};
+
+struct ProfileReport {
+  enum class SortKey { TOTAL, MEAN, P50, P99, COUNT, TYPE, NODE };
+
+  size_t invocations = 0;
+  std::vector<OpStats> ops;
+  std::vector<OpStats> op_types;
+  // Mean time per invocation on delegate and CPU kernels
+  double delegate_us = 0.0;
+  double cpu_us = 0.0;
+
+  /**
+   * @brief Sort the operators and operator types
+   * @param key Sort key, times and counts descending, type and node ascending
+   */
+  void sort(SortKey key) {
+    auto compare = [key](const OpStats &a, const OpStats &b) {
+      switch (key) {
+      case SortKey::MEAN:
+        return a.mean_us > b.mean_us;
+      case SortKey::P50:
+        return a.p50_us > b.p50_us;
+      case SortKey::P99:
+        return a.p99_us > b.p99_us;
+      case SortKey::COUNT:
+        return a.count > b.count;
+      case SortKey::TYPE:
+        return std::tie(a.type, a.node) < std::tie(b.type, b.node);
+      case SortKey::NODE:
+        return std::tie(a.backend, a.node) < std::tie(b.backend, b.node);
+      case SortKey::TOTAL:
+      default:
+        return a.total_us > b.total_us;
+      }
+    };
+    std::stable_sort(this->ops.begin(), this->ops.end(), compare);
+    std::stable_sort(this->op_types.begin(), this->op_types.end(), compare);
+  }
+
+  /**
+   * @brief Format the report as tables
+   * @return Text report
+   */
+  [[nodiscard]] std::string to_text() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    const double total = this->delegate_us + this->cpu_us;
+    out << "Invocations: " << this->invocations << " | Delegate: "
+        << this->delegate_us << " us (" << percent(this->delegate_us, total)
+        << "%) | CPU: " << this->cpu_us << " us ("
+        << percent(this->cpu_us, total) << "%)\n";
+
+    const double invocations =
+        static_cast<double>(std::max<size_t>(1, this->invocations));
+    auto table = [&out, total, invocations](const std::vector<OpStats> &entries,
+                                            const char *title) {
+      out << "\n"
+          << title << "\n"
+          << std::left << std::setw(40) << "Type" << std::right
+          << std::setw(6) << "Node" << std::setw(12) << "Backend"
+          << std::setw(8) << "Count" << std::setw(12) << "Mean us"
+          << std::setw(12) << "p50 us" << std::setw(12) << "p99 us"
+          << std::setw(8) << "%" << "\n";
+      for (const auto &op : entries) {
+        out << std::left << std::setw(40) << op.type.substr(0, 39)
+            << std::right << std::setw(6) << op.node << std::setw(12)
+            << to_string(op.backend) << std::setw(8) << op.count
+            << std::setw(12) << op.mean_us << std::setw(12) << op.p50_us
+            << std::setw(12) << op.p99_us << std::setw(8)
+            << (op.backend == OpBackend::DELEGATE_OP
+                    ? 0.0
+                    : percent(op.total_us / invocations, total))
+            << "\n";
+      }
+    };
+    table(this->op_types, "Operator types");
+    table(this->ops, "Operators");
+    return out.str();
+  }
+
+  /**
+   * @brief Format the report as JSON
+   * @return JSON report
+   */
+  [[nodiscard]] std::string to_json() const {
+    std::ostringstream out;
+    out << "{\"invocations\":" << this->invocations
+        << ",\"delegate_us\":" << this->delegate_us
+        << ",\"cpu_us\":" << this->cpu_us;
+
+    auto array = [&out](const std::vector<OpStats> &entries,
+                        const char *name) {
+      out << ",\"" << name << "\":[";
+      for (size_t i = 0; i < entries.size(); ++i) {
+        const auto &op = entries[i];
+        out << (i > 0 ? "," : "") << "{\"type\":\"" << escape(op.type)
+            << "\",\"node\":" << op.node << ",\"backend\":\""
+            << to_string(op.backend) << "\",\"count\":" << op.count
+            << ",\"total_us\":" << op.total_us << ",\"mean_us\":" << op.mean_us
+            << ",\"p50_us\":" << op.p50_us << ",\"p99_us\":" << op.p99_us
+            << "}";
+      }
+      out << "]";
+    };
+    array(this->op_types, "op_types");
+    array(this->ops, "ops");
+    out << "}";
+    return out.str();
+  }
+
+private:
+  static double percent(double value, double total) {
+    return total > 0.0 ? 100.0 * value / total : 0.0;
+  }
+
+  static std::string escape(const std::string &text) {
+    std::string escaped;
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+      }
+      escaped += c;
+    }
+    return escaped;
+  }
+};
+
+/**
+ * @brief Collects the operator timings of every invocation of an interpreter
+ */
+class OpProfiler {
+public:
+  OpProfiler() : m_profiler(1024, true) {}
+  ~OpProfiler() = default;
+
+  OpProfiler(const OpProfiler &) = delete;
+  OpProfiler &operator=(const OpProfiler &) = delete;
+  OpProfiler(OpProfiler &&) = delete;
+  OpProfiler &operator=(OpProfiler &&) = delete;
+
+public:
+  /**
+   * @brief Attach to an interpreter, before its delegates are applied so
+   * they can report their operators
+   * @param interpreter Interpreter, must not outlive the profiler
+   */
+  void attach(tflite::Interpreter &interpreter) {
+    interpreter.SetProfiler(&this->m_profiler);
+  }
+
+public:
+  /**
+   * @brief Start recording an invocation
+   */
+  void begin() {
+    this->m_profiler.Reset();
+    this->m_profiler.StartProfiling();
+  }
+
+  /**
+   * @brief Stop recording and add the operator timings of the invocation
+   * @param interpreter Invoked interpreter
+   */
+  void end(const tflite::Interpreter &interpreter) {
+    this->m_profiler.StopProfiling();
+    ++this->m_invocations;
+
+    for (const auto *event : this->m_profiler.GetProfileEvents()) {
+      if (event == nullptr) {
+        continue;
+      }
+
+      Key key;
+      key.node = static_cast<int>(event->event_metadata);
+      if (event->event_type ==
+          tflite::Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+        const auto *node = interpreter.node_and_registration(key.node);
+        if (node == nullptr) {
+          continue;
+        }
+        key.backend = node->first.delegate != nullptr ? OpBackend::DELEGATE
+                                                      : OpBackend::CPU;
+        key.type = get_op_type(node->second);
+      } else if (event->event_type ==
+                 tflite::Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
+        key.backend = OpBackend::DELEGATE_OP;
+        key.type = event->tag != nullptr ? event->tag : "UNKNOWN";
+      } else {
+        continue;
+      }
+      this->m_samples[key].push_back(static_cast<double>(event->elapsed_time));
+    }
+  }
+
+public:
+  /**
+   * @brief Drop the recorded timings
+   */
+  void reset() {
+    this->m_samples.clear();
+    this->m_invocations = 0;
+  }
+
+public:
+  /**
+   * @brief Aggregate the recorded timings per operator and per type
+   * @param key Sort key of the report
+   * @return Report
+   */
+  [[nodiscard]] ProfileReport
+  get_report(ProfileReport::SortKey key = ProfileReport::SortKey::TOTAL) const {
+    ProfileReport report;
+    report.invocations = this->m_invocations;
+    if (this->m_invocations == 0) {
+      return report;
+    }
+
+    std::map<std::pair<std::string, OpBackend>, std::vector<double>> types;
+    for (const auto &[op, samples] : this->m_samples) {
+      report.ops.push_back(summarize(op.type, op.node, op.backend, samples));
+      auto &type_samples = types[{op.type, op.backend}];
+      type_samples.insert(type_samples.end(), samples.begin(), samples.end());
+
+      const double per_invocation =
+          report.ops.back().total_us / static_cast<double>(this->m_invocations);
+      if (op.backend == OpBackend::DELEGATE) {
+        report.delegate_us += per_invocation;
+      } else if (op.backend == OpBackend::CPU) {
+        report.cpu_us += per_invocation;
+      }
+    }
+    for (const auto &[type, samples] : types) {
+      report.op_types.push_back(
+          summarize(type.first, -1, type.second, samples));
+    }
+    report.sort(key);
+    return report;
+  }
+
+public:
+  /**
+   * @brief Compute count, total, mean and nearest-rank percentiles
+   * @param type Operator type
+   * @param node Node index, -1 for an operator type
+   * @param backend Backend
+   * @param samples Times in microseconds
+   * @return Statistics
+   */
+  static OpStats summarize(const std::string &type, int node,
+                           OpBackend backend, std::vector<double> samples) {
+    OpStats stats;
+    stats.type = type;
+    stats.node = node;
+    stats.backend = backend;
+    stats.count = samples.size();
+    if (samples.empty()) {
+      return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    for (double sample : samples) {
+      stats.total_us += sample;
+    }
+    stats.mean_us = stats.total_us / static_cast<double>(samples.size());
+    auto percentile = [&samples](double p) {
+      const size_t rank = static_cast<size_t>(
+          std::ceil(p * static_cast<double>(samples.size())));
+      return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+    stats.p50_us = percentile(0.50);
+    stats.p99_us = percentile(0.99);
+    return stats;
+  }
+
+private:
+  struct Key {
+    std::string type;
+    int node = -1;
+    OpBackend backend = OpBackend::CPU;
+
+    bool operator<(const Key &other) const {
+      return std::tie(this->backend, this->node, this->type) <
+             std::tie(other.backend, other.node, other.type);
+    }
+  };
+
+private:
+  /**
+   * @brief Get the name of the operator of a node
+   * @param registration Node registration
+   * @return Builtin operator name, or the custom or delegate name
+   */
+  static std::string get_op_type(const TfLiteRegistration &registration) {
+    if (registration.custom_name != nullptr) {
+      return registration.custom_name;
+    }
+    const char *name = tflite::EnumNameBuiltinOperator(
+        static_cast<tflite::BuiltinOperator>(registration.builtin_code));
+    return name != nullptr && name[0] != '\0' ? name : "UNKNOWN";
+  }
+
+private:
+  tflite::profiling::BufferedProfiler m_profiler;
+  std::map<Key, std::vector<double>> m_samples;
+  size_t m_invocations = 0;
+};
+} // namespace tflite::inference
+
+#endif // OP_PROFILER_HPP
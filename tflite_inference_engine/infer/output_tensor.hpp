@@ -0,0 +1,193 @@
+/**
+ * @file output_tensor.hpp
+ * @details Read-only view of an output tensor which dequantizes elements on
+ * access
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef OUTPUT_TENSOR_HPP
+#define OUTPUT_TENSOR_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <infer/tensor_view.hpp>
+#include <tensorflow/lite/c/common.h>
+
+namespace tflite::inference {
+class OutputTensor {
+public:
+  OutputTensor() = default;
+
+  /**
+   * @brief Create the view of a tensor
+   * @param tensor Output tensor of the interpreter
+   */
+  explicit OutputTensor(const TfLiteTensor *tensor)
+      : m_data(tensor->data.raw_const), m_shape(tensor->dims),
+        m_type(tensor->type), m_scale(tensor->params.scale),
+        m_zero_point(tensor->params.zero_point) {
+    switch (this->m_type) {
+    case kTfLiteFloat32:
+      this->m_size = tensor->bytes / sizeof(float);
+      break;
+    case kTfLiteUInt8:
+    case kTfLiteInt8:
+      this->m_size = tensor->bytes;
+      if (this->m_scale <= 0.0f) {
+        // Integer tensor without quantization parameters holds real values
+        this->m_scale = 1.0f;
+        this->m_zero_point = 0;
+      }
+      break;
+    default:
+      this->m_data = nullptr;
+      break;
+    }
+  }
+
+public:
+  /**
+   * @brief Get the element at the given index as float. Quantized elements
+   * are dequantized on access, so only the elements read are converted.
+   * @param index Element index
+   * @return Real value of the element
+   */
+  float operator[](size_t index) const {
+    switch (this->m_type) {
+    case kTfLiteUInt8:
+      return this->m_scale *
+             static_cast<float>(
+                 static_cast<const uint8_t *>(this->m_data)[index] -
+                 this->m_zero_point);
+    case kTfLiteInt8:
+      return this->m_scale *
+             static_cast<float>(
+                 static_cast<const int8_t *>(this->m_data)[index] -
+                 this->m_zero_point);
+    default:
+      return static_cast<const float *>(this->m_data)[index];
+    }
+  }
+
+public:
+  /**
+   * @brief Check if the element at the given index is greater than a
+   * threshold previously converted with quantize(), without dequantizing
+   * @param index Element index
+   * @param threshold Threshold in the quantized domain of the tensor
+   * @return True if the element is greater than the threshold
+   */
+  [[nodiscard]] bool greater(size_t index, float threshold) const {
+    switch (this->m_type) {
+    case kTfLiteUInt8:
+      return static_cast<const uint8_t *>(this->m_data)[index] > threshold;
+    case kTfLiteInt8:
+      return static_cast<const int8_t *>(this->m_data)[index] > threshold;
+    default:
+      return static_cast<const float *>(this->m_data)[index] > threshold;
+    }
+  }
+
+public:
+  /**
+   * @brief Convert a real value into the quantized domain of the tensor, to
+   * compare raw elements against it with greater()
+   * @param value Real value
+   * @return Value in the tensor domain, unchanged for float tensors
+   */
+  [[nodiscard]] float quantize(float value) const {
+    if (!this->is_quantized()) {
+      return value;
+    }
+    return value / this->m_scale + static_cast<float>(this->m_zero_point);
+  }
+
+public:
+  /**
+   * @brief Get the rows [first, first + count) of the first axis, e.g. the
+   * output of one image of a batch
+   * @param first First row
+   * @param count Number of rows
+   * @return View of the rows
+   */
+  [[nodiscard]] OutputTensor slice(int first, int count = 1) const {
+    if (this->empty() || this->m_shape.rank() == 0) {
+      return *this;
+    }
+    const size_t row = this->m_shape.stride(0);
+    const size_t element_size =
+        this->m_type == kTfLiteFloat32 ? sizeof(float) : 1;
+    OutputTensor rows = *this;
+    rows.m_data = static_cast<const char *>(this->m_data) +
+                  static_cast<size_t>(first) * row * element_size;
+    rows.m_size = static_cast<size_t>(count) * row;
+    rows.m_shape.set_dim(0, count);
+    return rows;
+  }
+
+public:
+  /**
+   * @brief Check if the view points to a tensor
+   * @return True if the view is empty
+   */
+  [[nodiscard]] bool empty() const { return this->m_data == nullptr; }
+
+  /**
+   * @brief Get the number of elements
+   * @return Number of elements
+   */
+  [[nodiscard]] size_t size() const { return this->m_size; }
+
+  /**
+   * @brief Get the shape
+   * @return Shape of the tensor
+   */
+  [[nodiscard]] const TensorShape &shape() const { return this->m_shape; }
+
+  /**
+   * @brief Get the tensor type
+   * @return Tensor type
+   */
+  [[nodiscard]] TfLiteType type() const { return this->m_type; }
+
+  /**
+   * @brief Check if the tensor holds quantized integers
+   * @return True for uint8 and int8 tensors
+   */
+  [[nodiscard]] bool is_quantized() const {
+    return this->m_type == kTfLiteUInt8 || this->m_type == kTfLiteInt8;
+  }
+
+  /**
+   * @brief Get the quantization scale
+   * @return Scale, meaningless for float tensors
+   */
+  [[nodiscard]] float scale() const { return this->m_scale; }
+
+  /**
+   * @brief Get the quantization zero point
+   * @return Zero point
+   */
+  [[nodiscard]] int zero_point() const { return this->m_zero_point; }
+
+  /**
+   * @brief Get the raw data
+   * @return Pointer to the tensor data
+   */
+  [[nodiscard]] const void *data() const { return this->m_data; }
+
+private:
+  const void *m_data = nullptr;
+  size_t m_size = 0;
+  TensorShape m_shape;
+  TfLiteType m_type = kTfLiteNoType;
+  float m_scale = 0.0f;
+  int m_zero_point = 0;
+};
+} // namespace tflite::inference
+
+#endif // OUTPUT_TENSOR_HPP
@@ -0,0 +1,305 @@
+/**
+ * @file tensor_view.hpp
+ * @details Typed, shape-aware view of a tensor with strides, type and
+ * quantization parameters
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef TENSOR_VIEW_HPP
+#define TENSOR_VIEW_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+#include <tensorflow/lite/c/common.h>
+
+namespace tflite::inference {
+/**
+ * @brief Tensor type of an element type
+ */
+template <typename T> struct TensorType {
+  static constexpr TfLiteType value = kTfLiteNoType;
+};
+template <> struct TensorType<float> {
+  static constexpr TfLiteType value = kTfLiteFloat32;
+};
+template <> struct TensorType<uint8_t> {
+  static constexpr TfLiteType value = kTfLiteUInt8;
+};
+template <> struct TensorType<int8_t> {
+  static constexpr TfLiteType value = kTfLiteInt8;
+};
+template <> struct TensorType<int16_t> {
+  static constexpr TfLiteType value = kTfLiteInt16;
+};
+template <> struct TensorType<int32_t> {
+  static constexpr TfLiteType value = kTfLiteInt32;
+};
+template <> struct TensorType<int64_t> {
+  static constexpr TfLiteType value = kTfLiteInt64;
+};
+template <> struct TensorType<bool> {
+  static constexpr TfLiteType value = kTfLiteBool;
+};
+
+template <typename T>
+inline constexpr TfLiteType tensor_type_v =
+    TensorType<std::remove_const_t<T>>::value;
+
+/**
+ * @brief Dimensions of a tensor, stored inline
+ */
+class TensorShape {
+public:
+  static constexpr int MAX_RANK = 6;
+
+public:
+  TensorShape() = default;
+
+  /**
+   * @brief Create the shape of a tensor
+   * @param dims Tensor dimensions, nullptr for a scalar
+   */
+  explicit TensorShape(const TfLiteIntArray *dims) {
+    if (dims == nullptr) {
+      return;
+    }
+    this->m_rank = dims->size < MAX_RANK ? dims->size : MAX_RANK;
+    for (int i = 0; i < this->m_rank; ++i) {
+      this->m_dims[i] = dims->data[i];
+    }
+  }
+
+  /**
+   * @brief Create a shape from its dimensions
+   * @param dims Dimensions, at most MAX_RANK
+   */
+  TensorShape(std::initializer_list<int> dims) {
+    for (int dim : dims) {
+      if (this->m_rank == MAX_RANK) {
+        break;
+      }
+      this->m_dims[this->m_rank++] = dim;
+    }
+  }
+
+public:
+  /**
+   * @brief Get the number of dimensions
+   * @return Rank
+   */
+  [[nodiscard]] int rank() const { return this->m_rank; }
+
+  /**
+   * @brief Get a dimension
+   * @param axis Axis, negative counts from the last one
+   * @param fallback Value if the tensor has no such axis
+   * @return Dimension
+   */
+  [[nodiscard]] int dim(int axis, int fallback = 1) const {
+    if (axis < 0) {
+      axis += this->m_rank;
+    }
+    return axis >= 0 && axis < this->m_rank ? this->m_dims[axis] : fallback;
+  }
+
+  int operator[](int axis) const { return this->m_dims[axis]; }
+
+  /**
+   * @brief Set a dimension
+   * @param axis Axis below rank()
+   * @param value Dimension
+   */
+  void set_dim(int axis, int value) { this->m_dims[axis] = value; }
+
+  /**
+   * @brief Get the number of elements
+   * @return Product of the dimensions, 1 for a scalar
+   */
+  [[nodiscard]] size_t num_elements() const {
+    size_t elements = 1;
+    for (int i = 0; i < this->m_rank; ++i) {
+      elements *= static_cast<size_t>(this->m_dims[i]);
+    }
+    return elements;
+  }
+
+  /**
+   * @brief Get the row-major stride of an axis
+   * @param axis Axis
+   * @return Number of elements between two indices of the axis
+   */
+  [[nodiscard]] size_t stride(int axis) const {
+    size_t stride = 1;
+    for (int i = this->m_rank - 1; i > axis; --i) {
+      stride *= static_cast<size_t>(this->m_dims[i]);
+    }
+    return stride;
+  }
+
+  bool operator==(const TensorShape &other) const {
+    if (this->m_rank != other.m_rank) {
+      return false;
+    }
+    for (int i = 0; i < this->m_rank; ++i) {
+      if (this->m_dims[i] != other.m_dims[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool operator!=(const TensorShape &other) const { return !(*this == other); }
+
+private:
+  std::array<int, MAX_RANK> m_dims{};
+  int m_rank = 0;
+};
+
+/**
+ * @brief Affine quantization of a tensor, real = scale * (q - zero_point)
+ */
+struct QuantizationParams {
+  float scale = 0.0f;
+  int zero_point = 0;
+
+  /**
+   * @brief Check if the parameters are set
+   * @return True for a positive scale
+   */
+  [[nodiscard]] bool is_quantized() const { return this->scale > 0.0f; }
+};
+
+/**
+ * @brief Non-owning view of the elements of a tensor. T is the element type,
+ * const for read-only views. Same size as a pointer plus the shape, no
+ * allocation.
+ */
+template <typename T> class TensorView {
+public:
+  using value_type = std::remove_const_t<T>;
+
+public:
+  TensorView() = default;
+
+  /**
+   * @brief Create a view of raw data
+   * @param data Elements in row-major order
+   * @param shape Shape
+   * @param quantization Quantization parameters of integer tensors
+   */
+  TensorView(T *data, const TensorShape &shape,
+             const QuantizationParams &quantization = QuantizationParams())
+      : m_data(data), m_shape(shape), m_quantization(quantization) {
+    for (int axis = 0; axis < shape.rank(); ++axis) {
+      this->m_strides[axis] = shape.stride(axis);
+    }
+  }
+
+  /**
+   * @brief Create the view of a tensor
+   * @param tensor Tensor of the interpreter
+   * @return View, empty if the tensor is nullptr or of another type than T
+   */
+  static TensorView from_tensor(const TfLiteTensor *tensor) {
+    if (tensor == nullptr || tensor->type != tensor_type_v<T> ||
+        tensor->data.raw == nullptr) {
+      return TensorView();
+    }
+    return TensorView(
+        reinterpret_cast<T *>(tensor->data.raw), TensorShape(tensor->dims),
+        QuantizationParams{tensor->params.scale, tensor->params.zero_point});
+  }
+
+public:
+  /**
+   * @brief Get an element by flat index
+   * @param index Row-major index
+   * @return Element
+   */
+  T &operator[](size_t index) const { return this->m_data[index]; }
+
+  /**
+   * @brief Get an element by its index along each axis
+   * @param indices One index per axis
+   * @return Element
+   */
+  template <typename... Indices> T &at(Indices... indices) const {
+    static_assert(sizeof...(Indices) <= TensorShape::MAX_RANK,
+                  "Too many indices");
+    const size_t index[] = {static_cast<size_t>(indices)...};
+    size_t offset = 0;
+    for (size_t axis = 0; axis < sizeof...(Indices); ++axis) {
+      offset += index[axis] * this->m_strides[axis];
+    }
+    return this->m_data[offset];
+  }
+
+  /**
+   * @brief Get an element as its real value, dequantized for quantized
+   * tensors
+   * @param index Row-major index
+   * @return Real value
+   */
+  [[nodiscard]] float real(size_t index) const {
+    if constexpr (std::is_integral_v<value_type>) {
+      if (this->m_quantization.is_quantized()) {
+        return this->m_quantization.scale *
+               static_cast<float>(static_cast<int>(this->m_data[index]) -
+                                  this->m_quantization.zero_point);
+      }
+    }
+    return static_cast<float>(this->m_data[index]);
+  }
+
+public:
+  /**
+   * @brief Get the rows [first, first + count) of the first axis, e.g. one
+   * image of a batch
+   * @param first First row
+   * @param count Number of rows
+   * @return View of the rows
+   */
+  [[nodiscard]] TensorView slice(int first, int count = 1) const {
+    if (this->m_shape.rank() == 0) {
+      return *this;
+    }
+    TensorShape shape = this->m_shape;
+    shape.set_dim(0, count);
+    return TensorView(this->m_data +
+                          static_cast<size_t>(first) * this->m_strides[0],
+                      shape, this->m_quantization);
+  }
+
+public:
+  [[nodiscard]] bool empty() const { return this->m_data == nullptr; }
+  [[nodiscard]] T *data() const { return this->m_data; }
+  [[nodiscard]] T *begin() const { return this->m_data; }
+  [[nodiscard]] T *end() const { return this->m_data + this->size(); }
+  [[nodiscard]] size_t size() const {
+    return this->m_data == nullptr ? 0 : this->m_shape.num_elements();
+  }
+  [[nodiscard]] const TensorShape &shape() const { return this->m_shape; }
+  [[nodiscard]] int rank() const { return this->m_shape.rank(); }
+  [[nodiscard]] int dim(int axis) const { return this->m_shape.dim(axis); }
+  [[nodiscard]] size_t stride(int axis) const {
+    return this->m_strides[axis];
+  }
+  [[nodiscard]] static constexpr TfLiteType type() { return tensor_type_v<T>; }
+  [[nodiscard]] const QuantizationParams &quantization() const {
+    return this->m_quantization;
+  }
+
+private:
+  T *m_data = nullptr;
+  TensorShape m_shape;
+  std::array<size_t, TensorShape::MAX_RANK> m_strides{};
+  QuantizationParams m_quantization;
+};
+} // namespace tflite::inference
+
+#endif // TENSOR_VIEW_HPP
@@ -0,0 +1,95 @@
+/**
+ * @file weights_cache.hpp
+ * @details Location of the persistent XNNPACK packed weights cache
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef WEIGHTS_CACHE_HPP
+#define WEIGHTS_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include <infer/engine_options.hpp>
+#include <opencv2/core/utility.hpp>
+#include <tensorflow/lite/model.h>
+
+namespace tflite::inference {
+class WeightsCache {
+public:
+  /**
+   * @brief Get the path of the packed weights cache of a model. The cache
+   * lives next to the model and its name contains a hash of the model
+   * content and of the CPU features, so a changed model or a different
+   * machine never reads a stale cache.
+   * @param model_path Path of the .tflite file
+   * @param model Loaded model
+   * @return Cache file path, empty if the model has no backing buffer
+   */
+  static std::string get_path(const std::string &model_path,
+                              const tflite::FlatBufferModel &model) {
+    const auto *allocation = model.allocation();
+    if (allocation == nullptr || allocation->base() == nullptr) {
+      return "";
+    }
+
+    const uint64_t model_hash =
+        hash(static_cast<const uint8_t *>(allocation->base()),
+             allocation->bytes());
+    const std::string features = cv::getCPUFeaturesLine();
+    const uint64_t cpu_hash =
+        hash(reinterpret_cast<const uint8_t *>(features.data()),
+             features.size());
+
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16) << model_hash << "-"
+       << std::setw(8) << static_cast<uint32_t>(cpu_hash);
+
+    std::filesystem::path path(model_path);
+    path.replace_extension("." + ss.str() + ".xnnpack_cache");
+    return path.string();
+  }
+
+public:
+  /**
+   * @brief Derive the cache path of options asking for a persistent cache
+   * without giving one
+   * @param options XNNPACK options
+   * @param model_path Path of the .tflite file
+   * @param model Loaded model
+   * @return Options with the cache path filled in
+   */
+  static XNNPackOptions resolve(XNNPackOptions options,
+                                const std::string &model_path,
+                                const tflite::FlatBufferModel &model) {
+    if (options.persistent_weights_cache &&
+        options.weights_cache_path.empty()) {
+      options.weights_cache_path = get_path(model_path, model);
+    }
+    return options;
+  }
+
+public:
+  /**
+   * @brief 64-bit FNV-1a hash
+   * @param data Data
+   * @param size Number of bytes
+   * @return Hash
+   */
+  static uint64_t hash(const uint8_t *data, size_t size) {
+    uint64_t value = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+      value ^= data[i];
+      value *= 1099511628211ULL;
+    }
+    return value;
+  }
+};
+} // namespace tflite::inference
+
+#endif // WEIGHTS_CACHE_HPP
@@ -1,6 +1,7 @@
 /**
  * @file log.hpp
- * @details Logging utility for the application
+ * @details Logging utility for the application, written synchronously or by
+ * a background thread from per-thread lock-free buffers
  * @author Arghadeep Mazumder
  * @version 0.1.0
  * @copyright -
@@ -8,19 +9,40 @@
 #ifndef LOGGING_HPP_
 #define LOGGING_HPP_
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <iomanip>
+#include <cstring>
+#include <ctime>
 #include <iostream>
+#include <memory>
 #include <mutex>
-#include <sstream>
+#include <streambuf>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <log/rate_limiter.hpp>
+#include <pipeline/spsc_queue.hpp>
 #include <utils/colors.hpp>
 
+// Levels below are compiled out of the LOG_* macros: 0 DEBUG, 1 INFO,
+// 2 WARNING, 3 ERROR, 4 FATAL
+#ifndef TFLITE_LOG_LEVEL
+#define TFLITE_LOG_LEVEL 0
+#endif
+
 namespace tflite::logging {
 class Logger {
 public:
   enum class Level { DEBUG, INFO, WARNING, ERROR, FATAL };
 
+  // Longer messages are truncated
+  static constexpr size_t MAX_MESSAGE_LENGTH = 256;
+  // Messages per second of each call site while writing asynchronously,
+  // unless set with set_rate_limit()
+  static constexpr int DEFAULT_ASYNC_RATE_LIMIT = 100;
+
 public:
   /**
    * @brief Get the instance of the logger
@@ -31,6 +53,8 @@ public:
     return instance;
   }
 
+  ~Logger() { this->stop_async(); }
+
 public:
   /**
    * @brief Log the message
@@ -42,21 +66,152 @@ public:
    */
   template <typename... Args>
   void log(Level level, const char *file, int line, Args... args) {
+    if (level < this->m_level.load(std::memory_order_relaxed)) {
+      return;
+    }
+    Record record;
+    record.time = std::chrono::system_clock::now();
+    this->submit(record, level, file, line, args...);
+  }
+
+  /**
+   * @brief Log the message unless its call site exceeded the rate limit.
+   * Used by the LOG_* macros, one limiter per call site.
+   * @tparam Args Variadic template
+   * @param limiter Rate limiter of the call site
+   * @param level Log level
+   * @param file File name
+   * @param line Line number
+   * @param args Message
+   */
+  template <typename... Args>
+  void log(RateLimiter &limiter, Level level, const char *file, int line,
+           Args... args) {
+    if (level < this->m_level.load(std::memory_order_relaxed)) {
+      return;
+    }
+    Record record;
+    record.suppressed = limiter.acquire(
+        this->get_rate_limit(),
+        std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+    if (record.suppressed == RateLimiter::SUPPRESSED) {
+      return;
+    }
+    record.time = std::chrono::system_clock::now();
+    this->submit(record, level, file, line, args...);
+  }
+
+  void setOutput(std::ostream &os) {
     std::lock_guard<std::mutex> lock(m_mutex);
+    m_output.rdbuf(os.rdbuf());
+  }
 
-    std::stringstream ss;
-    ss << get_color(level) << get_level_string(level) << " "
-       << get_current_timestamp() << " " << file << ":" << line << " - ";
+public:
+  /**
+   * @brief Set the lowest level written at runtime, see TFLITE_LOG_LEVEL to
+   * compile lower levels out
+   * @param level Log level
+   */
+  void set_level(Level level) {
+    this->m_level.store(level, std::memory_order_relaxed);
+  }
 
-    (ss << ... << args) << RESET << std::endl;
+  /**
+   * @brief Limit the messages of each LOG_* call site, the number of
+   * suppressed messages is reported with the next one written. Until set,
+   * synchronous logging is unlimited and asynchronous logging is limited to
+   * DEFAULT_ASYNC_RATE_LIMIT.
+   * @param messages_per_second Messages per second, 0 for no limit, negative
+   * for the default
+   */
+  void set_rate_limit(int messages_per_second) {
+    this->m_rate_limit.store(messages_per_second, std::memory_order_relaxed);
+  }
 
-    m_output << ss.str();
-    m_output.flush();
+  /**
+   * @brief Get the limit applied to each LOG_* call site
+   * @return Messages per second, 0 for no limit
+   */
+  [[nodiscard]] int get_rate_limit() const {
+    const int limit = this->m_rate_limit.load(std::memory_order_relaxed);
+    if (limit >= 0) {
+      return limit;
+    }
+    return this->m_async.load(std::memory_order_relaxed)
+               ? DEFAULT_ASYNC_RATE_LIMIT
+               : 0;
   }
 
-  void setOutput(std::ostream &os) {
+public:
+  /**
+   * @brief Write from a background thread. Logging threads only format into
+   * their own lock-free buffer; when it is full the message is dropped and
+   * counted instead of blocking.
+   * @param records_per_thread Capacity of the buffer of each thread,
+   * applies to threads logging for the first time after this call
+   */
+  void start_async(size_t records_per_thread = 1024) {
+    std::lock_guard<std::mutex> lock(this->m_buffers_mutex);
+    if (this->m_writer.joinable()) {
+      return;
+    }
+    this->m_capacity = std::max<size_t>(1, records_per_thread);
+    this->m_stop = false;
+    this->m_writer = std::thread(&Logger::run_writer, this);
+    this->m_async.store(true, std::memory_order_release);
+  }
+
+  /**
+   * @brief Write the buffered messages and go back to writing synchronously
+   */
+  void stop_async() {
+    std::thread writer;
+    {
+      std::lock_guard<std::mutex> lock(this->m_buffers_mutex);
+      this->m_async.store(false, std::memory_order_release);
+      this->m_stop = true;
+      writer = std::move(this->m_writer);
+    }
+    if (writer.joinable()) {
+      writer.join();
+    }
+  }
+
+  /**
+   * @brief Wait until the messages logged so far are written and flushed
+   */
+  void flush() {
+    if (this->m_async.load(std::memory_order_acquire)) {
+      const uint64_t target = this->pushed();
+      for (int attempt = 0;
+           this->m_written.load(std::memory_order_acquire) < target &&
+           this->m_async.load(std::memory_order_acquire);
+           ++attempt) {
+        pipeline::backoff(attempt);
+      }
+    }
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_output.rdbuf(os.rdbuf());
+    m_output.flush();
+  }
+
+  /**
+   * @brief Get the number of messages dropped on full buffers
+   * @return Number of dropped messages
+   */
+  [[nodiscard]] uint64_t get_num_dropped() const {
+    return this->m_total_dropped.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the number of per-thread buffers, the buffers of exited
+   * threads are dropped by the writer once drained
+   * @return Number of buffers
+   */
+  size_t num_buffers() {
+    std::lock_guard<std::mutex> lock(this->m_buffers_mutex);
+    return this->m_buffers.size();
   }
 
 private:
@@ -64,13 +219,273 @@ private:
   Logger(const Logger &) = delete;
   Logger &operator=(const Logger &) = delete;
 
+private:
+  struct Record {
+    Level level = Level::INFO;
+    const char *file = nullptr;
+    int line = 0;
+    // Messages of the call site suppressed before this one
+    int64_t suppressed = 0;
+    std::chrono::system_clock::time_point time;
+    size_t length = 0;
+    char text[MAX_MESSAGE_LENGTH];
+  };
+
+  struct ThreadBuffer {
+    explicit ThreadBuffer(size_t capacity) : queue(capacity) {}
+
+    pipeline::SPSCQueue<Record> queue;
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> dropped{0};
+    // The thread exited, the writer drops the buffer once drained
+    std::atomic<bool> retired{false};
+  };
+
+  /**
+   * @brief Per-thread owner of the buffer, retires it when the thread exits
+   */
+  struct BufferOwner {
+    BufferOwner() = default;
+    ~BufferOwner() {
+      if (this->buffer != nullptr) {
+        this->buffer->retired.store(true, std::memory_order_release);
+      }
+    }
+
+    BufferOwner(const BufferOwner &) = delete;
+    BufferOwner &operator=(const BufferOwner &) = delete;
+
+    ThreadBuffer *buffer = nullptr;
+  };
+
+  /**
+   * @brief Stream buffer writing into a fixed array, so formatting a message
+   * does not allocate
+   */
+  class FixedBuffer : public std::streambuf {
+  public:
+    void reset(char *data, size_t size) { this->setp(data, data + size); }
+    [[nodiscard]] size_t length() const {
+      return static_cast<size_t>(this->pptr() - this->pbase());
+    }
+  };
+
+  /**
+   * @brief Formats a timestamp at most once per second
+   */
+  class TimestampCache {
+  public:
+    const char *format(std::chrono::system_clock::time_point time) {
+      const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+      if (seconds != this->m_seconds) {
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        std::strftime(this->m_text, sizeof(this->m_text), "%Y-%m-%d %X",
+                      &local);
+        this->m_seconds = seconds;
+      }
+      return this->m_text;
+    }
+
+  private:
+    std::time_t m_seconds = -1;
+    char m_text[32] = {};
+  };
+
+private:
+  /**
+   * @brief Format the message into the record and write or enqueue it
+   */
+  template <typename... Args>
+  void submit(Record &record, Level level, const char *file, int line,
+              Args &...args) {
+    record.level = level;
+    record.file = file;
+    record.line = line;
+    format_message(record, args...);
+
+    if (this->m_async.load(std::memory_order_acquire)) {
+      ThreadBuffer &buffer = this->local_buffer();
+      if (buffer.queue.try_push(record)) {
+        buffer.pushed.store(buffer.pushed.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_release);
+      } else {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (level == Level::FATAL) {
+        this->flush();
+      }
+      return;
+    }
+
+    std::string text;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    format_line(record, this->m_timestamps, text);
+    m_output << text;
+    m_output.flush();
+  }
+
+  template <typename... Args>
+  static void format_message(Record &record, Args &...args) {
+    thread_local FixedBuffer buffer;
+    thread_local std::ostream stream(&buffer);
+    buffer.reset(record.text, MAX_MESSAGE_LENGTH);
+    stream.clear();
+    (stream << ... << args);
+    record.length = buffer.length();
+    if (!stream && record.length == MAX_MESSAGE_LENGTH) {
+      std::memcpy(record.text + MAX_MESSAGE_LENGTH - 3, "...", 3);
+    }
+  }
+
+  static void format_line(const Record &record, TimestampCache &timestamps,
+                          std::string &text) {
+    text += get_color(record.level);
+    text += get_level_string(record.level);
+    text += " ";
+    text += timestamps.format(record.time);
+    text += " ";
+    text += record.file;
+    text += ":";
+    text += std::to_string(record.line);
+    text += " - ";
+    text.append(record.text, record.length);
+    if (record.suppressed > 0) {
+      text += " (" + std::to_string(record.suppressed) +
+              " similar messages suppressed)";
+    }
+    text += RESET;
+    text += "\n";
+  }
+
+private:
+  /**
+   * @brief Get the buffer of the calling thread, created on first use.
+   * When the thread exits the writer drains the buffer before dropping it,
+   * so no message is lost.
+   */
+  ThreadBuffer &local_buffer() {
+    thread_local BufferOwner owner;
+    if (owner.buffer == nullptr) {
+      std::lock_guard<std::mutex> lock(this->m_buffers_mutex);
+      this->m_buffers.push_back(
+          std::make_unique<ThreadBuffer>(this->m_capacity));
+      owner.buffer = this->m_buffers.back().get();
+    }
+    return *owner.buffer;
+  }
+
+  uint64_t pushed() {
+    std::lock_guard<std::mutex> lock(this->m_buffers_mutex);
+    uint64_t total = this->m_retired_pushed;
+    for (const auto &buffer : this->m_buffers) {
+      total += buffer->pushed.load(std::memory_order_acquire);
+    }
+    return total;
+  }
+
+  /**
+   * @brief Drop the drained buffers of exited threads, keeping their count
+   * of pushed messages for flush()
+   * @param retired Buffers retired before they were drained
+   */
+  void remove_retired(const std::vector<ThreadBuffer *> &retired) {
+    std::lock_guard<std::mutex> lock(this->m_buffers_mutex);
+    for (ThreadBuffer *buffer : retired) {
+      auto it = std::find_if(
+          this->m_buffers.begin(), this->m_buffers.end(),
+          [buffer](const auto &owned) { return owned.get() == buffer; });
+      if (it != this->m_buffers.end()) {
+        this->m_retired_pushed +=
+            buffer->pushed.load(std::memory_order_acquire);
+        this->m_buffers.erase(it);
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief Writer thread: drain all buffers, order the batch by time and
+   * write it with a single flush
+   */
+  void run_writer() {
+    TimestampCache timestamps;
+    std::vector<Record> batch;
+    std::vector<ThreadBuffer *> buffers;
+    std::vector<ThreadBuffer *> retired;
+    std::string text;
+
+    for (int attempt = 0;; ++attempt) {
+      const bool stopping = this->m_stop.load(std::memory_order_acquire);
+      {
+        std::lock_guard<std::mutex> lock(this->m_buffers_mutex);
+        buffers.clear();
+        for (const auto &buffer : this->m_buffers) {
+          buffers.push_back(buffer.get());
+        }
+      }
+
+      uint64_t dropped = 0;
+      retired.clear();
+      for (ThreadBuffer *buffer : buffers) {
+        // Checked before draining, a retired thread pushes nothing more
+        if (buffer->retired.load(std::memory_order_acquire)) {
+          retired.push_back(buffer);
+        }
+        while (auto record = buffer->queue.try_pop()) {
+          batch.push_back(*record);
+        }
+        dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+      }
+      if (!retired.empty()) {
+        this->remove_retired(retired);
+      }
+
+      if (batch.empty() && dropped == 0) {
+        if (stopping) {
+          return;
+        }
+        pipeline::backoff(attempt);
+        continue;
+      }
+      attempt = 0;
+
+      std::stable_sort(batch.begin(), batch.end(),
+                       [](const Record &a, const Record &b) {
+                         return a.time < b.time;
+                       });
+      text.clear();
+      for (const Record &record : batch) {
+        format_line(record, timestamps, text);
+      }
+      if (dropped > 0) {
+        this->m_total_dropped.fetch_add(dropped, std::memory_order_relaxed);
+        Record report;
+        report.level = Level::WARNING;
+        report.file = __FILE__;
+        report.line = __LINE__;
+        report.time = std::chrono::system_clock::now();
+        format_message(report, dropped, " messages dropped, log buffer full");
+        format_line(report, timestamps, text);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_output << text;
+        m_output.flush();
+      }
+      this->m_written.fetch_add(batch.size(), std::memory_order_release);
+      batch.clear();
+    }
+  }
+
 private:
   /**
    * @brief Get the level string
    * @param level Log level
    * @return Level string
    */
-  std::string get_level_string(Level level) const {
+  static const char *get_level_string(Level level) {
     switch (level) {
     case Level::DEBUG:
       return "[DEBUG]";
@@ -93,7 +508,7 @@ private:
    * @param level Log level
    * @return Color string
    */
-  std::string get_color(Level level) const {
+  static const char *get_color(Level level) {
     switch (level) {
     case Level::DEBUG:
       return BLUE;
@@ -111,43 +526,73 @@ private:
   }
 
 private:
-  /**
-   * @brief Get the current timestamp
-   * @return Current timestamp
-   */
-  std::string get_current_timestamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %X");
-    return ss.str();
-  }
-
   std::mutex m_mutex;
   std::ostream m_output;
+  // Used by the synchronous path under m_mutex
+  TimestampCache m_timestamps;
+
+  std::atomic<Level> m_level{Level::DEBUG};
+  // Negative for the default of the current mode
+  std::atomic<int> m_rate_limit{-1};
+
+  std::atomic<bool> m_async{false};
+  std::atomic<bool> m_stop{false};
+  std::thread m_writer;
+  size_t m_capacity = 1024;
+  std::mutex m_buffers_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+  // Messages pushed by the dropped buffers of exited threads
+  uint64_t m_retired_pushed = 0;
+  std::atomic<uint64_t> m_written{0};
+  std::atomic<uint64_t> m_total_dropped{0};
 };
 } // namespace tflite::logging
 
+// One rate limiter per call site
+#define TFLITE_LOG_IMPL(level, ...)                                            \
+  do {                                                                         \
+    static ::tflite::logging::RateLimiter tflite_log_limiter;                  \
+    ::tflite::logging::Logger::get_instance().log(                             \
+        tflite_log_limiter, level, __FILE__, __LINE__, __VA_ARGS__);           \
+  } while (0)
+
+#if TFLITE_LOG_LEVEL <= 0
 #define LOG_DEBUG(...)                                                         \
-  tflite::logging::Logger::get_instance().log(                                 \
-      tflite::logging::Logger::Level::DEBUG, __FILE__, __LINE__, __VA_ARGS__)
+  TFLITE_LOG_IMPL(tflite::logging::Logger::Level::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)                                                         \
+  do {                                                                         \
+  } while (0)
+#endif
 
+#if TFLITE_LOG_LEVEL <= 1
+#define LOG_INFO(...)                                                          \
+  TFLITE_LOG_IMPL(tflite::logging::Logger::Level::INFO, __VA_ARGS__)
+#else
 #define LOG_INFO(...)                                                          \
-  tflite::logging::Logger::get_instance().log(                                 \
-      tflite::logging::Logger::Level::INFO, __FILE__, __LINE__, __VA_ARGS__)
+  do {                                                                         \
+  } while (0)
+#endif
 
+#if TFLITE_LOG_LEVEL <= 2
 #define LOG_WARNING(...)                                                       \
-  tflite::logging::Logger::get_instance().log(                                 \
-      tflite::logging::Logger::Level::WARNING, __FILE__, __LINE__,             \
-      __VA_ARGS__)
+  TFLITE_LOG_IMPL(tflite::logging::Logger::Level::WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...)                                                       \
+  do {                                                                         \
+  } while (0)
+#endif
 
+#if TFLITE_LOG_LEVEL <= 3
+#define LOG_ERROR(...)                                                         \
+  TFLITE_LOG_IMPL(tflite::logging::Logger::Level::ERROR, __VA_ARGS__)
+#else
 #define LOG_ERROR(...)                                                         \
-  tflite::logging::Logger::get_instance().log(                                 \
-      tflite::logging::Logger::Level::ERROR, __FILE__, __LINE__, __VA_ARGS__)
+  do {                                                                         \
+  } while (0)
+#endif
 
 #define LOG_FATAL(...)                                                         \
-  tflite::logging::Logger::get_instance().log(                                 \
-      tflite::logging::Logger::Level::FATAL, __FILE__, __LINE__, __VA_ARGS__)
+  TFLITE_LOG_IMPL(tflite::logging::Logger::Level::FATAL, __VA_ARGS__)
 
-#endif // LOGGING_HPP_
\ No newline at end of file
+#endif // LOGGING_HPP_
@@ -0,0 +1,65 @@
+/**
+ * @file rate_limiter.hpp
+ * @details Per call site limit of log messages per second
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef RATE_LIMITER_HPP
+#define RATE_LIMITER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace tflite::logging {
+class RateLimiter {
+public:
+  // Returned by acquire() when the message must be dropped
+  static constexpr int64_t SUPPRESSED = -1;
+
+public:
+  RateLimiter() = default;
+  ~RateLimiter() = default;
+
+  RateLimiter(const RateLimiter &) = delete;
+  RateLimiter &operator=(const RateLimiter &) = delete;
+  RateLimiter(RateLimiter &&) = delete;
+  RateLimiter &operator=(RateLimiter &&) = delete;
+
+public:
+  /**
+   * @brief Ask to emit a message. The counts are approximate when several
+   * threads start a new second at the same time.
+   * @param limit Messages per second, 0 for no limit
+   * @param second Current second of a monotonic clock
+   * @return SUPPRESSED, otherwise the number of messages suppressed since the
+   *         last emitted one, to be reported with this message
+   */
+  int64_t acquire(int limit, int64_t second) {
+    if (limit <= 0) {
+      return this->m_suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    int64_t window = this->m_window.load(std::memory_order_relaxed);
+    if (window != second && this->m_window.compare_exchange_strong(
+                                window, second, std::memory_order_relaxed)) {
+      this->m_count.store(1, std::memory_order_relaxed);
+      return this->m_suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    if (this->m_count.fetch_add(1, std::memory_order_relaxed) < limit) {
+      return 0;
+    }
+    this->m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return SUPPRESSED;
+  }
+
+private:
+  std::atomic<int64_t> m_window{-1};
+  std::atomic<int64_t> m_count{0};
+  std::atomic<int64_t> m_suppressed{0};
+};
+} // namespace tflite::logging
+
+#endif // RATE_LIMITER_HPP
@@ -0,0 +1,60 @@
+/**
+ * @file counter.hpp
+ * @details Monotonic counter with lock-free per-thread shards
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef COUNTER_HPP
+#define COUNTER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include <metrics/per_thread.hpp>
+
+namespace tflite::metrics {
+class Counter {
+public:
+  Counter() = default;
+  ~Counter() = default;
+
+  Counter(const Counter &) = delete;
+  Counter &operator=(const Counter &) = delete;
+  Counter(Counter &&) = delete;
+  Counter &operator=(Counter &&) = delete;
+
+public:
+  /**
+   * @brief Increment the counter
+   * @param value Increment
+   */
+  void increment(uint64_t value = 1) {
+    add_single_writer(this->m_shards.local().value, value);
+  }
+
+public:
+  /**
+   * @brief Sum the shards of all threads
+   * @return Counter value
+   */
+  [[nodiscard]] uint64_t value() const {
+    uint64_t total = 0;
+    this->m_shards.for_each([&total](const Shard &shard) {
+      total += shard.value.load(std::memory_order_relaxed);
+    });
+    return total;
+  }
+
+private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value{0};
+  };
+
+private:
+  PerThread<Shard> m_shards;
+};
+} // namespace tflite::metrics
+
+#endif // COUNTER_HPP
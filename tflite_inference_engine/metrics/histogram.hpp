@@ -0,0 +1,178 @@
+/**
+ * @file histogram.hpp
+ * @details Log-linear (HDR-style) latency histogram with lock-free per-thread
+ * shards
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <metrics/per_thread.hpp>
+
+namespace tflite::metrics {
+/**
+ * @brief Aggregated state of a histogram
+ */
+struct HistogramSnapshot {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+  std::vector<uint64_t> buckets;
+
+  /**
+   * @brief Get the mean of the recorded values
+   * @return Mean, 0 without values
+   */
+  [[nodiscard]] double mean() const {
+    return this->count > 0 ? static_cast<double>(this->sum) / this->count
+                           : 0.0;
+  }
+
+  /**
+   * @brief Get a percentile, within the bucket resolution of about 3%
+   * @param quantile Quantile in [0, 1], e.g. 0.99
+   * @return Value, 0 without values
+   */
+  [[nodiscard]] inline uint64_t percentile(double quantile) const;
+};
+
+class Histogram {
+public:
+  // 32 linear sub-buckets per power of two, about 3% relative error
+  static constexpr int SUB_BUCKET_BITS = 5;
+  static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+  // Values up to 2^45 ns (about 9.7 hours), larger ones land in the last
+  // bucket
+  static constexpr int MAX_EXPONENT = 44;
+  static constexpr size_t NUM_BUCKETS =
+      static_cast<size_t>(MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+public:
+  Histogram() = default;
+  ~Histogram() = default;
+
+  Histogram(const Histogram &) = delete;
+  Histogram &operator=(const Histogram &) = delete;
+  Histogram(Histogram &&) = delete;
+  Histogram &operator=(Histogram &&) = delete;
+
+public:
+  /**
+   * @brief Record a value
+   * @param value Value, nanoseconds for latencies
+   */
+  void record(uint64_t value) {
+    Shard &shard = this->m_shards.local();
+    add_single_writer(shard.buckets[bucket_index(value)], 1);
+    add_single_writer(shard.count, 1);
+    add_single_writer(shard.sum, value);
+    if (value > shard.max.load(std::memory_order_relaxed)) {
+      shard.max.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Record a duration in nanoseconds
+   * @param duration Duration
+   */
+  void record(std::chrono::steady_clock::duration duration) {
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    this->record(static_cast<uint64_t>(std::max<int64_t>(0, ns)));
+  }
+
+public:
+  /**
+   * @brief Aggregate the shards of all threads
+   * @return Snapshot
+   */
+  [[nodiscard]] HistogramSnapshot snapshot() const {
+    HistogramSnapshot snapshot;
+    snapshot.buckets.assign(NUM_BUCKETS, 0);
+    this->m_shards.for_each([&snapshot](const Shard &shard) {
+      for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+      }
+      snapshot.count += shard.count.load(std::memory_order_relaxed);
+      snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+      snapshot.max =
+          std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+    });
+    return snapshot;
+  }
+
+public:
+  /**
+   * @brief Get the bucket of a value: exact below 32, then 32 buckets per
+   * power of two
+   * @param value Value
+   * @return Bucket index
+   */
+  static size_t bucket_index(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return static_cast<size_t>(value);
+    }
+    const int exponent = 63 - __builtin_clzll(value);
+    if (exponent > MAX_EXPONENT) {
+      return NUM_BUCKETS - 1;
+    }
+    const int shift = exponent - SUB_BUCKET_BITS;
+    return static_cast<size_t>(shift + 1) * SUB_BUCKETS +
+           static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+  }
+
+  /**
+   * @brief Get the value representing a bucket, the middle of its range
+   * @param index Bucket index
+   * @return Value
+   */
+  static uint64_t bucket_value(size_t index) {
+    if (index < SUB_BUCKETS) {
+      return index;
+    }
+    const int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    const uint64_t lower = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + ((uint64_t{1} << shift) >> 1);
+  }
+
+private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+  };
+
+private:
+  PerThread<Shard> m_shards;
+};
+
+uint64_t HistogramSnapshot::percentile(double quantile) const {
+  if (this->count == 0) {
+    return 0;
+  }
+  const auto rank = static_cast<uint64_t>(std::max(
+      1.0, std::ceil(std::clamp(quantile, 0.0, 1.0) * this->count)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < this->buckets.size(); ++i) {
+    seen += this->buckets[i];
+    if (seen >= rank) {
+      return std::min(Histogram::bucket_value(i), this->max);
+    }
+  }
+  return this->max;
+}
+} // namespace tflite::metrics
+
+#endif // HISTOGRAM_HPP
@@ -0,0 +1,193 @@
+/**
+ * @file metrics_registry.hpp
+ * @details Process-wide registry of counters and latency histograms with
+ * Prometheus text export
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef METRICS_REGISTRY_HPP
+#define METRICS_REGISTRY_HPP
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <metrics/counter.hpp>
+#include <metrics/histogram.hpp>
+
+namespace tflite::metrics {
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+class MetricsRegistry {
+public:
+  /**
+   * @brief Get the instance of the registry
+   * @return Registry instance
+   */
+  static MetricsRegistry &get_instance() {
+    static MetricsRegistry instance;
+    return instance;
+  }
+
+public:
+  /**
+   * @brief Get or create a latency histogram. Look it up once and keep the
+   * reference, recording through it needs no lock.
+   * @param name Metric name, e.g. tflite_invoke_seconds
+   * @param help Description
+   * @param labels Labels telling apart histograms of the same name
+   * @return Histogram, valid for the lifetime of the process
+   */
+  Histogram &histogram(const std::string &name, const std::string &help,
+                       const Labels &labels = Labels()) {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    auto &family = this->get_family(name, help, "summary");
+    auto &histogram = family.histograms[format_labels(labels)];
+    if (!histogram) {
+      histogram = std::make_unique<Histogram>();
+    }
+    return *histogram;
+  }
+
+  /**
+   * @brief Get or create a counter
+   * @param name Metric name, e.g. tflite_invoke_errors_total
+   * @param help Description
+   * @param labels Labels telling apart counters of the same name
+   * @return Counter, valid for the lifetime of the process
+   */
+  Counter &counter(const std::string &name, const std::string &help,
+                   const Labels &labels = Labels()) {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    auto &family = this->get_family(name, help, "counter");
+    auto &counter = family.counters[format_labels(labels)];
+    if (!counter) {
+      counter = std::make_unique<Counter>();
+    }
+    return *counter;
+  }
+
+public:
+  /**
+   * @brief Aggregate all metrics in the Prometheus text format. Histograms
+   * are exported as summaries in seconds with p50, p90, p99 and p999.
+   * @return Prometheus text
+   */
+  [[nodiscard]] std::string to_prometheus() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    std::ostringstream out;
+    out.precision(9);
+    for (const auto &[name, family] : this->m_families) {
+      out << "# HELP " << name << " " << family.help << "\n"
+          << "# TYPE " << name << " " << family.type << "\n";
+
+      for (const auto &[labels, counter] : family.counters) {
+        out << name << wrap_labels(labels) << " " << counter->value() << "\n";
+      }
+
+      for (const auto &[labels, histogram] : family.histograms) {
+        const HistogramSnapshot snapshot = histogram->snapshot();
+        for (const auto &[quantile, text] : QUANTILES) {
+          const std::string quantile_label =
+              "quantile=\"" + std::string(text) + "\"";
+          out << name
+              << wrap_labels(labels.empty() ? quantile_label
+                                            : labels + "," + quantile_label)
+              << " " << snapshot.percentile(quantile) * 1e-9 << "\n";
+        }
+        out << name << "_sum" << wrap_labels(labels) << " "
+            << static_cast<double>(snapshot.sum) * 1e-9 << "\n"
+            << name << "_count" << wrap_labels(labels) << " "
+            << snapshot.count << "\n";
+      }
+    }
+    return out.str();
+  }
+
+  /**
+   * @brief Write the metrics to a file, e.g. for the node exporter textfile
+   * collector. Written to a temporary file and renamed, so readers never see
+   * a partial file.
+   * @param path File path
+   * @return True on success
+   */
+  bool write_prometheus(const std::string &path) {
+    const std::string temporary = path + ".tmp";
+    {
+      std::ofstream file(temporary);
+      if (!file) {
+        return false;
+      }
+      file << this->to_prometheus();
+      if (!file) {
+        return false;
+      }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+  }
+
+private:
+  MetricsRegistry() = default;
+  MetricsRegistry(const MetricsRegistry &) = delete;
+  MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+private:
+  static constexpr std::pair<double, const char *> QUANTILES[] = {
+      {0.5, "0.5"}, {0.9, "0.9"}, {0.99, "0.99"}, {0.999, "0.999"}};
+
+private:
+  struct Family {
+    std::string help;
+    std::string type;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+  };
+
+private:
+  Family &get_family(const std::string &name, const std::string &help,
+                     const std::string &type) {
+    auto &family = this->m_families[name];
+    if (family.type.empty()) {
+      family.help = help;
+      family.type = type;
+    }
+    return family;
+  }
+
+  static std::string format_labels(const Labels &labels) {
+    std::string text;
+    for (const auto &[key, value] : labels) {
+      if (!text.empty()) {
+        text += ",";
+      }
+      text += key + "=\"";
+      for (char c : value) {
+        if (c == '"' || c == '\\') {
+          text += '\\';
+        }
+        text += c == '\n' ? ' ' : c;
+      }
+      text += "\"";
+    }
+    return text;
+  }
+
+  static std::string wrap_labels(const std::string &labels) {
+    return labels.empty() ? "" : "{" + labels + "}";
+  }
+
+private:
+  std::mutex m_mutex;
+  std::map<std::string, Family> m_families;
+};
+} // namespace tflite::metrics
+
+#endif // METRICS_REGISTRY_HPP
@@ -0,0 +1,172 @@
+/**
+ * @file metrics_server.hpp
+ * @details Minimal HTTP endpoint serving the metrics to a Prometheus scraper
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef METRICS_SERVER_HPP
+#define METRICS_SERVER_HPP
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include <log/glogging.hpp>
+#include <metrics/metrics_registry.hpp>
+
+namespace tflite::metrics {
+class MetricsServer {
+public:
+  MetricsServer() = default;
+  ~MetricsServer() { this->stop(); }
+
+  MetricsServer(const MetricsServer &) = delete;
+  MetricsServer &operator=(const MetricsServer &) = delete;
+  MetricsServer(MetricsServer &&) = delete;
+  MetricsServer &operator=(MetricsServer &&) = delete;
+
+public:
+  /**
+   * @brief Serve the registry on every GET request from a background thread
+   * @param port TCP port, 0 to pick a free one
+   * @param address Bind address, local only by default
+   * @return True if the server is listening
+   */
+  bool start(uint16_t port, const std::string &address = "127.0.0.1") {
+    if (this->m_thread.joinable()) {
+      LOG(ERROR) << "Metrics server is already running";
+      return false;
+    }
+
+    this->m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (this->m_socket < 0) {
+      LOG(ERROR) << "Failed to create the metrics server socket";
+      return false;
+    }
+    const int reuse = 1;
+    setsockopt(this->m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse,
+               sizeof(reuse));
+
+    sockaddr_in endpoint{};
+    endpoint.sin_family = AF_INET;
+    endpoint.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &endpoint.sin_addr) != 1 ||
+        bind(this->m_socket, reinterpret_cast<sockaddr *>(&endpoint),
+             sizeof(endpoint)) != 0 ||
+        listen(this->m_socket, 4) != 0) {
+      LOG(ERROR) << "Failed to listen on " << address << ":" << port;
+      close(this->m_socket);
+      this->m_socket = -1;
+      return false;
+    }
+
+    socklen_t length = sizeof(endpoint);
+    getsockname(this->m_socket, reinterpret_cast<sockaddr *>(&endpoint),
+                &length);
+    this->m_port = ntohs(endpoint.sin_port);
+
+    this->m_stop = false;
+    this->m_thread = std::thread(&MetricsServer::run, this);
+    LOG(INFO) << "Serving metrics on http://" << address << ":"
+              << this->m_port << "/metrics";
+    return true;
+  }
+
+public:
+  /**
+   * @brief Get the port the server listens on
+   * @return Port, 0 if not running
+   */
+  [[nodiscard]] uint16_t get_port() const { return this->m_port; }
+
+public:
+  /**
+   * @brief Stop serving and close the socket
+   */
+  void stop() {
+    this->m_stop = true;
+    if (this->m_thread.joinable()) {
+      this->m_thread.join();
+    }
+    if (this->m_socket >= 0) {
+      close(this->m_socket);
+      this->m_socket = -1;
+    }
+    this->m_port = 0;
+  }
+
+private:
+  /**
+   * @brief Accept loop, polls so that stop() is noticed within 100 ms
+   */
+  void run() {
+    while (!this->m_stop) {
+      pollfd descriptor{this->m_socket, POLLIN, 0};
+      if (poll(&descriptor, 1, 100) <= 0) {
+        continue;
+      }
+      const int client = accept(this->m_socket, nullptr, nullptr);
+      if (client < 0) {
+        continue;
+      }
+      this->respond(client);
+      close(client);
+    }
+  }
+
+private:
+  /**
+   * @brief Read the request line and answer with the metrics
+   * @param client Client socket
+   */
+  static void respond(int client) {
+    char request[1024];
+    pollfd descriptor{client, POLLIN, 0};
+    if (poll(&descriptor, 1, 1000) <= 0) {
+      return;
+    }
+    const ssize_t received = recv(client, request, sizeof(request), 0);
+    if (received <= 0) {
+      return;
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    if (std::string(request, static_cast<size_t>(received)).rfind("GET ", 0) ==
+        0) {
+      body = MetricsRegistry::get_instance().to_prometheus();
+    } else {
+      status = "405 Method Not Allowed";
+    }
+
+    const std::string response =
+        "HTTP/1.1 " + status +
+        "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+        std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+      const ssize_t count = send(client, response.data() + sent,
+                                 response.size() - sent, MSG_NOSIGNAL);
+      if (count <= 0) {
+        return;
+      }
+      sent += static_cast<size_t>(count);
+    }
+  }
+
+private:
+  int m_socket = -1;
+  std::atomic<uint16_t> m_port{0};
+  std::atomic<bool> m_stop{true};
+  std::thread m_thread;
+};
+} // namespace tflite::metrics
+
+#endif // METRICS_SERVER_HPP
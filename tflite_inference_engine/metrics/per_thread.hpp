@@ -0,0 +1,185 @@
+/**
+ * @file per_thread.hpp
+ * @details Per-thread shards of a metric, written without locks by their
+ * thread and aggregated on demand
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef PER_THREAD_HPP
+#define PER_THREAD_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tflite::metrics {
+/**
+ * @brief Add to a counter only its own thread writes. A relaxed load and
+ * store instead of fetch_add, so there is no locked instruction on the hot
+ * path while readers still see a consistent value.
+ * @param counter Counter
+ * @param value Value to add
+ */
+inline void add_single_writer(std::atomic<uint64_t> &counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
+/**
+ * @brief Shards of a metric, one per thread that recorded. The shard of an
+ * exited thread keeps its values and is handed to the next new thread, so
+ * the number of shards is bounded by the peak number of recording threads.
+ * @tparam Shard Default constructible shard whose values only add up
+ */
+template <typename Shard> class PerThread {
+public:
+  PerThread() : m_id(next_id()) {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry()[this->m_id] = this;
+  }
+
+  ~PerThread() {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry().erase(this->m_id);
+  }
+
+  PerThread(const PerThread &) = delete;
+  PerThread &operator=(const PerThread &) = delete;
+  PerThread(PerThread &&) = delete;
+  PerThread &operator=(PerThread &&) = delete;
+
+public:
+  /**
+   * @brief Get the shard of the calling thread, created on first use
+   * @return Shard
+   */
+  Shard &local() {
+    auto &slots = thread_slots().shards;
+    if (this->m_id < slots.size() && slots[this->m_id] != nullptr) {
+      return *slots[this->m_id];
+    }
+    return this->add_thread(slots);
+  }
+
+public:
+  /**
+   * @brief Visit the shards of all threads that recorded, including threads
+   * that exited
+   * @param function Called with each shard
+   */
+  template <typename Function> void for_each(Function &&function) const {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    for (const auto &shard : this->m_shards) {
+      function(*shard);
+    }
+  }
+
+  /**
+   * @brief Get the number of shards allocated, including the ones of exited
+   * threads kept for reuse
+   * @return Number of shards
+   */
+  [[nodiscard]] size_t num_shards() const {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    return this->m_shards.size();
+  }
+
+private:
+  /**
+   * @brief Per-thread owner of the shards, retires them when the thread
+   * exits
+   */
+  struct ThreadSlots {
+    ThreadSlots() = default;
+    ~ThreadSlots() {
+      std::lock_guard<std::mutex> lock(registry_mutex());
+      for (size_t id = 0; id < this->shards.size(); ++id) {
+        if (this->shards[id] == nullptr) {
+          continue;
+        }
+        // The instance may have been destroyed before the thread exits
+        auto it = registry().find(id);
+        if (it != registry().end()) {
+          it->second->retire(this->shards[id]);
+        }
+      }
+    }
+
+    ThreadSlots(const ThreadSlots &) = delete;
+    ThreadSlots &operator=(const ThreadSlots &) = delete;
+
+    // Shards indexed by instance id. Ids are never reused, so a stale entry
+    // of a destroyed instance is never read.
+    std::vector<Shard *> shards;
+  };
+
+  static ThreadSlots &thread_slots() {
+    thread_local ThreadSlots slots;
+    return slots;
+  }
+
+  static size_t next_id() {
+    static std::atomic<size_t> id{0};
+    return id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Live instances by id, so an exiting thread only retires shards of
+   * instances that still exist
+   */
+  static std::unordered_map<size_t, PerThread *> &registry() {
+    static std::unordered_map<size_t, PerThread *> instances;
+    return instances;
+  }
+
+  static std::mutex &registry_mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  /**
+   * @brief Give the calling thread a shard, the one of an exited thread if
+   * any
+   */
+  Shard &add_thread(std::vector<Shard *> &slots) {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    Shard *shard = nullptr;
+    if (!this->m_free.empty()) {
+      shard = this->m_free.back();
+      this->m_free.pop_back();
+    } else {
+      this->m_shards.push_back(std::make_unique<Shard>());
+      shard = this->m_shards.back().get();
+    }
+    slots.resize(std::max(slots.size(), this->m_id + 1), nullptr);
+    slots[this->m_id] = shard;
+    return *shard;
+  }
+
+  /**
+   * @brief Retire the shard of an exiting thread. Its values keep counting
+   * in for_each() and the next thread adding to them keeps them consistent,
+   * since only one thread writes a shard at a time.
+   */
+  void retire(Shard *shard) {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    this->m_free.push_back(shard);
+  }
+
+private:
+  const size_t m_id;
+  mutable std::mutex m_mutex;
+  // Shards of running and exited threads
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  // Shards of exited threads, reused by new threads
+  std::vector<Shard *> m_free;
+};
+} // namespace tflite::metrics
+
+#endif // PER_THREAD_HPP
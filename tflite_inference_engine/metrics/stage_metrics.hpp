@@ -0,0 +1,61 @@
+/**
+ * @file stage_metrics.hpp
+ * @details Metrics of the stages of the inference path
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef STAGE_METRICS_HPP
+#define STAGE_METRICS_HPP
+
+#include <metrics/metrics_registry.hpp>
+
+namespace tflite::metrics {
+/**
+ * @brief Histograms and counters recorded by the engine, the preprocessor
+ * and the visualizers, registered once on first use
+ */
+struct StageMetrics {
+  Histogram &model_load;
+  Histogram &preprocess;
+  Histogram &invoke;
+  Histogram &detection_postprocess;
+  Histogram &segmentation_postprocess;
+  Histogram &tiled_frame;
+  Counter &invoke_errors;
+
+  /**
+   * @brief Get the stage metrics
+   * @return Stage metrics
+   */
+  static StageMetrics &get() {
+    static StageMetrics metrics{
+        registry().histogram("tflite_model_load_seconds",
+                             "Time to load a model and prepare its "
+                             "interpreter"),
+        registry().histogram("tflite_preprocess_seconds",
+                             "Time to resize and normalize an image into "
+                             "the input tensor"),
+        registry().histogram("tflite_invoke_seconds",
+                             "Time of one interpreter invocation"),
+        registry().histogram("tflite_postprocess_seconds",
+                             "Time to decode the output tensors",
+                             {{"task", "detection"}}),
+        registry().histogram("tflite_postprocess_seconds",
+                             "Time to decode the output tensors",
+                             {{"task", "segmentation"}}),
+        registry().histogram("tflite_tiled_frame_seconds",
+                             "Time to detect and merge all tiles of a "
+                             "frame"),
+        registry().counter("tflite_invoke_errors_total",
+                           "Number of failed interpreter invocations")};
+    return metrics;
+  }
+
+private:
+  static MetricsRegistry &registry() { return MetricsRegistry::get_instance(); }
+};
+} // namespace tflite::metrics
+
+#endif // STAGE_METRICS_HPP
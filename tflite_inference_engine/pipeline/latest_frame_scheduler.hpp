@@ -0,0 +1,311 @@
+/**
+ * @file latest_frame_scheduler.hpp
+ * @details Real-time scheduler running inference on the latest captured frame
+ * and dropping the frames the model cannot keep up with
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef LATEST_FRAME_SCHEDULER_HPP
+#define LATEST_FRAME_SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include <infer/async_infer.hpp>
+#include <log/glogging.hpp>
+#include <opencv2/opencv.hpp>
+#include <pipeline/latest_mailbox.hpp>
+#include <pipeline/pipeline.hpp>
+#include <preprocess/preprocessor.hpp>
+
+namespace tflite::pipeline {
+/**
+ * @brief Which captured frames are handed to the inference worker
+ */
+enum class FramePolicy {
+  // Every frame, the worker picks the latest one when it is free
+  LATEST_ONLY,
+  // Every Nth captured frame
+  EVERY_NTH,
+  // At most target_fps frames per second
+  TARGET_FPS
+};
+
+struct SchedulerOptions {
+  FramePolicy policy = FramePolicy::LATEST_ONLY;
+  int every_n = 1;
+  double target_fps = 0.0;
+};
+
+/**
+ * @brief Counters of the scheduler
+ */
+struct SchedulerStats {
+  uint64_t submitted = 0;
+  // Rejected by the policy
+  uint64_t skipped = 0;
+  // Replaced by a newer frame before the worker was free
+  uint64_t overwritten = 0;
+  uint64_t processed = 0;
+  // Capture to result latency
+  double mean_latency_ms = 0.0;
+  double max_latency_ms = 0.0;
+  double last_latency_ms = 0.0;
+
+  [[nodiscard]] uint64_t dropped() const {
+    return this->skipped + this->overwritten;
+  }
+};
+
+class LatestFrameScheduler {
+public:
+  // Called from the worker thread with the frame and its results
+  using Callback = std::function<void(Frame &)>;
+
+public:
+  explicit LatestFrameScheduler(
+      const SchedulerOptions &options = SchedulerOptions())
+      : m_options(options) {}
+  ~LatestFrameScheduler() { this->stop(); }
+
+  LatestFrameScheduler(const LatestFrameScheduler &) = delete;
+  LatestFrameScheduler &operator=(const LatestFrameScheduler &) = delete;
+  LatestFrameScheduler(LatestFrameScheduler &&) = delete;
+  LatestFrameScheduler &operator=(LatestFrameScheduler &&) = delete;
+
+public:
+  /**
+   * @brief Start the inference worker
+   * @param engine Engine with a loaded model, used only by the worker
+   * @param preprocessor Preprocessor writing into the engine input, nullptr to
+   *        pass the frames unchanged to set_input()
+   * @param callback Called with each processed frame
+   * @return False if the engine is missing or the worker is running
+   */
+  bool start(std::shared_ptr<inference::TFLiteInferenceEngine> engine,
+             std::shared_ptr<preprocess::Preprocessor> preprocessor,
+             Callback callback) {
+    if (!engine || this->m_worker.joinable()) {
+      LOG(ERROR) << "Scheduler needs an engine and must not be running";
+      return false;
+    }
+
+    this->m_engine = std::move(engine);
+    this->m_preprocessor = std::move(preprocessor);
+    this->m_callback = std::move(callback);
+    this->reset_stats();
+    this->m_stop = false;
+    this->m_worker = std::thread(&LatestFrameScheduler::run, this);
+    return true;
+  }
+
+public:
+  /**
+   * @brief Hand a captured frame to the worker, never blocks. Only called
+   * from the capture thread. The image is copied into a buffer owned by the
+   * mailbox slot, so the caller can reuse its image right away, e.g. as the
+   * destination of the next cv::VideoCapture::read().
+   * @param image Captured image
+   * @return False if the policy skipped the frame
+   */
+  bool submit(const cv::Mat &image) {
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t id =
+        this->m_submitted.fetch_add(1, std::memory_order_relaxed);
+    if (!this->accept(id, now)) {
+      this->m_skipped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    // Reuses the slot's buffer while the capture size does not change
+    Frame &frame = this->m_mailbox.back();
+    frame.id = id;
+    frame.capture_time = now;
+    image.copyTo(frame.image);
+    if (!this->m_mailbox.publish()) {
+      this->m_overwritten.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+public:
+  /**
+   * @brief Get the counters
+   * @return Counters
+   */
+  [[nodiscard]] SchedulerStats get_stats() const {
+    SchedulerStats stats;
+    stats.submitted = this->m_submitted.load(std::memory_order_relaxed);
+    stats.skipped = this->m_skipped.load(std::memory_order_relaxed);
+    stats.overwritten = this->m_overwritten.load(std::memory_order_relaxed);
+    stats.processed = this->m_processed.load(std::memory_order_relaxed);
+    if (stats.processed > 0) {
+      stats.mean_latency_ms =
+          this->m_latency_ns.load(std::memory_order_relaxed) / 1e6 /
+          static_cast<double>(stats.processed);
+    }
+    stats.max_latency_ms =
+        this->m_max_latency_ns.load(std::memory_order_relaxed) / 1e6;
+    stats.last_latency_ms =
+        this->m_last_latency_ns.load(std::memory_order_relaxed) / 1e6;
+    return stats;
+  }
+
+  /**
+   * @brief Reset the counters, only while the worker is stopped
+   */
+  void reset_stats() {
+    this->m_submitted = 0;
+    this->m_skipped = 0;
+    this->m_overwritten = 0;
+    this->m_processed = 0;
+    this->m_latency_ns = 0;
+    this->m_max_latency_ns = 0;
+    this->m_last_latency_ns = 0;
+    this->m_last_accepted = std::chrono::steady_clock::time_point();
+  }
+
+public:
+  /**
+   * @brief Process the pending frame and stop the worker
+   */
+  void stop() {
+    this->m_stop = true;
+    if (this->m_worker.joinable()) {
+      this->m_worker.join();
+    }
+  }
+
+private:
+  /**
+   * @brief Apply the policy to a captured frame
+   * @param id Index of the frame since start
+   * @param now Capture time
+   * @return True if the frame goes to the worker
+   */
+  bool accept(uint64_t id, std::chrono::steady_clock::time_point now) {
+    switch (this->m_options.policy) {
+    case FramePolicy::EVERY_NTH:
+      return id % static_cast<uint64_t>(std::max(1, this->m_options.every_n)) ==
+             0;
+    case FramePolicy::TARGET_FPS: {
+      if (this->m_options.target_fps <= 0.0) {
+        return true;
+      }
+      const auto period = std::chrono::duration_cast<
+          std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / this->m_options.target_fps));
+      if (this->m_last_accepted != std::chrono::steady_clock::time_point() &&
+          now - this->m_last_accepted < period) {
+        return false;
+      }
+      // Keep the cadence instead of drifting by the capture jitter
+      this->m_last_accepted =
+          now - this->m_last_accepted < 2 * period
+              ? this->m_last_accepted + period
+              : now;
+      return true;
+    }
+    case FramePolicy::LATEST_ONLY:
+    default:
+      return true;
+    }
+  }
+
+private:
+  /**
+   * @brief Worker loop, always runs on the latest frame
+   */
+  void run() {
+    TFLITE_TRACE_THREAD_NAME("scheduler");
+    for (int attempt = 0;; ++attempt) {
+      Frame *frame = this->m_mailbox.take_in_place();
+      if (!frame) {
+        if (this->m_stop) {
+          return;
+        }
+        backoff(attempt);
+        continue;
+      }
+      attempt = 0;
+
+      TFLITE_TRACE_FRAME(frame->id);
+      TFLITE_TRACE_SCOPE("process_frame");
+      this->process(*frame);
+      this->record(std::chrono::steady_clock::now() - frame->capture_time);
+      if (this->m_callback) {
+        this->m_callback(*frame);
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief Preprocess straight into the input tensor and run the model
+   * @param frame Frame, receives the results
+   */
+  void process(Frame &frame) {
+    inference::InferenceStatus status;
+    if (this->m_preprocessor) {
+      cv::Mat input = this->m_engine->input_view();
+      status = this->m_preprocessor->run(frame.image, input);
+    } else {
+      status = this->m_engine->set_input(frame.image);
+    }
+    if (status == inference::InferenceStatus::SUCCESS) {
+      status = this->m_engine->invoke();
+    }
+
+    if (status != inference::InferenceStatus::SUCCESS) {
+      frame.result = inference::InferenceResult();
+      frame.result.status = status;
+      return;
+    }
+    frame.result = inference::InferenceResult::collect(*this->m_engine);
+  }
+
+private:
+  /**
+   * @brief Record the capture to result latency of a processed frame
+   * @param latency Latency
+   */
+  void record(std::chrono::steady_clock::duration latency) {
+    const uint64_t ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    this->m_processed.fetch_add(1, std::memory_order_relaxed);
+    this->m_latency_ns.fetch_add(ns, std::memory_order_relaxed);
+    this->m_last_latency_ns.store(ns, std::memory_order_relaxed);
+    // Only the worker writes the maximum
+    if (ns > this->m_max_latency_ns.load(std::memory_order_relaxed)) {
+      this->m_max_latency_ns.store(ns, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  const SchedulerOptions m_options;
+  std::shared_ptr<inference::TFLiteInferenceEngine> m_engine;
+  std::shared_ptr<preprocess::Preprocessor> m_preprocessor;
+  Callback m_callback;
+
+  LatestMailbox<Frame> m_mailbox;
+  std::chrono::steady_clock::time_point m_last_accepted;
+  std::atomic<bool> m_stop{true};
+  std::thread m_worker;
+
+  std::atomic<uint64_t> m_submitted{0};
+  std::atomic<uint64_t> m_skipped{0};
+  std::atomic<uint64_t> m_overwritten{0};
+  std::atomic<uint64_t> m_processed{0};
+  std::atomic<uint64_t> m_latency_ns{0};
+  std::atomic<uint64_t> m_max_latency_ns{0};
+  std::atomic<uint64_t> m_last_latency_ns{0};
+};
+} // namespace tflite::pipeline
+
+#endif // LATEST_FRAME_SCHEDULER_HPP
@@ -0,0 +1,119 @@
+/**
+ * @file latest_mailbox.hpp
+ * @details Lock-free single slot mailbox where the latest value wins
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef LATEST_MAILBOX_HPP
+#define LATEST_MAILBOX_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace tflite::pipeline {
+/**
+ * @brief Single producer single consumer mailbox holding only the latest
+ * value. Posting never blocks and overwrites an unread value. Implemented as
+ * a triple buffer: the producer and the consumer each own one slot and swap
+ * it with the shared middle slot.
+ */
+template <typename T> class LatestMailbox {
+public:
+  LatestMailbox() = default;
+  ~LatestMailbox() = default;
+
+  LatestMailbox(const LatestMailbox &) = delete;
+  LatestMailbox &operator=(const LatestMailbox &) = delete;
+  LatestMailbox(LatestMailbox &&) = delete;
+  LatestMailbox &operator=(LatestMailbox &&) = delete;
+
+public:
+  /**
+   * @brief Publish a value, only called from the producer thread
+   * @param value Value, moved into the mailbox
+   * @return False if an unread value was overwritten
+   */
+  bool post(T value) {
+    this->back() = std::move(value);
+    return this->publish();
+  }
+
+  /**
+   * @brief Get the producer-owned slot to fill in place, e.g. to reuse the
+   * buffers of the value it held before. Only called from the producer
+   * thread, the slot is published by publish().
+   * @return Producer-owned slot
+   */
+  T &back() { return this->m_slots[this->m_back]; }
+
+  /**
+   * @brief Publish the producer-owned slot, only called from the producer
+   * thread
+   * @return False if an unread value was overwritten
+   */
+  bool publish() {
+    const uint8_t previous =
+        this->m_middle.exchange(this->m_back | UNREAD, std::memory_order_acq_rel);
+    this->m_back = previous & INDEX;
+    return (previous & UNREAD) == 0;
+  }
+
+public:
+  /**
+   * @brief Take the latest value, only called from the consumer thread
+   * @return Value, empty if nothing was posted since the last take
+   */
+  std::optional<T> take() {
+    T *value = this->take_in_place();
+    if (!value) {
+      return std::nullopt;
+    }
+    return std::move(*value);
+  }
+
+  /**
+   * @brief Take the latest value without moving it out of its slot, only
+   * called from the consumer thread. The slot belongs to the consumer until
+   * the next take.
+   * @return Value, nullptr if nothing was posted since the last take
+   */
+  T *take_in_place() {
+    if ((this->m_middle.load(std::memory_order_relaxed) & UNREAD) == 0) {
+      return nullptr;
+    }
+    // Only the producer sets the flag, so the slot is still unread here
+    const uint8_t previous =
+        this->m_middle.exchange(this->m_front, std::memory_order_acq_rel);
+    this->m_front = previous & INDEX;
+    return &this->m_slots[this->m_front];
+  }
+
+public:
+  /**
+   * @brief Check for an unread value
+   * @return True if take() would return a value
+   */
+  [[nodiscard]] bool has_value() const {
+    return (this->m_middle.load(std::memory_order_acquire) & UNREAD) != 0;
+  }
+
+private:
+  static constexpr uint8_t INDEX = 0x3;
+  static constexpr uint8_t UNREAD = 0x4;
+
+private:
+  std::array<T, 3> m_slots;
+  alignas(64) std::atomic<uint8_t> m_middle{1};
+  // Producer-owned slot
+  alignas(64) uint8_t m_back = 0;
+  // Consumer-owned slot
+  alignas(64) uint8_t m_front = 2;
+};
+} // namespace tflite::pipeline
+
+#endif // LATEST_MAILBOX_HPP
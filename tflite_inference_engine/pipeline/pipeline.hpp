@@ -0,0 +1,358 @@
+/**
+ * @file pipeline.hpp
+ * @details Multi-stage frame pipeline with one thread per stage connected by
+ * bounded lock-free queues
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <infer/async_infer.hpp>
+#include <log/glogging.hpp>
+#include <opencv2/opencv.hpp>
+#include <pipeline/roi_cascade.hpp>
+#include <pipeline/spsc_queue.hpp>
+#include <trace/tracer.hpp>
+#include <visualizer/object_detection.hpp>
+
+namespace tflite::pipeline {
+/**
+ * @brief Data of one frame travelling through the pipeline
+ */
+struct Frame {
+  uint64_t id = 0;
+  bool end_of_stream = false;
+  std::chrono::steady_clock::time_point capture_time;
+
+  // Captured image
+  cv::Mat image;
+  // Preprocessed model input
+  cv::Mat input;
+  // Model outputs
+  inference::InferenceResult result;
+  // Decoded detections
+  visualizer::ObjectDetectionVisualizer::DetectionOutput detections;
+  // Second-stage results of the detections
+  std::vector<RoiResult> rois;
+};
+
+/**
+ * @brief Counters of one stage
+ */
+struct StageStats {
+  std::string name;
+  uint64_t frames = 0;
+  double fps = 0.0;
+  // Mean processing time per frame
+  double mean_ms = 0.0;
+  // Depth of the queue feeding the stage
+  size_t queue_depth = 0;
+  size_t max_queue_depth = 0;
+  size_t queue_capacity = 0;
+};
+
+class Pipeline {
+public:
+  // Fills the frame, returns false at the end of the stream
+  using Source = std::function<bool(Frame &)>;
+  // Processes or consumes the frame
+  using Stage = std::function<void(Frame &)>;
+
+public:
+  /**
+   * @brief Create the pipeline
+   * @param queue_capacity Capacity of each queue between two stages
+   */
+  explicit Pipeline(size_t queue_capacity = 4)
+      : m_queue_capacity(queue_capacity) {}
+  ~Pipeline() { this->stop(); }
+
+  Pipeline(const Pipeline &) = delete;
+  Pipeline &operator=(const Pipeline &) = delete;
+  Pipeline(Pipeline &&) = delete;
+  Pipeline &operator=(Pipeline &&) = delete;
+
+public:
+  /**
+   * @brief Set the stage producing the frames
+   * @param name Stage name
+   * @param source Source
+   */
+  void set_source(const std::string &name, Source source) {
+    this->m_source_name = name;
+    this->m_source = std::move(source);
+  }
+
+public:
+  /**
+   * @brief Append a stage, the last one added is the sink
+   * @param name Stage name
+   * @param stage Stage
+   */
+  void add_stage(const std::string &name, Stage stage) {
+    auto state = std::make_unique<StageState>(this->m_queue_capacity);
+    state->name = name;
+    state->stage = std::move(stage);
+    this->m_stages.push_back(std::move(state));
+  }
+
+public:
+  /**
+   * @brief Start one thread per stage
+   * @return False if there is no source or no stage, or it is running
+   */
+  bool start() {
+    if (!this->m_source || this->m_stages.empty() || this->m_running) {
+      LOG(ERROR) << "Pipeline needs a source and at least one stage";
+      return false;
+    }
+
+    this->m_running = true;
+    this->m_stop = false;
+    this->m_source_state.reset();
+    for (auto &state : this->m_stages) {
+      state->reset();
+    }
+
+    this->m_threads.emplace_back(&Pipeline::run_source, this);
+    for (size_t i = 0; i < this->m_stages.size(); ++i) {
+      this->m_threads.emplace_back(&Pipeline::run_stage, this, i);
+    }
+    return true;
+  }
+
+public:
+  /**
+   * @brief Wait until the source ended and all frames reached the sink
+   */
+  void wait() {
+    for (auto &thread : this->m_threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+    this->m_threads.clear();
+    this->m_running = false;
+  }
+
+public:
+  /**
+   * @brief Stop all stages, frames in flight are dropped
+   */
+  void stop() {
+    this->m_stop = true;
+    this->wait();
+  }
+
+public:
+  /**
+   * @brief Get the counters of the source and all stages
+   * @return Counters in pipeline order
+   */
+  [[nodiscard]] std::vector<StageStats> get_stats() const {
+    std::vector<StageStats> stats;
+    stats.push_back(this->m_source_state.get_stats(this->m_source_name));
+    for (const auto &state : this->m_stages) {
+      stats.push_back(state->get_stats(state->name));
+    }
+    return stats;
+  }
+
+private:
+  struct Counters {
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> busy_ns{0};
+    std::atomic<size_t> max_queue_depth{0};
+    std::chrono::steady_clock::time_point start;
+
+    void reset() {
+      this->frames = 0;
+      this->busy_ns = 0;
+      this->max_queue_depth = 0;
+      this->start = std::chrono::steady_clock::now();
+    }
+
+    void record(std::chrono::steady_clock::duration busy) {
+      this->frames.fetch_add(1, std::memory_order_relaxed);
+      this->busy_ns.fetch_add(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(),
+          std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] StageStats get_stats(const std::string &name) const {
+      StageStats stats;
+      stats.name = name;
+      stats.frames = this->frames.load(std::memory_order_relaxed);
+      stats.max_queue_depth =
+          this->max_queue_depth.load(std::memory_order_relaxed);
+      const double seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - this->start)
+                                 .count();
+      if (seconds > 0.0) {
+        stats.fps = static_cast<double>(stats.frames) / seconds;
+      }
+      if (stats.frames > 0) {
+        stats.mean_ms = this->busy_ns.load(std::memory_order_relaxed) / 1e6 /
+                        static_cast<double>(stats.frames);
+      }
+      return stats;
+    }
+  };
+
+  struct StageState : Counters {
+    explicit StageState(size_t capacity) : queue(capacity) {}
+
+    std::string name;
+    Stage stage;
+    // Queue feeding this stage
+    SPSCQueue<Frame> queue;
+
+    [[nodiscard]] StageStats get_stats(const std::string &name) const {
+      StageStats stats = Counters::get_stats(name);
+      stats.queue_depth = this->queue.size();
+      stats.queue_capacity = this->queue.capacity();
+      return stats;
+    }
+  };
+
+private:
+  /**
+   * @brief Source thread: produce frames until the end of the stream
+   */
+  void run_source() {
+    TFLITE_TRACE_THREAD_NAME(this->m_source_name);
+    [[maybe_unused]] const char *span_name =
+        trace::Tracer::get_instance().intern(this->m_source_name);
+    uint64_t id = 0;
+    while (!this->m_stop) {
+      Frame frame;
+      frame.id = id++;
+      const auto start = std::chrono::steady_clock::now();
+      frame.capture_time = start;
+      bool produced;
+      {
+        TFLITE_TRACE_FRAME(frame.id);
+        TFLITE_TRACE_SCOPE(span_name);
+        produced = this->m_source(frame);
+      }
+      if (!produced) {
+        break;
+      }
+      this->m_source_state.record(std::chrono::steady_clock::now() - start);
+      if (!this->push(0, frame)) {
+        return;
+      }
+    }
+
+    Frame end;
+    end.end_of_stream = true;
+    this->push(0, end);
+  }
+
+private:
+  /**
+   * @brief Stage thread: process frames until the end of the stream
+   * @param index Stage index
+   */
+  void run_stage(size_t index) {
+    StageState &state = *this->m_stages[index];
+    const bool is_sink = index + 1 == this->m_stages.size();
+    TFLITE_TRACE_THREAD_NAME(state.name);
+    [[maybe_unused]] const char *span_name =
+        trace::Tracer::get_instance().intern(state.name);
+
+    while (true) {
+      std::optional<Frame> frame = this->pop(state);
+      if (!frame) {
+        return;
+      }
+
+      if (!frame->end_of_stream) {
+        const auto start = std::chrono::steady_clock::now();
+        {
+          TFLITE_TRACE_FRAME(frame->id);
+          TFLITE_TRACE_SCOPE(span_name);
+          state.stage(*frame);
+        }
+        state.record(std::chrono::steady_clock::now() - start);
+      }
+
+      const bool end_of_stream = frame->end_of_stream;
+      if (!is_sink && !this->push(index + 1, *frame)) {
+        return;
+      }
+      if (end_of_stream) {
+        return;
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief Push a frame into the queue of a stage, waiting while it is full
+   * @param index Stage index
+   * @param frame Frame
+   * @return False if the pipeline was stopped
+   */
+  bool push(size_t index, Frame &frame) {
+    StageState &state = *this->m_stages[index];
+    for (int attempt = 0; !state.queue.try_push(frame); ++attempt) {
+      if (this->m_stop) {
+        return false;
+      }
+      backoff(attempt);
+    }
+
+    const size_t depth = state.queue.size();
+    size_t max_depth = state.max_queue_depth.load(std::memory_order_relaxed);
+    while (depth > max_depth && !state.max_queue_depth.compare_exchange_weak(
+                                    max_depth, depth,
+                                    std::memory_order_relaxed)) {
+    }
+    return true;
+  }
+
+private:
+  /**
+   * @brief Pop a frame from the queue of a stage, waiting while it is empty
+   * @param state Stage
+   * @return Frame, empty if the pipeline was stopped
+   */
+  std::optional<Frame> pop(StageState &state) {
+    for (int attempt = 0;; ++attempt) {
+      if (auto frame = state.queue.try_pop()) {
+        return frame;
+      }
+      if (this->m_stop) {
+        return std::nullopt;
+      }
+      backoff(attempt);
+    }
+  }
+
+private:
+  const size_t m_queue_capacity;
+
+  std::string m_source_name = "source";
+  Source m_source;
+  Counters m_source_state;
+  std::vector<std::unique_ptr<StageState>> m_stages;
+
+  std::vector<std::thread> m_threads;
+  std::atomic<bool> m_stop{false};
+  bool m_running = false;
+};
+} // namespace tflite::pipeline
+
+#endif // PIPELINE_HPP
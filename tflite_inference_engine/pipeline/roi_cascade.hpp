@@ -0,0 +1,303 @@
+/**
+ * @file roi_cascade.hpp
+ * @details Two-stage cascade running a second model on the regions of the
+ * detections of a first one, batched so the number of invocations depends on
+ * the batch size and not on the number of detections
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef ROI_CASCADE_HPP
+#define ROI_CASCADE_HPP
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <infer/async_infer.hpp>
+#include <infer/infer.hpp>
+#include <log/glogging.hpp>
+#include <opencv2/opencv.hpp>
+#include <preprocess/preprocessor.hpp>
+#include <trace/tracer.hpp>
+#include <visualizer/object_detection.hpp>
+
+namespace tflite::pipeline {
+/**
+ * @brief Selection of the detections passed to the second stage
+ */
+struct CascadeOptions {
+  // Classes passed to the second stage, all if empty
+  std::vector<int> classes;
+  float min_score = 0.5f;
+  // Fraction of the box width and height added on each side
+  float padding = 0.0f;
+  // Boxes smaller than this after clipping are skipped
+  int min_size = 2;
+  // Maximum number of regions per invocation
+  int max_batch_size = 16;
+};
+
+/**
+ * @brief Second-stage result of one detection
+ */
+struct RoiResult {
+  // Index of the box in the detection output
+  size_t detection = 0;
+  // Region passed to the second stage, in frame coordinates
+  cv::Rect roi;
+  inference::InferenceResult result;
+};
+
+class RoiCascade {
+public:
+  /**
+   * @brief Create the cascade
+   * @param engine Second-stage engine with a loaded model, used only by the
+   *        cascade. The model needs a resizable batch axis for batches larger
+   *        than its input's.
+   * @param spec Preprocessing of the second-stage input, see
+   *        PreprocessSpec::from_engine(). Must match the engine input, run()
+   *        fails otherwise.
+   * @param options Selection of the detections
+   */
+  RoiCascade(std::shared_ptr<inference::TFLiteInferenceEngine> engine,
+             const preprocess::PreprocessSpec &spec,
+             const CascadeOptions &options = CascadeOptions())
+      : m_engine(std::move(engine)), m_preprocessor(spec),
+        m_options(options) {
+    this->m_options.max_batch_size =
+        std::max(1, this->m_options.max_batch_size);
+    if (this->m_engine &&
+        (spec.width != this->m_engine->get_input_width() ||
+         spec.height != this->m_engine->get_input_height() ||
+         spec.channels != this->m_engine->get_input_channels() ||
+         spec.type != this->m_engine->get_input_type())) {
+      LOG(ERROR) << "Preprocessing spec " << spec.width << "x" << spec.height
+                 << "x" << spec.channels << " (type " << spec.type
+                 << ") does not match the second-stage input "
+                 << this->m_engine->get_input_width() << "x"
+                 << this->m_engine->get_input_height() << "x"
+                 << this->m_engine->get_input_channels() << " (type "
+                 << this->m_engine->get_input_type() << ")";
+      this->m_spec_matches = false;
+    }
+  }
+  ~RoiCascade() = default;
+
+  RoiCascade(const RoiCascade &) = delete;
+  RoiCascade &operator=(const RoiCascade &) = delete;
+  RoiCascade(RoiCascade &&) = delete;
+  RoiCascade &operator=(RoiCascade &&) = delete;
+
+public:
+  /**
+   * @brief Run the second stage on the selected detections of a frame
+   * @param frame Frame the detections were made on, 8-bit with the spec's
+   *        number of channels
+   * @param detections Boxes in frame coordinates
+   * @return One result per selected detection, in detection order
+   */
+  std::vector<RoiResult>
+  run(const cv::Mat &frame,
+      const visualizer::ObjectDetectionVisualizer::DetectionOutput
+          &detections) {
+    std::vector<RoiResult> results;
+    this->run(frame, detections, results);
+    return results;
+  }
+
+  /**
+   * @brief Run the second stage on the selected detections of a frame,
+   * reusing the storage of previous results
+   * @param frame Frame the detections were made on
+   * @param detections Boxes in frame coordinates
+   * @param results One result per selected detection, in detection order.
+   *        Results of failed batches carry the error status.
+   * @return SUCCESS, or the first error of the frame
+   */
+  inference::InferenceStatus
+  run(const cv::Mat &frame,
+      const visualizer::ObjectDetectionVisualizer::DetectionOutput &detections,
+      std::vector<RoiResult> &results) {
+    TFLITE_TRACE_SCOPE("roi_cascade");
+    this->m_num_invocations = 0;
+    this->select(frame.size(), detections, results);
+    if (results.empty()) {
+      return inference::InferenceStatus::SUCCESS;
+    }
+    if (!this->m_engine) {
+      LOG(ERROR) << "Second-stage engine is nullptr";
+      return inference::InferenceStatus::INTERPRETER_ERROR;
+    }
+    if (!this->m_spec_matches) {
+      for (auto &result : results) {
+        result.result = inference::InferenceResult();
+        result.result.status = inference::InferenceStatus::INPUT_ERROR;
+      }
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+
+    inference::InferenceStatus status = inference::InferenceStatus::SUCCESS;
+    const int num_rois = static_cast<int>(results.size());
+    for (int first = 0; first < num_rois;) {
+      const int count = std::min(this->m_options.max_batch_size,
+                                 num_rois - first);
+      const inference::InferenceStatus batch_status =
+          this->run_batch(frame, results, first, count);
+      if (status == inference::InferenceStatus::SUCCESS) {
+        status = batch_status;
+      }
+      first += count;
+    }
+    return status;
+  }
+
+public:
+  /**
+   * @brief Get the number of second-stage invocations of the last run
+   * @return Number of invocations
+   */
+  [[nodiscard]] size_t get_num_invocations() const {
+    return this->m_num_invocations;
+  }
+
+  /**
+   * @brief Get the batch size a number of regions is run with. Remainders
+   * are rounded up to a power of two, so only a few batch interpreters are
+   * created whatever the number of detections.
+   * @param count Number of regions, at most max_batch_size
+   * @param max_batch_size Maximum batch size
+   * @return Batch size
+   */
+  [[nodiscard]] static int get_batch_size(int count, int max_batch_size) {
+    int batch_size = 1;
+    while (batch_size < count) {
+      batch_size *= 2;
+    }
+    return std::min(batch_size, max_batch_size);
+  }
+
+  /**
+   * @brief Pad a box and clip it to the frame
+   * @param box Box in frame coordinates
+   * @param padding Fraction of the width and height added on each side
+   * @param frame Frame size
+   * @return Region, empty if the box is outside the frame
+   */
+  [[nodiscard]] static cv::Rect expand(const cv::Rect &box, float padding,
+                                       const cv::Size &frame) {
+    const int pad_x = cvRound(box.width * padding);
+    const int pad_y = cvRound(box.height * padding);
+    const cv::Rect padded(box.x - pad_x, box.y - pad_y, box.width + 2 * pad_x,
+                          box.height + 2 * pad_y);
+    return padded & cv::Rect(cv::Point(0, 0), frame);
+  }
+
+private:
+  /**
+   * @brief Select the detections of the options and compute their regions
+   */
+  void select(const cv::Size &frame,
+              const visualizer::ObjectDetectionVisualizer::DetectionOutput
+                  &detections,
+              std::vector<RoiResult> &results) const {
+    const auto &classes = this->m_options.classes;
+    const size_t num_detections =
+        std::min({detections.boxes.size(), detections.classes.size(),
+                  detections.scores.size()});
+    size_t num_rois = 0;
+    for (size_t i = 0; i < num_detections; ++i) {
+      if (detections.scores[i] < this->m_options.min_score ||
+          (!classes.empty() && std::find(classes.begin(), classes.end(),
+                                         detections.classes[i]) ==
+                                   classes.end())) {
+        continue;
+      }
+      const cv::Rect roi =
+          expand(detections.boxes[i], this->m_options.padding, frame);
+      if (roi.width < this->m_options.min_size ||
+          roi.height < this->m_options.min_size) {
+        continue;
+      }
+      if (num_rois == results.size()) {
+        results.emplace_back();
+      }
+      results[num_rois].detection = i;
+      results[num_rois].roi = roi;
+      ++num_rois;
+    }
+    results.resize(num_rois);
+  }
+
+  /**
+   * @brief Preprocess the regions [first, first + count) into one batched
+   * input, invoke once and copy each image's outputs into its result
+   */
+  inference::InferenceStatus run_batch(const cv::Mat &frame,
+                                       std::vector<RoiResult> &results,
+                                       int first, int count) {
+    const int batch_size =
+        get_batch_size(count, this->m_options.max_batch_size);
+    inference::InferenceStatus status = inference::InferenceStatus::SUCCESS;
+
+    // Regions are resized straight from the frame into their slot of the
+    // input tensor. Slots past count keep stale data, their outputs are
+    // ignored.
+    for (int i = 0; i < count; ++i) {
+      cv::Mat slot = this->m_engine->input_view(batch_size, i);
+      if (slot.empty()) {
+        status = inference::InferenceStatus::INTERPRETER_ERROR;
+        break;
+      }
+      const uchar *data = slot.data;
+      status = this->m_preprocessor.run(frame(results[first + i].roi), slot);
+      if (status != inference::InferenceStatus::SUCCESS) {
+        break;
+      }
+      // A reallocated slot means the engine input no longer matches the
+      // spec, e.g. after loading another model
+      if (slot.data != data) {
+        LOG(ERROR) << "Preprocessing did not write into the input tensor";
+        status = inference::InferenceStatus::INPUT_ERROR;
+        break;
+      }
+    }
+
+    if (status == inference::InferenceStatus::SUCCESS) {
+      ++this->m_num_invocations;
+      status = this->m_engine->invoke_batch(batch_size);
+    }
+    if (status != inference::InferenceStatus::SUCCESS) {
+      for (int i = 0; i < count; ++i) {
+        results[first + i].result = inference::InferenceResult();
+        results[first + i].result.status = status;
+      }
+      return status;
+    }
+
+    const size_t num_outputs = this->m_engine->get_num_outputs();
+    for (int i = 0; i < count; ++i) {
+      this->m_outputs.clear();
+      for (size_t k = 0; k < num_outputs; ++k) {
+        this->m_outputs.push_back(
+            this->m_engine->get_output(k, batch_size, i));
+      }
+      results[first + i].result =
+          inference::InferenceResult::from_outputs(this->m_outputs);
+    }
+    return status;
+  }
+
+private:
+  std::shared_ptr<inference::TFLiteInferenceEngine> m_engine;
+  preprocess::Preprocessor m_preprocessor;
+  CascadeOptions m_options;
+  std::vector<inference::OutputTensor> m_outputs;
+  size_t m_num_invocations = 0;
+  bool m_spec_matches = true;
+};
+} // namespace tflite::pipeline
+
+#endif // ROI_CASCADE_HPP
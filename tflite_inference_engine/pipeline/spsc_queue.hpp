@@ -0,0 +1,112 @@
+/**
+ * @file spsc_queue.hpp
+ * @details Bounded lock-free single producer single consumer ring buffer
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace tflite::pipeline {
+/**
+ * @brief Wait before retrying a full or empty queue: spin briefly, then
+ * sleep to leave the cores to the interpreter threads
+ * @param attempt Number of failed attempts
+ */
+inline void backoff(int attempt) {
+  if (attempt < 64) {
+    std::this_thread::yield();
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+template <typename T> class SPSCQueue {
+public:
+  /**
+   * @brief Create the queue
+   * @param capacity Maximum number of elements, rounded up to a power of two
+   */
+  explicit SPSCQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    this->m_mask = size - 1;
+    this->m_slots = std::make_unique<T[]>(size);
+  }
+  ~SPSCQueue() = default;
+
+  SPSCQueue(const SPSCQueue &) = delete;
+  SPSCQueue &operator=(const SPSCQueue &) = delete;
+  SPSCQueue(SPSCQueue &&) = delete;
+  SPSCQueue &operator=(SPSCQueue &&) = delete;
+
+public:
+  /**
+   * @brief Add an element, only called from the producer thread
+   * @param value Element, moved from on success only
+   * @return False if the queue is full
+   */
+  bool try_push(T &value) {
+    const size_t tail = this->m_tail.load(std::memory_order_relaxed);
+    if (tail - this->m_head.load(std::memory_order_acquire) > this->m_mask) {
+      return false;
+    }
+    this->m_slots[tail & this->m_mask] = std::move(value);
+    this->m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+public:
+  /**
+   * @brief Remove the oldest element, only called from the consumer thread
+   * @return Element, empty if the queue is empty
+   */
+  std::optional<T> try_pop() {
+    const size_t head = this->m_head.load(std::memory_order_relaxed);
+    if (head == this->m_tail.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    std::optional<T> value(std::move(this->m_slots[head & this->m_mask]));
+    this->m_head.store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+public:
+  /**
+   * @brief Get the number of elements, exact only from the producer or
+   * consumer thread
+   * @return Queue depth
+   */
+  [[nodiscard]] size_t size() const {
+    return this->m_tail.load(std::memory_order_acquire) -
+           this->m_head.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get the maximum number of elements
+   * @return Capacity
+   */
+  [[nodiscard]] size_t capacity() const { return this->m_mask + 1; }
+
+private:
+  // Producer and consumer indices on separate cache lines
+  alignas(64) std::atomic<size_t> m_head{0};
+  alignas(64) std::atomic<size_t> m_tail{0};
+  alignas(64) size_t m_mask = 0;
+  std::unique_ptr<T[]> m_slots;
+};
+} // namespace tflite::pipeline
+
+#endif // SPSC_QUEUE_HPP
@@ -0,0 +1,174 @@
+/**
+ * @file stages.hpp
+ * @details Video source and the standard stages of a detection pipeline
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef PIPELINE_STAGES_HPP
+#define PIPELINE_STAGES_HPP
+
+#include <memory>
+#include <string>
+
+#include <infer/async_infer.hpp>
+#include <log/glogging.hpp>
+#include <opencv2/opencv.hpp>
+#include <pipeline/pipeline.hpp>
+#include <postprocess/detection_decoder.hpp>
+#include <preprocess/preprocessor.hpp>
+#include <visualizer/detection_overlay.hpp>
+#include <visualizer/object_detection.hpp>
+
+namespace tflite::pipeline {
+/**
+ * @brief Pipeline source reading frames from a camera or a video file
+ */
+class VideoSource {
+public:
+  /**
+   * @brief Open a video file, e.g. a recorded clip for offline runs
+   * @param path Path to the video
+   * @param max_frames Stop after this many frames, 0 for the whole video
+   */
+  explicit VideoSource(const std::string &path, uint64_t max_frames = 0)
+      : m_capture(std::make_shared<cv::VideoCapture>(path)),
+        m_max_frames(max_frames) {
+    if (!this->m_capture->isOpened()) {
+      LOG(ERROR) << "Failed to open the video: " << path;
+    }
+  }
+
+  /**
+   * @brief Open a camera
+   * @param device Camera index
+   * @param max_frames Stop after this many frames, 0 to run until stopped
+   */
+  explicit VideoSource(int device, uint64_t max_frames = 0)
+      : m_capture(std::make_shared<cv::VideoCapture>(device)),
+        m_max_frames(max_frames) {
+    if (!this->m_capture->isOpened()) {
+      LOG(ERROR) << "Failed to open the camera: " << device;
+    }
+  }
+
+public:
+  /**
+   * @brief Check if the video could be opened
+   * @return True if frames can be read
+   */
+  [[nodiscard]] bool is_opened() const { return this->m_capture->isOpened(); }
+
+public:
+  /**
+   * @brief Read the next frame
+   * @param frame Frame to fill
+   * @return False at the end of the video
+   */
+  bool operator()(Frame &frame) {
+    if (this->m_max_frames > 0 && frame.id >= this->m_max_frames) {
+      return false;
+    }
+    return this->m_capture->read(frame.image) && !frame.image.empty();
+  }
+
+private:
+  // Shared, as the pipeline keeps a copy of the source
+  std::shared_ptr<cv::VideoCapture> m_capture;
+  uint64_t m_max_frames;
+};
+
+/**
+ * @brief Stage resizing and normalizing the image into a frame-owned input,
+ * so it overlaps with the inference of the previous frame
+ * @param preprocessor Preprocessor, used only by this stage
+ * @return Stage
+ */
+inline Pipeline::Stage
+make_preprocess_stage(std::shared_ptr<preprocess::Preprocessor> preprocessor) {
+  return [preprocessor](Frame &frame) {
+    if (preprocessor->run(frame.image, frame.input) !=
+        inference::InferenceStatus::SUCCESS) {
+      frame.input.release();
+    }
+  };
+}
+
+/**
+ * @brief Stage running the model on the preprocessed input and copying the
+ * outputs into the frame
+ * @param engine Engine with a loaded model, used only by this stage
+ * @return Stage
+ */
+inline Pipeline::Stage
+make_inference_stage(std::shared_ptr<inference::TFLiteInferenceEngine> engine) {
+  return [engine](Frame &frame) {
+    frame.result = inference::InferenceResult();
+    if (frame.input.empty()) {
+      frame.result.status = inference::InferenceStatus::INPUT_ERROR;
+      return;
+    }
+
+    inference::InferenceStatus status = engine->set_input(frame.input);
+    if (status == inference::InferenceStatus::SUCCESS) {
+      status = engine->invoke();
+    }
+    if (status != inference::InferenceStatus::SUCCESS) {
+      frame.result.status = status;
+      return;
+    }
+    frame.result = inference::InferenceResult::collect(*engine);
+  };
+}
+
+/**
+ * @brief Stage decoding SSD outputs into boxes in image coordinates
+ * @param options Score threshold, class allowlist and top-k
+ * @return Stage
+ */
+inline Pipeline::Stage make_detection_postprocess_stage(
+    const postprocess::DecoderOptions &options = {}) {
+  return [decoder = postprocess::DetectionDecoder(options)](Frame &frame) {
+    frame.detections.clear();
+    if (frame.result.status != inference::InferenceStatus::SUCCESS ||
+        frame.result.outputs.size() < 4) {
+      return;
+    }
+    decoder.decode(frame.image.size(), frame.result.output(0),
+                   frame.result.output(1), frame.result.output(2),
+                   frame.result.output(3), frame.detections);
+  };
+}
+
+/**
+ * @brief Stage running a second model on the regions of the decoded
+ * detections, batched into a few invocations per frame
+ * @param cascade Cascade with its own engine, used only by this stage
+ * @return Stage
+ */
+inline Pipeline::Stage
+make_roi_cascade_stage(std::shared_ptr<RoiCascade> cascade) {
+  return [cascade](Frame &frame) {
+    cascade->run(frame.image, frame.detections, frame.rois);
+  };
+}
+
+/**
+ * @brief Stage drawing the decoded detections into the captured image, in
+ * place, with the labels cached across frames
+ * @param options Appearance of the boxes and labels
+ * @return Stage
+ */
+inline Pipeline::Stage make_detection_overlay_stage(
+    const visualizer::DetectionOverlayOptions &options = {}) {
+  auto overlay = std::make_shared<visualizer::DetectionOverlay>(options);
+  return [overlay](Frame &frame) {
+    if (!frame.image.empty()) {
+      overlay->draw(frame.image, frame.detections);
+    }
+  };
+}
+} // namespace tflite::pipeline
+
+#endif // PIPELINE_STAGES_HPP
@@ -0,0 +1,508 @@
+/**
+ * @file tiled_detector.hpp
+ * @details Object detection on high-resolution frames split into overlapping
+ * tiles of the model input size, run in parallel across engines or as one
+ * batch, with the detections merged across tile borders
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef TILED_DETECTOR_HPP
+#define TILED_DETECTOR_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <infer/infer.hpp>
+#include <log/glogging.hpp>
+#include <metrics/stage_metrics.hpp>
+#include <opencv2/opencv.hpp>
+#include <postprocess/detection_decoder.hpp>
+#include <postprocess/nms.hpp>
+#include <preprocess/preprocessor.hpp>
+#include <trace/tracer.hpp>
+#include <visualizer/object_detection.hpp>
+
+namespace tflite::pipeline {
+/**
+ * @brief Tiling of the frame and merging of the detections
+ */
+struct TileOptions {
+  // Tile grid, 0 for as many tiles as needed to cover the frame with tiles
+  // of the model input size
+  int cols = 0;
+  int rows = 0;
+  // Fraction of a tile shared with its neighbour
+  float overlap = 0.2f;
+  // Also run the whole frame, for objects larger than a tile
+  bool full_frame = false;
+  float score_threshold = 0.5f;
+  // Detections of a class overlapping by more than this are merged
+  float merge_threshold = 0.6f;
+  postprocess::OverlapMetric merge_metric = postprocess::OverlapMetric::IOS;
+  // Run all tiles as one batch on the first engine instead of in parallel
+  // across the engines. Needs a model with a resizable batch axis.
+  bool batch = false;
+};
+
+/**
+ * @brief Cost of the last frame
+ */
+struct TileStats {
+  size_t tiles = 0;
+  size_t invocations = 0;
+  // Detections of all tiles before and after merging
+  size_t raw_detections = 0;
+  size_t detections = 0;
+  // Preprocessing, inference and decoding of all tiles
+  double tiles_ms = 0.0;
+  double merge_ms = 0.0;
+  double total_ms = 0.0;
+};
+
+class TiledDetector {
+public:
+  using DetectionOutput =
+      visualizer::ObjectDetectionVisualizer::DetectionOutput;
+
+public:
+  /**
+   * @brief Create the detector
+   * @param engines Engines with the same SSD model loaded, used only by the
+   *        detector. Tiles are spread over one thread per engine, the calling
+   *        thread runs the first engine.
+   * @param spec Preprocessing of the model input, see
+   *        PreprocessSpec::from_engine()
+   * @param options Tiling and merging
+   */
+  TiledDetector(
+      std::vector<std::shared_ptr<inference::TFLiteInferenceEngine>> engines,
+      const preprocess::PreprocessSpec &spec,
+      const TileOptions &options = TileOptions())
+      : m_input_size(spec.width, spec.height), m_options(options),
+        m_decoder(make_decoder_options(options)) {
+    for (auto &engine : engines) {
+      if (engine) {
+        this->m_workers.push_back(
+            {std::move(engine),
+             std::make_unique<preprocess::Preprocessor>(spec)});
+      }
+    }
+  }
+
+  ~TiledDetector() {
+    {
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      this->m_stopped = true;
+    }
+    this->m_start.notify_all();
+    for (auto &thread : this->m_threads) {
+      thread.join();
+    }
+  }
+
+  TiledDetector(const TiledDetector &) = delete;
+  TiledDetector &operator=(const TiledDetector &) = delete;
+  TiledDetector(TiledDetector &&) = delete;
+  TiledDetector &operator=(TiledDetector &&) = delete;
+
+public:
+  /**
+   * @brief Detect the objects of a frame
+   * @param frame 8-bit frame with the spec's number of channels
+   * @return Merged detections in frame coordinates
+   */
+  DetectionOutput run(const cv::Mat &frame) {
+    DetectionOutput detections;
+    this->run(frame, detections);
+    return detections;
+  }
+
+  /**
+   * @brief Detect the objects of a frame, reusing the storage of previous
+   * detections
+   * @param frame 8-bit frame with the spec's number of channels
+   * @param detections Merged detections in frame coordinates
+   * @return SUCCESS, or the first error of the tiles
+   */
+  inference::InferenceStatus run(const cv::Mat &frame,
+                                 DetectionOutput &detections) {
+    TFLITE_TRACE_SCOPE("tiled_frame");
+    const auto start = Clock::now();
+    detections.clear();
+    this->m_stats = TileStats();
+    if (frame.empty()) {
+      LOG(ERROR) << "Input image is empty";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+    if (this->m_workers.empty() ||
+        this->m_workers[0].engine->get_num_outputs() < 4) {
+      LOG(ERROR) << "Tiled detection needs engines with an SSD model";
+      return inference::InferenceStatus::INTERPRETER_ERROR;
+    }
+
+    this->m_tiles =
+        make_tiles(frame.size(), this->m_input_size, this->m_options);
+    this->m_tile_detections.resize(this->m_tiles.size());
+    this->m_tile_status.assign(this->m_tiles.size(),
+                               inference::InferenceStatus::SUCCESS);
+    if (this->m_options.batch) {
+      this->run_batch(frame);
+    } else {
+      this->run_parallel(frame);
+    }
+    const auto tiles_end = Clock::now();
+
+    inference::InferenceStatus status = inference::InferenceStatus::SUCCESS;
+    for (inference::InferenceStatus tile_status : this->m_tile_status) {
+      if (tile_status != inference::InferenceStatus::SUCCESS) {
+        status = tile_status;
+        break;
+      }
+    }
+    this->merge(detections);
+    const auto end = Clock::now();
+
+    this->m_stats.tiles = this->m_tiles.size();
+    this->m_stats.detections = detections.boxes.size();
+    this->m_stats.tiles_ms = to_ms(tiles_end - start);
+    this->m_stats.merge_ms = to_ms(end - tiles_end);
+    this->m_stats.total_ms = to_ms(end - start);
+    metrics::StageMetrics::get().tiled_frame.record(end - start);
+    return status;
+  }
+
+public:
+  /**
+   * @brief Get the cost of the last frame, to trade resolution against
+   * latency
+   * @return Statistics of the last frame
+   */
+  [[nodiscard]] const TileStats &get_last_stats() const {
+    return this->m_stats;
+  }
+
+  /**
+   * @brief Split a frame into overlapping tiles of equal size, the last row
+   * and column aligned with the frame border
+   * @param frame Frame size
+   * @param input Model input size, the tile size when no grid is set
+   * @param options Grid, overlap and full frame option
+   * @return Tiles in frame coordinates, row by row
+   */
+  [[nodiscard]] static std::vector<cv::Rect>
+  make_tiles(const cv::Size &frame, const cv::Size &input,
+             const TileOptions &options) {
+    std::vector<cv::Rect> tiles;
+    if (frame.empty() || input.empty()) {
+      return tiles;
+    }
+    const float overlap = std::clamp(options.overlap, 0.0f, 0.9f);
+    std::vector<int> xs;
+    std::vector<int> ys;
+    const int width =
+        split(frame.width, options.cols, input.width, overlap, xs);
+    const int height =
+        split(frame.height, options.rows, input.height, overlap, ys);
+    for (int y : ys) {
+      for (int x : xs) {
+        tiles.emplace_back(x, y, width, height);
+      }
+    }
+    if (options.full_frame && tiles.size() > 1) {
+      tiles.emplace_back(0, 0, frame.width, frame.height);
+    }
+    return tiles;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Worker {
+    std::shared_ptr<inference::TFLiteInferenceEngine> engine;
+    std::unique_ptr<preprocess::Preprocessor> preprocessor;
+  };
+
+private:
+  /**
+   * @brief Get the offsets of the tiles along one axis
+   * @param length Frame length
+   * @param count Number of tiles, 0 to derive it from the tile length
+   * @param tile Tile length when count is 0
+   * @param overlap Minimum fraction of a tile shared with its neighbour
+   * @param offsets Offsets of the tiles
+   * @return Tile length
+   */
+  static int split(int length, int count, int tile, float overlap,
+                   std::vector<int> &offsets) {
+    if (count <= 0) {
+      tile = std::min(tile, length);
+      const float step = static_cast<float>(tile) * (1.0f - overlap);
+      count = tile == length ? 1
+                             : 1 + static_cast<int>(std::ceil(
+                                       static_cast<float>(length - tile) /
+                                       step));
+    } else {
+      tile = std::min(length, static_cast<int>(std::ceil(
+                                  static_cast<float>(length) /
+                                  (static_cast<float>(count) -
+                                   static_cast<float>(count - 1) * overlap))));
+    }
+    for (int i = 0; i < count; ++i) {
+      offsets.push_back(count == 1 ? 0
+                                   : static_cast<int>(std::lround(
+                                         static_cast<double>(i) *
+                                         (length - tile) / (count - 1))));
+    }
+    return tile;
+  }
+
+  static postprocess::DecoderOptions
+  make_decoder_options(const TileOptions &options) {
+    postprocess::DecoderOptions decoder_options;
+    decoder_options.score_threshold = options.score_threshold;
+    return decoder_options;
+  }
+
+  static double to_ms(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+
+private:
+  /**
+   * @brief Run the tiles on all engines, the calling thread taking part
+   */
+  void run_parallel(const cv::Mat &frame) {
+    // Threads are started on the first frame
+    for (size_t i = this->m_threads.size() + 1; i < this->m_workers.size();
+         ++i) {
+      this->m_threads.emplace_back(&TiledDetector::run_worker, this, i);
+    }
+
+    size_t generation;
+    {
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      this->m_frame = &frame;
+      this->m_frame_id = trace::Tracer::current_frame();
+      this->m_next_tile = 0;
+      this->m_remaining = this->m_tiles.size();
+      generation = ++this->m_generation;
+    }
+    this->m_start.notify_all();
+
+    this->process_tiles(0, generation);
+
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    this->m_done.wait(lock, [this] { return this->m_remaining == 0; });
+    this->m_stats.invocations = this->m_tiles.size();
+  }
+
+  /**
+   * @brief Thread of one engine waiting for the tiles of each frame
+   * @param index Index of the engine
+   */
+  void run_worker(size_t index) {
+    TFLITE_TRACE_THREAD_NAME("tile_worker");
+    size_t generation = 0;
+    while (true) {
+      int64_t frame_id;
+      {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        this->m_start.wait(lock, [this, generation] {
+          return this->m_stopped || this->m_generation != generation;
+        });
+        if (this->m_stopped) {
+          return;
+        }
+        generation = this->m_generation;
+        frame_id = this->m_frame_id;
+      }
+      TFLITE_TRACE_FRAME(frame_id);
+      this->process_tiles(index, generation);
+    }
+  }
+
+  /**
+   * @brief Take tiles of the frame until none is left
+   * @param index Index of the engine
+   * @param generation Frame the caller woke up for, a late thread does not
+   *        take tiles of the next frame
+   */
+  void process_tiles(size_t index, size_t generation) {
+    Worker &worker = this->m_workers[index];
+    while (true) {
+      size_t tile;
+      {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        if (generation != this->m_generation ||
+            this->m_next_tile >= this->m_tiles.size()) {
+          return;
+        }
+        tile = this->m_next_tile++;
+      }
+
+      this->m_tile_status[tile] = this->process_tile(
+          worker, *this->m_frame, this->m_tiles[tile],
+          this->m_tile_detections[tile]);
+
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      if (--this->m_remaining == 0) {
+        this->m_done.notify_one();
+      }
+    }
+  }
+
+  /**
+   * @brief Detect the objects of one tile
+   */
+  inference::InferenceStatus process_tile(Worker &worker, const cv::Mat &frame,
+                                          const cv::Rect &tile,
+                                          DetectionOutput &detections) const {
+    TFLITE_TRACE_SCOPE("tile");
+    cv::Mat input = worker.engine->input_view();
+    inference::InferenceStatus status =
+        worker.preprocessor->run(frame(tile), input);
+    if (status == inference::InferenceStatus::SUCCESS) {
+      status = worker.engine->invoke();
+    }
+    if (status != inference::InferenceStatus::SUCCESS) {
+      detections.clear();
+      return status;
+    }
+    this->decode(tile, worker.engine->get_output(0),
+                 worker.engine->get_output(1), worker.engine->get_output(2),
+                 worker.engine->get_output(3), detections);
+    return status;
+  }
+
+  /**
+   * @brief Run all tiles as one batch on the first engine
+   */
+  void run_batch(const cv::Mat &frame) {
+    Worker &worker = this->m_workers[0];
+    const int batch_size = static_cast<int>(this->m_tiles.size());
+    inference::InferenceStatus status = inference::InferenceStatus::SUCCESS;
+    for (int i = 0;
+         i < batch_size && status == inference::InferenceStatus::SUCCESS;
+         ++i) {
+      cv::Mat slot = worker.engine->input_view(batch_size, i);
+      status = slot.empty()
+                   ? inference::InferenceStatus::INTERPRETER_ERROR
+                   : worker.preprocessor->run(frame(this->m_tiles[i]), slot);
+    }
+    if (status == inference::InferenceStatus::SUCCESS) {
+      this->m_stats.invocations = 1;
+      status = worker.engine->invoke_batch(batch_size);
+    }
+
+    for (int i = 0; i < batch_size; ++i) {
+      this->m_tile_status[i] = status;
+      if (status != inference::InferenceStatus::SUCCESS) {
+        this->m_tile_detections[i].clear();
+        continue;
+      }
+      this->decode(this->m_tiles[i],
+                   worker.engine->get_output(0, batch_size, i),
+                   worker.engine->get_output(1, batch_size, i),
+                   worker.engine->get_output(2, batch_size, i),
+                   worker.engine->get_output(3, batch_size, i),
+                   this->m_tile_detections[i]);
+    }
+  }
+
+private:
+  /**
+   * @brief Decode the SSD outputs of a tile into frame coordinates
+   */
+  void decode(const cv::Rect &tile, const inference::OutputTensor &locations,
+              const inference::OutputTensor &classes,
+              const inference::OutputTensor &scores,
+              const inference::OutputTensor &num_detections,
+              DetectionOutput &detections) const {
+    if (locations.empty() || classes.empty() || scores.empty() ||
+        num_detections.empty()) {
+      detections.clear();
+      return;
+    }
+    this->m_decoder.decode(tile, locations, classes, scores, num_detections,
+                           detections);
+    for (cv::Rect &box : detections.boxes) {
+      box &= tile;
+    }
+  }
+
+  /**
+   * @brief Gather the detections of all tiles and merge the duplicates of
+   * objects seen by several tiles
+   */
+  void merge(DetectionOutput &detections) {
+    TFLITE_TRACE_SCOPE("merge_tiles");
+    DetectionOutput &raw = this->m_raw;
+    raw.clear();
+    for (const DetectionOutput &tile : this->m_tile_detections) {
+      raw.boxes.insert(raw.boxes.end(), tile.boxes.begin(), tile.boxes.end());
+      raw.classes.insert(raw.classes.end(), tile.classes.begin(),
+                         tile.classes.end());
+      raw.scores.insert(raw.scores.end(), tile.scores.begin(),
+                        tile.scores.end());
+    }
+    this->m_stats.raw_detections = raw.boxes.size();
+
+    this->m_candidates.clear();
+    for (size_t i = 0; i < raw.boxes.size(); ++i) {
+      const cv::Rect &box = raw.boxes[i];
+      this->m_candidates.push_back(
+          static_cast<float>(box.x), static_cast<float>(box.y),
+          static_cast<float>(box.br().x), static_cast<float>(box.br().y),
+          raw.scores[i], raw.classes[i]);
+    }
+    postprocess::NmsOptions options;
+    options.threshold = this->m_options.merge_threshold;
+    options.metric = this->m_options.merge_metric;
+    options.score_threshold = this->m_options.score_threshold;
+    this->m_nms.run(this->m_candidates, options, this->m_keep);
+
+    for (uint32_t index : this->m_keep) {
+      detections.boxes.push_back(raw.boxes[index]);
+      detections.classes.push_back(raw.classes[index]);
+      detections.scores.push_back(raw.scores[index]);
+    }
+  }
+
+private:
+  const cv::Size m_input_size;
+  const TileOptions m_options;
+  const postprocess::DetectionDecoder m_decoder;
+  std::vector<Worker> m_workers;
+  std::vector<std::thread> m_threads;
+
+  // Current frame, shared with the worker threads
+  std::vector<cv::Rect> m_tiles;
+  std::vector<DetectionOutput> m_tile_detections;
+  std::vector<inference::InferenceStatus> m_tile_status;
+  DetectionOutput m_raw;
+  postprocess::BoxStore m_candidates;
+  postprocess::NonMaxSuppression m_nms;
+  std::vector<uint32_t> m_keep;
+  TileStats m_stats;
+
+  std::mutex m_mutex;
+  std::condition_variable m_start;
+  std::condition_variable m_done;
+  const cv::Mat *m_frame = nullptr;
+  int64_t m_frame_id = -1;
+  size_t m_generation = 0;
+  size_t m_next_tile = 0;
+  size_t m_remaining = 0;
+  bool m_stopped = false;
+};
+} // namespace tflite::pipeline
+
+#endif // TILED_DETECTOR_HPP
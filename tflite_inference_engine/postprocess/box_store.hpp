@@ -0,0 +1,109 @@
+/**
+ * @file box_store.hpp
+ * @details Structure-of-arrays storage of candidate boxes, one contiguous
+ * array per coordinate so overlaps are computed several boxes at a time
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef BOX_STORE_HPP
+#define BOX_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tflite::postprocess {
+/**
+ * @brief Candidate boxes as corners, score and class. Capacity is kept by
+ * clear(), so a store reused across frames does not allocate.
+ */
+class BoxStore {
+public:
+  BoxStore() = default;
+
+  /**
+   * @brief Create a store with room for a number of boxes
+   * @param capacity Number of boxes
+   */
+  explicit BoxStore(size_t capacity) { this->reserve(capacity); }
+
+public:
+  /**
+   * @brief Add a box given by its corners
+   * @param x1 Left
+   * @param y1 Top
+   * @param x2 Right
+   * @param y2 Bottom
+   * @param score Score
+   * @param class_id Class
+   */
+  void push_back(float x1, float y1, float x2, float y2, float score,
+                 int class_id) {
+    this->m_x1.push_back(x1);
+    this->m_y1.push_back(y1);
+    this->m_x2.push_back(x2);
+    this->m_y2.push_back(y2);
+    this->m_scores.push_back(score);
+    this->m_classes.push_back(class_id);
+  }
+
+  /**
+   * @brief Add a box given by its center and size, as exported by YOLO-style
+   * models
+   * @param cx Center x
+   * @param cy Center y
+   * @param width Width
+   * @param height Height
+   * @param score Score
+   * @param class_id Class
+   */
+  void push_back_center(float cx, float cy, float width, float height,
+                        float score, int class_id) {
+    this->push_back(cx - 0.5f * width, cy - 0.5f * height, cx + 0.5f * width,
+                    cy + 0.5f * height, score, class_id);
+  }
+
+  void reserve(size_t capacity) {
+    this->m_x1.reserve(capacity);
+    this->m_y1.reserve(capacity);
+    this->m_x2.reserve(capacity);
+    this->m_y2.reserve(capacity);
+    this->m_scores.reserve(capacity);
+    this->m_classes.reserve(capacity);
+  }
+
+  void clear() {
+    this->m_x1.clear();
+    this->m_y1.clear();
+    this->m_x2.clear();
+    this->m_y2.clear();
+    this->m_scores.clear();
+    this->m_classes.clear();
+  }
+
+public:
+  [[nodiscard]] size_t size() const { return this->m_scores.size(); }
+  [[nodiscard]] bool empty() const { return this->m_scores.empty(); }
+
+  [[nodiscard]] const float *x1() const { return this->m_x1.data(); }
+  [[nodiscard]] const float *y1() const { return this->m_y1.data(); }
+  [[nodiscard]] const float *x2() const { return this->m_x2.data(); }
+  [[nodiscard]] const float *y2() const { return this->m_y2.data(); }
+  [[nodiscard]] const float *scores() const { return this->m_scores.data(); }
+  [[nodiscard]] const int32_t *classes() const {
+    return this->m_classes.data();
+  }
+
+private:
+  std::vector<float> m_x1;
+  std::vector<float> m_y1;
+  std::vector<float> m_x2;
+  std::vector<float> m_y2;
+  std::vector<float> m_scores;
+  std::vector<int32_t> m_classes;
+};
+} // namespace tflite::postprocess
+
+#endif // BOX_STORE_HPP
@@ -0,0 +1,235 @@
+/**
+ * @file detection_decoder.hpp
+ * @details Decoding of SSD output tensors into a caller-owned detection
+ * buffer, without allocation once the buffer has grown to its steady size
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef DETECTION_DECODER_HPP
+#define DETECTION_DECODER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <infer/output_tensor.hpp>
+#include <metrics/stage_metrics.hpp>
+#include <opencv2/core.hpp>
+#include <trace/tracer.hpp>
+#include <utils/scoped_timer.hpp>
+
+namespace tflite::postprocess {
+/**
+ * @brief Detections as one array per field. clear() keeps the capacity, so a
+ * buffer reused across frames stops allocating after the first ones.
+ */
+struct Detections {
+  std::vector<cv::Rect> boxes;
+  std::vector<int> classes;
+  std::vector<float> scores;
+
+  void clear() {
+    this->boxes.clear();
+    this->classes.clear();
+    this->scores.clear();
+  }
+
+  void reserve(size_t capacity) {
+    this->boxes.reserve(capacity);
+    this->classes.reserve(capacity);
+    this->scores.reserve(capacity);
+  }
+
+  [[nodiscard]] size_t size() const { return this->scores.size(); }
+  [[nodiscard]] bool empty() const { return this->scores.empty(); }
+};
+
+/**
+ * @brief Filtering applied while decoding
+ */
+struct DecoderOptions {
+  // Only detections scoring above this are kept
+  float score_threshold = 0.5f;
+  // Classes decoded, all if empty
+  std::vector<int> classes;
+  // Only the top_k highest scored detections are kept, by decreasing score,
+  // 0 for all in model order
+  size_t top_k = 0;
+};
+
+/**
+ * @brief Decoder of the four outputs of the TFLite_Detection_PostProcess op:
+ * boxes as normalized [ymin, xmin, ymax, xmax], classes, scores and the
+ * number of detections. Decoding is const, one decoder can be shared by
+ * several threads.
+ */
+class DetectionDecoder {
+public:
+  /**
+   * @brief Create the decoder
+   * @param options Score threshold, class allowlist and top-k
+   */
+  explicit DetectionDecoder(const DecoderOptions &options = DecoderOptions())
+      : m_options(options) {
+    for (int class_id : options.classes) {
+      if (class_id < 0) {
+        continue;
+      }
+      if (static_cast<size_t>(class_id) >= this->m_allowed.size()) {
+        this->m_allowed.resize(class_id + 1, 0);
+      }
+      this->m_allowed[class_id] = 1;
+    }
+  }
+
+public:
+  /**
+   * @brief Decode the detections into an image region
+   * @tparam Tensor Pointer or view with operator[] returning the real value,
+   *         e.g. const float * or inference::OutputTensor. Quantized scores
+   *         are filtered in the tensor domain, only the kept ones are
+   *         dequantized.
+   * @param region Region the model saw, e.g. the whole image or a tile
+   * @param locations Boxes
+   * @param classes Classes
+   * @param scores Scores
+   * @param num_detections Number of detections
+   * @param detections Cleared and filled with the boxes in the coordinates
+   *        of the region's image
+   * @return Number of decoded detections
+   */
+  template <typename Tensor>
+  size_t decode(const cv::Rect &region, const Tensor &locations,
+                const Tensor &classes, const Tensor &scores,
+                const Tensor &num_detections, Detections &detections) const {
+    TFLITE_TRACE_SCOPE("decode_detections");
+    utils::timer::ScopedTimer timer(
+        metrics::StageMetrics::get().detection_postprocess);
+    detections.clear();
+    const int count = static_cast<int>(num_detections[0]);
+    const float width = static_cast<float>(region.width);
+    const float height = static_cast<float>(region.height);
+    const size_t top_k = this->m_options.top_k;
+    const float threshold =
+        to_tensor_domain(scores, this->m_options.score_threshold);
+
+    for (int i = 0; i < count; ++i) {
+      if (!is_above(scores, i, threshold)) {
+        continue;
+      }
+      const float score = scores[i];
+      const int class_id = static_cast<int>(classes[i]);
+      if (!this->is_allowed(class_id)) {
+        continue;
+      }
+      // Kept sorted by decreasing score, the lowest one is replaced
+      if (top_k > 0 && detections.size() == top_k &&
+          score <= detections.scores.back()) {
+        continue;
+      }
+
+      const cv::Point top_left(
+          region.x + static_cast<int>(locations[4 * i + 1] * width),
+          region.y + static_cast<int>(locations[4 * i + 0] * height));
+      const cv::Point bottom_right(
+          region.x + static_cast<int>(locations[4 * i + 3] * width),
+          region.y + static_cast<int>(locations[4 * i + 2] * height));
+      const cv::Rect box(top_left, bottom_right);
+
+      if (top_k == 0) {
+        detections.boxes.push_back(box);
+        detections.classes.push_back(class_id);
+        detections.scores.push_back(score);
+      } else {
+        insert_sorted(detections, top_k, box, class_id, score);
+      }
+    }
+    return detections.size();
+  }
+
+  /**
+   * @brief Decode the detections into an image
+   * @param size Image size
+   */
+  template <typename Tensor>
+  size_t decode(const cv::Size &size, const Tensor &locations,
+                const Tensor &classes, const Tensor &scores,
+                const Tensor &num_detections, Detections &detections) const {
+    return this->decode(cv::Rect(cv::Point(0, 0), size), locations, classes,
+                        scores, num_detections, detections);
+  }
+
+public:
+  [[nodiscard]] const DecoderOptions &get_options() const {
+    return this->m_options;
+  }
+
+private:
+  /**
+   * @brief Convert the score threshold into the domain of the scores
+   */
+  template <typename Tensor>
+  static float to_tensor_domain(const Tensor &, float threshold) {
+    return threshold;
+  }
+
+  static float to_tensor_domain(const inference::OutputTensor &scores,
+                                float threshold) {
+    return scores.quantize(threshold);
+  }
+
+  /**
+   * @brief Compare a score with a threshold from to_tensor_domain()
+   */
+  template <typename Tensor>
+  static bool is_above(const Tensor &scores, int index, float threshold) {
+    return scores[index] > threshold;
+  }
+
+  static bool is_above(const inference::OutputTensor &scores, int index,
+                       float threshold) {
+    return scores.greater(static_cast<size_t>(index), threshold);
+  }
+
+  [[nodiscard]] bool is_allowed(int class_id) const {
+    if (this->m_options.classes.empty()) {
+      return true;
+    }
+    return class_id >= 0 &&
+           static_cast<size_t>(class_id) < this->m_allowed.size() &&
+           this->m_allowed[class_id] != 0;
+  }
+
+  /**
+   * @brief Insert a detection into detections sorted by decreasing score,
+   * dropping the lowest one when top_k are held. The size never exceeds
+   * top_k, so the capacity stops growing.
+   */
+  static void insert_sorted(Detections &detections, size_t top_k,
+                            const cv::Rect &box, int class_id, float score) {
+    if (detections.size() == top_k) {
+      detections.boxes.pop_back();
+      detections.classes.pop_back();
+      detections.scores.pop_back();
+    }
+    const size_t position = static_cast<size_t>(
+        std::upper_bound(detections.scores.begin(), detections.scores.end(),
+                         score, std::greater<float>()) -
+        detections.scores.begin());
+    detections.boxes.insert(detections.boxes.begin() + position, box);
+    detections.classes.insert(detections.classes.begin() + position,
+                              class_id);
+    detections.scores.insert(detections.scores.begin() + position, score);
+  }
+
+private:
+  DecoderOptions m_options;
+  // Lookup table of the allowed classes
+  std::vector<uint8_t> m_allowed;
+};
+} // namespace tflite::postprocess
+
+#endif // DETECTION_DECODER_HPP
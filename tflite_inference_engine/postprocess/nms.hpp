@@ -0,0 +1,468 @@
+/**
+ * @file nms.hpp
+ * @details Class-aware non-maximum suppression of detection boxes, with the
+ * overlaps of each kept box computed against several candidates at a time
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef NMS_HPP
+#define NMS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <postprocess/box_store.hpp>
+#include <utils/cpu_features.hpp>
+
+namespace tflite::postprocess {
+/**
+ * @brief Overlap of two boxes compared against the suppression threshold
+ */
+enum class OverlapMetric {
+  // Intersection over union
+  IOU,
+  // Intersection over the smaller box, also suppresses boxes cut by a tile
+  // border that lie inside the full box
+  IOS
+};
+
+/**
+ * @brief Compute the overlap of two boxes
+ * @param a First box
+ * @param b Second box
+ * @param metric Overlap metric
+ * @return Overlap in [0, 1]
+ */
+inline float overlap(const cv::Rect &a, const cv::Rect &b,
+                     OverlapMetric metric = OverlapMetric::IOU) {
+  const float intersection = static_cast<float>((a & b).area());
+  if (intersection <= 0.0f) {
+    return 0.0f;
+  }
+  const float area_a = static_cast<float>(a.area());
+  const float area_b = static_cast<float>(b.area());
+  const float denominator = metric == OverlapMetric::IOU
+                                ? area_a + area_b - intersection
+                                : std::min(area_a, area_b);
+  return denominator > 0.0f ? intersection / denominator : 0.0f;
+}
+
+/**
+ * @brief Selection of the candidates and suppression
+ */
+struct NmsOptions {
+  // Boxes overlapping a higher scored box by more than this are suppressed
+  float threshold = 0.5f;
+  OverlapMetric metric = OverlapMetric::IOU;
+  // Candidates below this score are dropped before the suppression
+  float score_threshold = 0.0f;
+  // Only the top_k highest scored candidates are kept for the suppression,
+  // 0 for all
+  size_t top_k = 0;
+  // Maximum number of kept boxes, 0 for no limit
+  size_t max_detections = 0;
+  // Only boxes of the same class suppress each other
+  bool class_aware = true;
+};
+
+namespace detail {
+/**
+ * @brief Sorted candidates, one array per coordinate
+ */
+struct Candidates {
+  const float *x1;
+  const float *y1;
+  const float *x2;
+  const float *y2;
+  const float *areas;
+};
+
+// Box j is suppressed by box i when
+//   intersection > threshold * (area_i + area_j - intersection)  for IoU
+//   intersection > threshold * min(area_i, area_j)               for IoS
+// which avoids the division. All kernels evaluate the same expression in the
+// same order, so they keep the same boxes.
+
+/**
+ * @brief Mark the candidates [begin, end) overlapping candidate i
+ */
+template <bool IOS>
+inline void suppress_scalar(const Candidates &boxes, size_t i, size_t begin,
+                            size_t end, float threshold, int32_t *suppressed) {
+  const float x1 = boxes.x1[i];
+  const float y1 = boxes.y1[i];
+  const float x2 = boxes.x2[i];
+  const float y2 = boxes.y2[i];
+  const float area = boxes.areas[i];
+  for (size_t j = begin; j < end; ++j) {
+    const float width =
+        std::max(0.0f, std::min(x2, boxes.x2[j]) - std::max(x1, boxes.x1[j]));
+    const float height =
+        std::max(0.0f, std::min(y2, boxes.y2[j]) - std::max(y1, boxes.y1[j]));
+    const float intersection = width * height;
+    const float bound =
+        IOS ? threshold * std::min(area, boxes.areas[j])
+            : threshold * ((area + boxes.areas[j]) - intersection);
+    suppressed[j] |= intersection > bound ? -1 : 0;
+  }
+}
+
+#if TFLITE_HAS_X86_DISPATCH
+template <bool IOS>
+TFLITE_TARGET_SSE41 inline void
+suppress_sse41(const Candidates &boxes, size_t i, size_t begin, size_t end,
+               float threshold, int32_t *suppressed) {
+  const __m128 x1 = _mm_set1_ps(boxes.x1[i]);
+  const __m128 y1 = _mm_set1_ps(boxes.y1[i]);
+  const __m128 x2 = _mm_set1_ps(boxes.x2[i]);
+  const __m128 y2 = _mm_set1_ps(boxes.y2[i]);
+  const __m128 area = _mm_set1_ps(boxes.areas[i]);
+  const __m128 t = _mm_set1_ps(threshold);
+  const __m128 zero = _mm_setzero_ps();
+
+  size_t j = begin;
+  for (; j + 4 <= end; j += 4) {
+    const __m128 width = _mm_max_ps(
+        zero, _mm_sub_ps(_mm_min_ps(x2, _mm_loadu_ps(boxes.x2 + j)),
+                         _mm_max_ps(x1, _mm_loadu_ps(boxes.x1 + j))));
+    const __m128 height = _mm_max_ps(
+        zero, _mm_sub_ps(_mm_min_ps(y2, _mm_loadu_ps(boxes.y2 + j)),
+                         _mm_max_ps(y1, _mm_loadu_ps(boxes.y1 + j))));
+    const __m128 intersection = _mm_mul_ps(width, height);
+    const __m128 areas = _mm_loadu_ps(boxes.areas + j);
+    const __m128 bound =
+        IOS ? _mm_mul_ps(t, _mm_min_ps(area, areas))
+            : _mm_mul_ps(t, _mm_sub_ps(_mm_add_ps(area, areas), intersection));
+    const __m128 mask = _mm_cmpgt_ps(intersection, bound);
+    __m128i *flags = reinterpret_cast<__m128i *>(suppressed + j);
+    _mm_storeu_si128(flags, _mm_or_si128(_mm_loadu_si128(flags),
+                                         _mm_castps_si128(mask)));
+  }
+  suppress_scalar<IOS>(boxes, i, j, end, threshold, suppressed);
+}
+
+template <bool IOS>
+TFLITE_TARGET_AVX2 inline void
+suppress_avx2(const Candidates &boxes, size_t i, size_t begin, size_t end,
+              float threshold, int32_t *suppressed) {
+  const __m256 x1 = _mm256_set1_ps(boxes.x1[i]);
+  const __m256 y1 = _mm256_set1_ps(boxes.y1[i]);
+  const __m256 x2 = _mm256_set1_ps(boxes.x2[i]);
+  const __m256 y2 = _mm256_set1_ps(boxes.y2[i]);
+  const __m256 area = _mm256_set1_ps(boxes.areas[i]);
+  const __m256 t = _mm256_set1_ps(threshold);
+  const __m256 zero = _mm256_setzero_ps();
+
+  size_t j = begin;
+  for (; j + 8 <= end; j += 8) {
+    const __m256 width = _mm256_max_ps(
+        zero, _mm256_sub_ps(_mm256_min_ps(x2, _mm256_loadu_ps(boxes.x2 + j)),
+                            _mm256_max_ps(x1, _mm256_loadu_ps(boxes.x1 + j))));
+    const __m256 height = _mm256_max_ps(
+        zero, _mm256_sub_ps(_mm256_min_ps(y2, _mm256_loadu_ps(boxes.y2 + j)),
+                            _mm256_max_ps(y1, _mm256_loadu_ps(boxes.y1 + j))));
+    const __m256 intersection = _mm256_mul_ps(width, height);
+    const __m256 areas = _mm256_loadu_ps(boxes.areas + j);
+    const __m256 bound =
+        IOS ? _mm256_mul_ps(t, _mm256_min_ps(area, areas))
+            : _mm256_mul_ps(
+                  t, _mm256_sub_ps(_mm256_add_ps(area, areas), intersection));
+    const __m256 mask = _mm256_cmp_ps(intersection, bound, _CMP_GT_OQ);
+    __m256i *flags = reinterpret_cast<__m256i *>(suppressed + j);
+    _mm256_storeu_si256(flags,
+                        _mm256_or_si256(_mm256_loadu_si256(flags),
+                                        _mm256_castps_si256(mask)));
+  }
+  suppress_scalar<IOS>(boxes, i, j, end, threshold, suppressed);
+}
+#endif
+
+/**
+ * @brief Mark the candidates [begin, end) overlapping candidate i with the
+ * kernel of the SIMD level
+ */
+template <bool IOS>
+inline void suppress(utils::cpu::SimdLevel level, const Candidates &boxes,
+                     size_t i, size_t begin, size_t end, float threshold,
+                     int32_t *suppressed) {
+#if TFLITE_HAS_X86_DISPATCH
+  if (level == utils::cpu::SimdLevel::AVX2) {
+    suppress_avx2<IOS>(boxes, i, begin, end, threshold, suppressed);
+    return;
+  }
+  if (level == utils::cpu::SimdLevel::SSE41) {
+    suppress_sse41<IOS>(boxes, i, begin, end, threshold, suppressed);
+    return;
+  }
+#endif
+  static_cast<void>(level);
+  suppress_scalar<IOS>(boxes, i, begin, end, threshold, suppressed);
+}
+} // namespace detail
+
+/**
+ * @brief Greedy non-maximum suppression on structure-of-arrays boxes. The
+ * candidates are preselected by score, sorted by class and score and copied
+ * into contiguous arrays; each kept box is then compared against the
+ * remaining candidates of its class with the widest SIMD kernel of the CPU.
+ * Buffers are reused, so after the first calls no allocation happens.
+ * Not thread-safe, use one instance per thread.
+ */
+class NonMaxSuppression {
+public:
+  NonMaxSuppression() : m_simd_level(utils::cpu::detect_simd_level()) {}
+  ~NonMaxSuppression() = default;
+
+  NonMaxSuppression(const NonMaxSuppression &) = delete;
+  NonMaxSuppression &operator=(const NonMaxSuppression &) = delete;
+  NonMaxSuppression(NonMaxSuppression &&) = delete;
+  NonMaxSuppression &operator=(NonMaxSuppression &&) = delete;
+
+public:
+  /**
+   * @brief Suppress the overlapping boxes of a store
+   * @param boxes Candidate boxes
+   * @param options Selection and suppression options
+   * @param keep Indices of the kept boxes into the store, by decreasing score
+   */
+  void run(const BoxStore &boxes, const NmsOptions &options,
+           std::vector<uint32_t> &keep) {
+    keep.clear();
+    this->select(boxes, options);
+    const size_t count = this->m_order.size();
+    if (count == 0) {
+      return;
+    }
+    this->gather(boxes, options);
+
+    const detail::Candidates candidates{
+        this->m_x1.data(), this->m_y1.data(), this->m_x2.data(),
+        this->m_y2.data(), this->m_areas.data()};
+    int32_t *suppressed = this->m_suppressed.data();
+    const size_t max_detections =
+        options.max_detections > 0 ? options.max_detections : count;
+
+    for (size_t segment = 0; segment + 1 < this->m_segments.size();
+         ++segment) {
+      const size_t end = this->m_segments[segment + 1];
+      for (size_t i = this->m_segments[segment]; i < end; ++i) {
+        if (suppressed[i] != 0) {
+          continue;
+        }
+        keep.push_back(this->m_order[i]);
+        // Classes are kept in full and cut after sorting by score
+        if (!options.class_aware && keep.size() == max_detections) {
+          break;
+        }
+        if (options.metric == OverlapMetric::IOS) {
+          detail::suppress<true>(this->m_simd_level, candidates, i, i + 1,
+                                 end, options.threshold, suppressed);
+        } else {
+          detail::suppress<false>(this->m_simd_level, candidates, i, i + 1,
+                                  end, options.threshold, suppressed);
+        }
+      }
+    }
+
+    // Classes were processed one after the other
+    if (options.class_aware) {
+      const float *scores = boxes.scores();
+      std::sort(keep.begin(), keep.end(), [scores](uint32_t a, uint32_t b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+      });
+    }
+    if (keep.size() > max_detections) {
+      keep.resize(max_detections);
+    }
+  }
+
+  /**
+   * @brief Suppress the overlapping boxes of each image of a batch
+   * @param batch Candidate boxes of each image
+   * @param options Selection and suppression options
+   * @param keep Indices of the kept boxes of each image
+   */
+  void run_batch(const std::vector<BoxStore> &batch,
+                 const NmsOptions &options,
+                 std::vector<std::vector<uint32_t>> &keep) {
+    keep.resize(batch.size());
+    for (size_t b = 0; b < batch.size(); ++b) {
+      this->run(batch[b], options, keep[b]);
+    }
+  }
+
+public:
+  /**
+   * @brief Set the instruction set of the overlap kernel, e.g. to compare
+   * against the scalar kernel
+   * @param level SIMD level, limited to the ones the CPU supports
+   */
+  void set_simd_level(utils::cpu::SimdLevel level) {
+    this->m_simd_level = utils::cpu::clamp_simd_level(level);
+  }
+
+  [[nodiscard]] utils::cpu::SimdLevel get_simd_level() const {
+    return this->m_simd_level;
+  }
+
+private:
+  /**
+   * @brief Drop the candidates below the score threshold, keep the top_k
+   * highest scored ones and sort them by class and decreasing score
+   */
+  void select(const BoxStore &boxes, const NmsOptions &options) {
+    const float *scores = boxes.scores();
+    const int32_t *classes = boxes.classes();
+    this->m_keys.clear();
+    for (uint32_t i = 0; i < boxes.size(); ++i) {
+      if (scores[i] >= options.score_threshold) {
+        this->m_keys.push_back(
+            {options.class_aware ? class_key(classes[i]) : 0u,
+             score_key(scores[i]), i});
+      }
+    }
+
+    if (options.top_k > 0 && this->m_keys.size() > options.top_k) {
+      const auto by_score = [](const SortKey &a, const SortKey &b) {
+        return a.score < b.score || (a.score == b.score && a.index < b.index);
+      };
+      std::nth_element(this->m_keys.begin(),
+                       this->m_keys.begin() + options.top_k,
+                       this->m_keys.end(), by_score);
+      this->m_keys.resize(options.top_k);
+    }
+
+    // Integer keys compare faster than scores looked up through indices
+    std::sort(this->m_keys.begin(), this->m_keys.end());
+    this->m_order.resize(this->m_keys.size());
+    for (size_t k = 0; k < this->m_keys.size(); ++k) {
+      this->m_order[k] = this->m_keys[k].index;
+    }
+  }
+
+  /**
+   * @brief Map a class to an unsigned key of the same order
+   */
+  static uint32_t class_key(int32_t class_id) {
+    return static_cast<uint32_t>(class_id) ^ 0x80000000u;
+  }
+
+  /**
+   * @brief Map a score to an unsigned key ordered by decreasing score
+   */
+  static uint32_t score_key(float score) {
+    uint32_t bits;
+    std::memcpy(&bits, &score, sizeof(bits));
+    // Ascending order of the floats, then reversed
+    bits ^= (bits & 0x80000000u) != 0 ? 0xFFFFFFFFu : 0x80000000u;
+    return ~bits;
+  }
+
+  /**
+   * @brief Copy the selected candidates into contiguous arrays in their
+   * sorted order and find the range of each class
+   */
+  void gather(const BoxStore &boxes, const NmsOptions &options) {
+    const size_t count = this->m_order.size();
+    this->m_x1.resize(count);
+    this->m_y1.resize(count);
+    this->m_x2.resize(count);
+    this->m_y2.resize(count);
+    this->m_areas.resize(count);
+    this->m_suppressed.assign(count, 0);
+    this->m_segments.clear();
+    this->m_segments.push_back(0);
+
+    const int32_t *classes = boxes.classes();
+    for (size_t k = 0; k < count; ++k) {
+      const uint32_t i = this->m_order[k];
+      this->m_x1[k] = boxes.x1()[i];
+      this->m_y1[k] = boxes.y1()[i];
+      this->m_x2[k] = boxes.x2()[i];
+      this->m_y2[k] = boxes.y2()[i];
+      this->m_areas[k] = std::max(0.0f, this->m_x2[k] - this->m_x1[k]) *
+                         std::max(0.0f, this->m_y2[k] - this->m_y1[k]);
+      if (options.class_aware && k > 0 &&
+          classes[i] != classes[this->m_order[k - 1]]) {
+        this->m_segments.push_back(k);
+      }
+    }
+    this->m_segments.push_back(count);
+  }
+
+private:
+  /**
+   * @brief Sort order of a candidate: class, decreasing score, index
+   */
+  struct SortKey {
+    uint32_t class_id;
+    uint32_t score;
+    uint32_t index;
+
+    bool operator<(const SortKey &other) const {
+      if (this->class_id != other.class_id) {
+        return this->class_id < other.class_id;
+      }
+      if (this->score != other.score) {
+        return this->score < other.score;
+      }
+      return this->index < other.index;
+    }
+  };
+
+private:
+  utils::cpu::SimdLevel m_simd_level;
+  std::vector<SortKey> m_keys;
+  std::vector<uint32_t> m_order;
+  std::vector<float> m_x1;
+  std::vector<float> m_y1;
+  std::vector<float> m_x2;
+  std::vector<float> m_y2;
+  std::vector<float> m_areas;
+  std::vector<int32_t> m_suppressed;
+  // Start of the candidates of each class, followed by their count
+  std::vector<size_t> m_segments;
+};
+
+/**
+ * @brief Greedy non-maximum suppression within each class
+ * @param boxes Boxes
+ * @param classes Class of each box
+ * @param scores Score of each box
+ * @param threshold Boxes overlapping a higher scored box of the same class by
+ *        more than this are suppressed
+ * @param metric Overlap metric
+ * @return Indices of the kept boxes, by decreasing score
+ */
+inline std::vector<size_t> nms(const std::vector<cv::Rect> &boxes,
+                               const std::vector<int> &classes,
+                               const std::vector<float> &scores,
+                               float threshold,
+                               OverlapMetric metric = OverlapMetric::IOU) {
+  const size_t count = std::min({boxes.size(), classes.size(), scores.size()});
+  BoxStore store(count);
+  for (size_t i = 0; i < count; ++i) {
+    const cv::Rect &box = boxes[i];
+    store.push_back(static_cast<float>(box.x), static_cast<float>(box.y),
+                    static_cast<float>(box.x + box.width),
+                    static_cast<float>(box.y + box.height), scores[i],
+                    classes[i]);
+  }
+
+  NmsOptions options;
+  options.threshold = threshold;
+  options.metric = metric;
+  options.score_threshold = -std::numeric_limits<float>::infinity();
+  std::vector<uint32_t> keep;
+  NonMaxSuppression().run(store, options, keep);
+  return std::vector<size_t>(keep.begin(), keep.end());
+}
+} // namespace tflite::postprocess
+
+#endif // NMS_HPP
@@ -0,0 +1,427 @@
+/**
+ * @file segmentation_argmax.hpp
+ * @details Most likely class of each pixel of a segmentation output, with
+ * the class scores of a pixel compared several at a time and the rows split
+ * across threads
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef SEGMENTATION_ARGMAX_HPP
+#define SEGMENTATION_ARGMAX_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include <glog/logging.h>
+#include <infer/output_tensor.hpp>
+#include <metrics/stage_metrics.hpp>
+#include <opencv2/core.hpp>
+#include <trace/tracer.hpp>
+#include <utils/cpu_features.hpp>
+#include <utils/inference_status.hpp>
+#include <utils/scoped_timer.hpp>
+
+namespace tflite::postprocess {
+namespace detail {
+// A pixel gets the first class with the highest score. The vector kernels
+// find the maximum, then the first class equal to it, so every kernel gives
+// the same map for finite scores.
+
+/**
+ * @brief Get the first class with the highest score
+ * @param scores Class scores of one pixel
+ * @param channels Number of classes
+ * @return Class index
+ */
+template <typename T> inline int argmax_scalar(const T *scores, int channels) {
+  T best = scores[0];
+  int index = 0;
+  for (int c = 1; c < channels; ++c) {
+    if (scores[c] > best) {
+      best = scores[c];
+      index = c;
+    }
+  }
+  return index;
+}
+
+/**
+ * @brief Place the matches of a vector of classes starting at first into a
+ * window of 64 classes starting at base. Classes before base were already
+ * searched, their bits are dropped.
+ */
+inline uint64_t window_bits(uint32_t mask, int first, int base) {
+  return first >= base ? static_cast<uint64_t>(mask) << (first - base)
+                       : static_cast<uint64_t>(mask) >> (base - first);
+}
+
+#if TFLITE_HAS_X86_DISPATCH
+// Scores are read in full vectors, the last one overlapping the previous one
+// when the classes are not a multiple of the vector width. Kernels need at
+// least one full vector of classes. The matches of up to 64 classes are
+// gathered into one mask before branching, the position of the winner being
+// unpredictable.
+
+TFLITE_TARGET_SSE41 inline int argmax_sse41(const float *scores,
+                                            int channels) {
+  __m128 best = _mm_loadu_ps(scores);
+  int c = 4;
+  for (; c + 4 <= channels; c += 4) {
+    best = _mm_max_ps(best, _mm_loadu_ps(scores + c));
+  }
+  if (c < channels) {
+    best = _mm_max_ps(best, _mm_loadu_ps(scores + channels - 4));
+  }
+  best = _mm_max_ps(best, _mm_movehl_ps(best, best));
+  best = _mm_max_ps(best, _mm_shuffle_ps(best, best, 0x55));
+  best = _mm_shuffle_ps(best, best, 0);
+
+  for (int base = 0; base < channels; base += 64) {
+    uint64_t matches = 0;
+    for (c = base; c < std::min(base + 64, channels); c += 4) {
+      const int first = std::min(c, channels - 4);
+      const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(
+          _mm_cmpeq_ps(_mm_loadu_ps(scores + first), best)));
+      matches |= window_bits(mask, first, base);
+    }
+    if (matches != 0) {
+      return base + __builtin_ctzll(matches);
+    }
+  }
+  // Only reached with NaN scores
+  return argmax_scalar(scores, channels);
+}
+
+/**
+ * @brief Lane-wise maximum of signed or unsigned bytes
+ */
+template <typename T>
+TFLITE_TARGET_SSE41 inline __m128i max_epi8(__m128i a, __m128i b) {
+  if constexpr (std::is_signed_v<T>) {
+    return _mm_max_epi8(a, b);
+  } else {
+    return _mm_max_epu8(a, b);
+  }
+}
+
+/**
+ * @brief Argmax of quantized scores, compared as integers: dequantization is
+ * increasing, so it does not change the winning class
+ */
+template <typename T>
+TFLITE_TARGET_SSE41 inline int argmax_sse41(const T *scores, int channels) {
+  const __m128i *data = reinterpret_cast<const __m128i *>(scores);
+  __m128i best = _mm_loadu_si128(data);
+  int c = 16;
+  for (; c + 16 <= channels; c += 16) {
+    best = max_epi8<T>(best, _mm_loadu_si128(data + c / 16));
+  }
+  if (c < channels) {
+    const __m128i block = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(scores + channels - 16));
+    best = max_epi8<T>(best, block);
+  }
+  // Rotations keep every lane valid for signed and unsigned maxima
+  best = max_epi8<T>(best, _mm_alignr_epi8(best, best, 8));
+  best = max_epi8<T>(best, _mm_alignr_epi8(best, best, 4));
+  best = max_epi8<T>(best, _mm_alignr_epi8(best, best, 2));
+  best = max_epi8<T>(best, _mm_alignr_epi8(best, best, 1));
+
+  for (int base = 0; base < channels; base += 64) {
+    uint64_t matches = 0;
+    for (c = base; c < std::min(base + 64, channels); c += 16) {
+      const int first = std::min(c, channels - 16);
+      const __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(scores + first));
+      const uint32_t mask = static_cast<uint32_t>(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(block, best)));
+      matches |= window_bits(mask, first, base);
+    }
+    if (matches != 0) {
+      return base + __builtin_ctzll(matches);
+    }
+  }
+  return argmax_scalar(scores, channels);
+}
+
+TFLITE_TARGET_AVX2 inline int argmax_avx2(const float *scores, int channels) {
+  if (channels < 8) {
+    return argmax_sse41(scores, channels);
+  }
+  __m256 best = _mm256_loadu_ps(scores);
+  int c = 8;
+  for (; c + 8 <= channels; c += 8) {
+    best = _mm256_max_ps(best, _mm256_loadu_ps(scores + c));
+  }
+  if (c < channels) {
+    best = _mm256_max_ps(best, _mm256_loadu_ps(scores + channels - 8));
+  }
+  __m128 half = _mm_max_ps(_mm256_castps256_ps128(best),
+                           _mm256_extractf128_ps(best, 1));
+  half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_max_ps(half, _mm_shuffle_ps(half, half, 0x55));
+  best = _mm256_broadcastss_ps(half);
+
+  for (int base = 0; base < channels; base += 64) {
+    uint64_t matches = 0;
+    for (c = base; c < std::min(base + 64, channels); c += 8) {
+      const int first = std::min(c, channels - 8);
+      const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(
+          _mm256_cmp_ps(_mm256_loadu_ps(scores + first), best, _CMP_EQ_OQ)));
+      matches |= window_bits(mask, first, base);
+    }
+    if (matches != 0) {
+      return base + __builtin_ctzll(matches);
+    }
+  }
+  return argmax_scalar(scores, channels);
+}
+
+template <typename T>
+TFLITE_TARGET_AVX2 inline int argmax_avx2(const T *scores, int channels) {
+  if (channels < 32) {
+    return argmax_sse41(scores, channels);
+  }
+  const __m256i *data = reinterpret_cast<const __m256i *>(scores);
+  __m256i best = _mm256_loadu_si256(data);
+  int c = 32;
+  for (; c + 32 <= channels; c += 32) {
+    const __m256i block = _mm256_loadu_si256(data + c / 32);
+    best = std::is_signed_v<T> ? _mm256_max_epi8(best, block)
+                               : _mm256_max_epu8(best, block);
+  }
+  if (c < channels) {
+    const __m256i block = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(scores + channels - 32));
+    best = std::is_signed_v<T> ? _mm256_max_epi8(best, block)
+                               : _mm256_max_epu8(best, block);
+  }
+  __m128i half = max_epi8<T>(_mm256_castsi256_si128(best),
+                             _mm256_extracti128_si256(best, 1));
+  half = max_epi8<T>(half, _mm_alignr_epi8(half, half, 8));
+  half = max_epi8<T>(half, _mm_alignr_epi8(half, half, 4));
+  half = max_epi8<T>(half, _mm_alignr_epi8(half, half, 2));
+  half = max_epi8<T>(half, _mm_alignr_epi8(half, half, 1));
+  best = _mm256_broadcastb_epi8(half);
+
+  for (int base = 0; base < channels; base += 64) {
+    uint64_t matches = 0;
+    for (c = base; c < std::min(base + 64, channels); c += 32) {
+      const int first = std::min(c, channels - 32);
+      const __m256i block = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(scores + first));
+      const uint32_t mask = static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, best)));
+      matches |= window_bits(mask, first, base);
+    }
+    if (matches != 0) {
+      return base + __builtin_ctzll(matches);
+    }
+  }
+  return argmax_scalar(scores, channels);
+}
+#endif
+
+/**
+ * @brief Row of class indices and optional scores of the winning classes
+ */
+struct ArgmaxRow {
+  uint8_t *classes;
+  // nullptr if not requested
+  float *confidence;
+  // Dequantization of the winning score, 1 and 0 for float scores
+  float scale;
+  float zero_point;
+};
+
+template <typename T>
+inline void store(const T *scores, int x, int index, const ArgmaxRow &row) {
+  row.classes[x] = static_cast<uint8_t>(index);
+  if (row.confidence != nullptr) {
+    row.confidence[x] =
+        row.scale * (static_cast<float>(scores[index]) - row.zero_point);
+  }
+}
+
+template <typename T>
+inline void argmax_row_scalar(const T *scores, int width, int channels,
+                              const ArgmaxRow &row) {
+  for (int x = 0; x < width; ++x, scores += channels) {
+    store(scores, x, argmax_scalar(scores, channels), row);
+  }
+}
+
+#if TFLITE_HAS_X86_DISPATCH
+template <typename T>
+TFLITE_TARGET_SSE41 inline void argmax_row_sse41(const T *scores, int width,
+                                                 int channels,
+                                                 const ArgmaxRow &row) {
+  for (int x = 0; x < width; ++x, scores += channels) {
+    store(scores, x, argmax_sse41(scores, channels), row);
+  }
+}
+
+template <typename T>
+TFLITE_TARGET_AVX2 inline void argmax_row_avx2(const T *scores, int width,
+                                               int channels,
+                                               const ArgmaxRow &row) {
+  for (int x = 0; x < width; ++x, scores += channels) {
+    store(scores, x, argmax_avx2(scores, channels), row);
+  }
+}
+#endif
+
+/**
+ * @brief Compute one row with the kernel of the SIMD level, the scalar one
+ * when the classes do not fill a vector
+ */
+template <typename T>
+inline void argmax_row(utils::cpu::SimdLevel level, const T *scores,
+                       int width, int channels, const ArgmaxRow &row) {
+#if TFLITE_HAS_X86_DISPATCH
+  constexpr int lanes = 16 / sizeof(T);
+  if (level == utils::cpu::SimdLevel::AVX2 && channels >= lanes) {
+    argmax_row_avx2(scores, width, channels, row);
+    return;
+  }
+  if (level == utils::cpu::SimdLevel::SSE41 && channels >= lanes) {
+    argmax_row_sse41(scores, width, channels, row);
+    return;
+  }
+#endif
+  static_cast<void>(level);
+  argmax_row_scalar(scores, width, channels, row);
+}
+} // namespace detail
+
+/**
+ * @brief Argmax over the classes of a segmentation output in HWC order,
+ * producing the class of each pixel and optionally the score of that class.
+ * Float, uint8 and int8 scores are supported; quantized scores are compared
+ * as integers and only the winning score is dequantized. Rows are split
+ * across the OpenCV threads and the output matrices are reused when their
+ * size matches. Running is const, one instance can be shared by threads.
+ */
+class SegmentationArgmax {
+public:
+  SegmentationArgmax() : m_simd_level(utils::cpu::detect_simd_level()) {}
+  ~SegmentationArgmax() = default;
+
+  SegmentationArgmax(const SegmentationArgmax &) = delete;
+  SegmentationArgmax &operator=(const SegmentationArgmax &) = delete;
+  SegmentationArgmax(SegmentationArgmax &&) = delete;
+  SegmentationArgmax &operator=(SegmentationArgmax &&) = delete;
+
+public:
+  /**
+   * @brief Compute the class map of raw scores
+   * @tparam T float, uint8_t or int8_t
+   * @param scores Class scores in HWC order
+   * @param height Output height
+   * @param width Output width
+   * @param channels Number of classes, at most 256
+   * @param classes CV_8UC1 map of class indices
+   * @param confidence CV_32FC1 map of the winning scores, nullptr to skip
+   * @param scale Quantization scale of the scores
+   * @param zero_point Quantization zero point of the scores
+   * @return Status
+   */
+  template <typename T>
+  inference::InferenceStatus
+  run(const T *scores, int height, int width, int channels, cv::Mat &classes,
+      cv::Mat *confidence = nullptr, float scale = 1.0f,
+      int zero_point = 0) const {
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, uint8_t> ||
+                      std::is_same_v<T, int8_t>,
+                  "Scores must be float, uint8_t or int8_t");
+    TFLITE_TRACE_SCOPE("segmentation_argmax");
+    utils::timer::ScopedTimer timer(
+        metrics::StageMetrics::get().segmentation_postprocess);
+    if (scores == nullptr || height <= 0 || width <= 0 || channels <= 0) {
+      LOG_EVERY_N(ERROR, 100) << "Segmentation scores are empty";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+    if (channels > 256) {
+      LOG_EVERY_N(ERROR, 100)
+          << "Class map holds at most 256 classes, got " << channels;
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+
+    classes.create(height, width, CV_8UC1);
+    if (confidence != nullptr) {
+      confidence->create(height, width, CV_32FC1);
+    }
+    const utils::cpu::SimdLevel level = this->m_simd_level;
+    const size_t row_size = static_cast<size_t>(width) * channels;
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range &range) {
+      for (int y = range.start; y < range.end; ++y) {
+        const detail::ArgmaxRow row{
+            classes.ptr<uint8_t>(y),
+            confidence != nullptr ? confidence->ptr<float>(y) : nullptr,
+            scale, static_cast<float>(zero_point)};
+        detail::argmax_row(level, scores + y * row_size, width, channels,
+                           row);
+      }
+    });
+    return inference::InferenceStatus::SUCCESS;
+  }
+
+  /**
+   * @brief Compute the class map of an output tensor of shape [1, H, W, C]
+   * or [H, W, C]
+   * @param scores Output tensor
+   * @param classes CV_8UC1 map of class indices
+   * @param confidence CV_32FC1 map of the dequantized winning scores,
+   *        nullptr to skip
+   * @return Status
+   */
+  inference::InferenceStatus run(const inference::OutputTensor &scores,
+                                 cv::Mat &classes,
+                                 cv::Mat *confidence = nullptr) const {
+    const inference::TensorShape &shape = scores.shape();
+    if (scores.empty() || shape.rank() < 3) {
+      LOG_EVERY_N(ERROR, 100)
+          << "Segmentation output must have height, width and classes";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+    const int height = shape.dim(-3);
+    const int width = shape.dim(-2);
+    const int channels = shape.dim(-1);
+    switch (scores.type()) {
+    case kTfLiteUInt8:
+      return this->run(static_cast<const uint8_t *>(scores.data()), height,
+                       width, channels, classes, confidence, scores.scale(),
+                       scores.zero_point());
+    case kTfLiteInt8:
+      return this->run(static_cast<const int8_t *>(scores.data()), height,
+                       width, channels, classes, confidence, scores.scale(),
+                       scores.zero_point());
+    default:
+      return this->run(static_cast<const float *>(scores.data()), height,
+                       width, channels, classes, confidence);
+    }
+  }
+
+public:
+  /**
+   * @brief Set the instruction set of the kernel, e.g. to compare against
+   * the scalar kernel
+   * @param level SIMD level, limited to the ones the CPU supports
+   */
+  void set_simd_level(utils::cpu::SimdLevel level) {
+    this->m_simd_level = utils::cpu::clamp_simd_level(level);
+  }
+
+  [[nodiscard]] utils::cpu::SimdLevel get_simd_level() const {
+    return this->m_simd_level;
+  }
+
+private:
+  utils::cpu::SimdLevel m_simd_level;
+};
+} // namespace tflite::postprocess
+
+#endif // SEGMENTATION_ARGMAX_HPP
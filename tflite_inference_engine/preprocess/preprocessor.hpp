@@ -0,0 +1,351 @@
+/**
+ * @file preprocessor.hpp
+ * @details Fused resize, channel swap, normalization and quantization of
+ * input images into the model input tensor
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef PREPROCESSOR_HPP
+#define PREPROCESSOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <infer/infer.hpp>
+#include <metrics/stage_metrics.hpp>
+#include <opencv2/opencv.hpp>
+#include <trace/tracer.hpp>
+#include <utils/inference_status.hpp>
+#include <utils/scoped_timer.hpp>
+
+namespace tflite::preprocess {
+/**
+ * @brief Description of the model input. The model input is expected to be
+ * (pixel / 255 - mean) / std, quantized with scale and zero point for
+ * integer inputs.
+ */
+struct PreprocessSpec {
+  int width = 0;
+  int height = 0;
+  int channels = 3;
+  TfLiteType type = kTfLiteFloat32;
+  std::array<float, 3> mean{0.0f, 0.0f, 0.0f};
+  std::array<float, 3> std{1.0f, 1.0f, 1.0f};
+  bool swap_rb = false;
+  float scale = 0.0f;
+  int zero_point = 0;
+
+  /**
+   * @brief Build the spec from the input tensor of a loaded engine
+   * @param engine Engine with a loaded model
+   * @param mean Per channel mean in the [0, 1] pixel range
+   * @param std Per channel standard deviation in the [0, 1] pixel range
+   * @param swap_rb Convert BGR images to RGB
+   * @return Preprocessing spec
+   */
+  static PreprocessSpec
+  from_engine(const inference::TFLiteInferenceEngine &engine,
+              const std::array<float, 3> &mean = {0.0f, 0.0f, 0.0f},
+              const std::array<float, 3> &std = {1.0f, 1.0f, 1.0f},
+              bool swap_rb = false) {
+    PreprocessSpec spec;
+    spec.width = engine.get_input_width();
+    spec.height = engine.get_input_height();
+    spec.channels = engine.get_input_channels();
+    spec.type = engine.get_input_type();
+    spec.mean = mean;
+    spec.std = std;
+    spec.swap_rb = swap_rb;
+    spec.scale = engine.get_input_quantization().scale;
+    spec.zero_point = engine.get_input_quantization().zero_point;
+    return spec;
+  }
+};
+
+class Preprocessor {
+public:
+  explicit Preprocessor(const PreprocessSpec &spec) : m_spec(spec) {
+    this->set_channel_transform();
+  }
+  ~Preprocessor() = default;
+
+  Preprocessor(const Preprocessor &) = delete;
+  Preprocessor &operator=(const Preprocessor &) = delete;
+  Preprocessor(Preprocessor &&) = delete;
+  Preprocessor &operator=(Preprocessor &&) = delete;
+
+public:
+  /**
+   * @brief Get the spec the preprocessor was built with
+   * @return Preprocessing spec
+   */
+  [[nodiscard]] const PreprocessSpec &get_spec() const { return this->m_spec; }
+
+public:
+  /**
+   * @brief Resize, swap channels, normalize and quantize the image in a
+   * single pass over the output
+   * @param image 8-bit input image with the spec's number of channels
+   * @param output Destination, typically TFLiteInferenceEngine::input_view().
+   *        Allocated if empty, otherwise it must match the spec's size and
+   *        type so a tensor view is never silently reallocated
+   * @return SUCCESS or INPUT_ERROR
+   */
+  inference::InferenceStatus run(const cv::Mat &image, cv::Mat &output) {
+    TFLITE_TRACE_SCOPE("preprocess");
+    utils::timer::ScopedTimer timer(metrics::StageMetrics::get().preprocess);
+    if (image.empty()) {
+      LOG_EVERY_N(ERROR, 100) << "Input image is empty";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+
+    if (image.depth() != CV_8U || image.channels() != this->m_spec.channels ||
+        image.channels() > 4) {
+      LOG_EVERY_N(ERROR, 100) << "Input image must be 8-bit with "
+                              << this->m_spec.channels << " channels";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+
+    const int type = this->get_output_type();
+    if (type < 0) {
+      LOG_EVERY_N(ERROR, 100) << "Unsupported input tensor type";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+    if (output.empty()) {
+      output.create(this->m_spec.height, this->m_spec.width, type);
+    } else if (output.rows != this->m_spec.height ||
+               output.cols != this->m_spec.width || output.type() != type) {
+      LOG_EVERY_N(ERROR, 100)
+          << "Output " << output.cols << "x" << output.rows << " (type "
+          << output.type() << ") does not match the spec "
+          << this->m_spec.width << "x" << this->m_spec.height << " (type "
+          << type << ")";
+      return inference::InferenceStatus::INPUT_ERROR;
+    }
+
+    if (image.size() != this->m_table_size) {
+      this->set_resize_tables(image.size());
+    }
+
+    switch (this->m_spec.type) {
+    case kTfLiteFloat32:
+      this->run_rows<float>(image, output);
+      break;
+    case kTfLiteUInt8:
+      this->run_rows<uchar>(image, output);
+      break;
+    case kTfLiteInt8:
+      this->run_rows<schar>(image, output);
+      break;
+    default:
+      break;
+    }
+    return inference::InferenceStatus::SUCCESS;
+  }
+
+private:
+  /**
+   * @brief Process all output rows in parallel
+   * @tparam T Output element type
+   * @param image Input image
+   * @param output Output image
+   */
+  template <typename T>
+  void run_rows(const cv::Mat &image, cv::Mat &output) const {
+    cv::parallel_for_(cv::Range(0, this->m_spec.height),
+                      [&](const cv::Range &range) {
+                        // Kept by the worker threads across calls
+                        thread_local std::vector<float> scratch;
+                        const size_t row_size = static_cast<size_t>(
+                            this->m_spec.width * this->m_spec.channels);
+                        if (scratch.size() < 2 * row_size) {
+                          scratch.resize(2 * row_size);
+                        }
+                        float *top = scratch.data();
+                        float *bottom = top + row_size;
+                        for (int y = range.start; y < range.end; ++y) {
+                          this->process_row(image, y, top, bottom,
+                                            output.ptr<T>(y));
+                        }
+                      });
+  }
+
+private:
+  /**
+   * @brief Produce one output row: horizontal interpolation of the two
+   * source rows with the channel swap folded into the gather, then vertical
+   * interpolation, normalization and quantization as one affine transform
+   * @tparam T Output element type
+   * @param image Input image
+   * @param y Output row
+   * @param top Scratch buffer for the upper source row
+   * @param bottom Scratch buffer for the lower source row
+   * @param dst Output row pointer
+   */
+  template <typename T>
+  void process_row(const cv::Mat &image, int y, float *top, float *bottom,
+                   T *dst) const {
+    const int cn = this->m_spec.channels;
+    const int width = this->m_spec.width;
+
+    const float fy = std::clamp(
+        (static_cast<float>(y) + 0.5f) * this->m_scale_y - 0.5f, 0.0f,
+        static_cast<float>(image.rows - 1));
+    const int y0 = static_cast<int>(fy);
+    const int y1 = std::min(y0 + 1, image.rows - 1);
+    const float wy1 = fy - static_cast<float>(y0);
+    const float wy0 = 1.0f - wy1;
+
+    this->interpolate_row(image.ptr<uchar>(y0), top);
+    this->interpolate_row(image.ptr<uchar>(y1), bottom);
+
+    const float *alpha = this->m_alpha.data();
+    const float *beta = this->m_beta.data();
+    const int row_size = width * cn;
+    if constexpr (std::is_same_v<T, float>) {
+      for (int i = 0; i < row_size; ++i) {
+        dst[i] = (top[i] * wy0 + bottom[i] * wy1) * alpha[i] + beta[i];
+      }
+    } else {
+      const float lo = std::numeric_limits<T>::min();
+      const float hi = std::numeric_limits<T>::max();
+      for (int i = 0; i < row_size; ++i) {
+        const float v = (top[i] * wy0 + bottom[i] * wy1) * alpha[i] + beta[i];
+        dst[i] = static_cast<T>(std::nearbyint(std::clamp(v, lo, hi)));
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief Horizontally interpolate one source row to the output width
+   * @param src Source row
+   * @param dst Interpolated row with swapped channels
+   */
+  void interpolate_row(const uchar *src, float *dst) const {
+    const int cn = this->m_spec.channels;
+    for (int x = 0; x < this->m_spec.width; ++x) {
+      const uchar *p0 = src + this->m_x0[x];
+      const uchar *p1 = src + this->m_x1[x];
+      const float wx1 = this->m_wx[x];
+      const float wx0 = 1.0f - wx1;
+      float *out = dst + x * cn;
+      for (int c = 0; c < cn; ++c) {
+        out[this->m_channel_map[c]] = p0[c] * wx0 + p1[c] * wx1;
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief Compute the horizontal source offsets and weights for the given
+   * input size, with the same pixel center alignment as cv::INTER_LINEAR
+   * @param size Input image size
+   */
+  void set_resize_tables(const cv::Size &size) {
+    const int cn = this->m_spec.channels;
+    const float scale_x =
+        static_cast<float>(size.width) / static_cast<float>(this->m_spec.width);
+    this->m_scale_y = static_cast<float>(size.height) /
+                      static_cast<float>(this->m_spec.height);
+
+    this->m_x0.resize(this->m_spec.width);
+    this->m_x1.resize(this->m_spec.width);
+    this->m_wx.resize(this->m_spec.width);
+    for (int x = 0; x < this->m_spec.width; ++x) {
+      const float fx =
+          std::clamp((static_cast<float>(x) + 0.5f) * scale_x - 0.5f, 0.0f,
+                     static_cast<float>(size.width - 1));
+      const int x0 = static_cast<int>(fx);
+      this->m_x0[x] = x0 * cn;
+      this->m_x1[x] = std::min(x0 + 1, size.width - 1) * cn;
+      this->m_wx[x] = fx - static_cast<float>(x0);
+    }
+    this->m_table_size = size;
+  }
+
+private:
+  /**
+   * @brief Fold normalization and quantization into one multiply-add per
+   * element and set the channel order. A fourth (alpha) channel is scaled to
+   * [0, 1] without mean and standard deviation.
+   */
+  void set_channel_transform() {
+    const int cn = this->m_spec.channels;
+    const bool quantized = this->m_spec.type != kTfLiteFloat32;
+
+    std::array<float, 4> alpha{};
+    std::array<float, 4> beta{};
+    for (int c = 0; c < std::min(cn, 4); ++c) {
+      if (quantized && this->m_spec.scale <= 0.0f) {
+        // Integer input without quantization parameters takes raw pixels
+        alpha[c] = 1.0f;
+        beta[c] = 0.0f;
+        continue;
+      }
+      const float mean = c < 3 ? this->m_spec.mean[c] : 0.0f;
+      const float std = c < 3 ? this->m_spec.std[c] : 1.0f;
+      alpha[c] = 1.0f / (255.0f * std);
+      beta[c] = -mean / std;
+      if (quantized) {
+        alpha[c] /= this->m_spec.scale;
+        beta[c] = beta[c] / this->m_spec.scale +
+                  static_cast<float>(this->m_spec.zero_point);
+      }
+    }
+
+    this->m_alpha.resize(this->m_spec.width * cn);
+    this->m_beta.resize(this->m_spec.width * cn);
+    for (int i = 0; i < this->m_spec.width * cn; ++i) {
+      this->m_alpha[i] = alpha[i % cn];
+      this->m_beta[i] = beta[i % cn];
+    }
+
+    for (int c = 0; c < 4; ++c) {
+      this->m_channel_map[c] = c;
+    }
+    if (this->m_spec.swap_rb && cn >= 3) {
+      std::swap(this->m_channel_map[0], this->m_channel_map[2]);
+    }
+  }
+
+private:
+  /**
+   * @brief Get the OpenCV type of the output
+   * @return OpenCV type, -1 if the tensor type is not supported
+   */
+  [[nodiscard]] int get_output_type() const {
+    switch (this->m_spec.type) {
+    case kTfLiteFloat32:
+      return CV_32FC(this->m_spec.channels);
+    case kTfLiteUInt8:
+      return CV_8UC(this->m_spec.channels);
+    case kTfLiteInt8:
+      return CV_8SC(this->m_spec.channels);
+    default:
+      return -1;
+    }
+  }
+
+private:
+  PreprocessSpec m_spec;
+
+  std::vector<float> m_alpha;
+  std::vector<float> m_beta;
+  std::array<int, 4> m_channel_map{};
+
+  cv::Size m_table_size;
+  float m_scale_y = 1.0f;
+  std::vector<int> m_x0;
+  std::vector<int> m_x1;
+  std::vector<float> m_wx;
+};
+} // namespace tflite::preprocess
+
+#endif // PREPROCESSOR_HPP
@@ -0,0 +1,513 @@
+/**
+ * @file tracer.hpp
+ * @details Low-overhead span tracing into per-thread ring buffers with export
+ * to the Chrome trace-event JSON format, viewable in Perfetto
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tflite::trace {
+/**
+ * @brief Completed span
+ */
+struct TraceEvent {
+  // Static string, see Tracer::intern for dynamic names
+  const char *name = nullptr;
+  int64_t start_ns = 0;
+  int64_t duration_ns = 0;
+  // Frame the span belongs to, -1 if none
+  int64_t frame_id = -1;
+};
+
+class Tracer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+public:
+  /**
+   * @brief Get the instance of the tracer
+   * @return Tracer instance
+   */
+  static Tracer &get_instance() {
+    static Tracer instance;
+    return instance;
+  }
+
+public:
+  /**
+   * @brief Start recording spans. Spans are only recorded when the library
+   * is built with TFLITE_ENABLE_TRACING.
+   * @param events_per_thread Capacity of the ring buffer of each thread,
+   * applies to threads recording their first span after this call
+   */
+  void start(size_t events_per_thread = 16384) {
+    {
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      this->m_capacity = std::max<size_t>(1, events_per_thread);
+    }
+    this->m_enabled.store(true, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Stop recording, the recorded spans are kept
+   */
+  void stop() { this->m_enabled.store(false, std::memory_order_relaxed); }
+
+  /**
+   * @brief Check if spans are recorded
+   * @return True while started
+   */
+  [[nodiscard]] bool is_enabled() const {
+    return this->m_enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Drop the recorded spans. The ring buffers of exited threads are
+   * kept for reuse by new threads.
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    for (auto &buffer : this->m_buffers) {
+      buffer->cleared.store(buffer->head.load(std::memory_order_acquire),
+                            std::memory_order_release);
+    }
+    for (auto it = this->m_buffers.begin(); it != this->m_buffers.end();) {
+      if ((*it)->retired) {
+        this->m_free.push_back(std::move(*it));
+        it = this->m_buffers.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  /**
+   * @brief Get the number of ring buffers allocated, including the ones of
+   * exited threads kept for reuse
+   * @return Number of ring buffers
+   */
+  [[nodiscard]] size_t num_buffers() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    return this->m_buffers.size() + this->m_free.size();
+  }
+
+public:
+  /**
+   * @brief Record a completed span into the ring buffer of the calling
+   * thread. Once full, the oldest spans are overwritten.
+   * @param name Static span name
+   * @param start Start of the span
+   * @param end End of the span
+   * @param frame_id Frame id, -1 if none
+   */
+  void record(const char *name, Clock::time_point start, Clock::time_point end,
+              int64_t frame_id) {
+    RingBuffer &buffer = this->local_buffer();
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    const int64_t start_ns = to_ns(start);
+    buffer.slots[head % buffer.capacity].write(
+        head, {name, start_ns, to_ns(end) - start_ns, frame_id});
+    buffer.head.store(head + 1, std::memory_order_release);
+  }
+
+public:
+  /**
+   * @brief Name the calling thread in the trace. Only stored until the
+   * thread records its first span, so naming allocates no ring buffer.
+   * @param name Thread name
+   */
+  void set_thread_name(const std::string &name) {
+    ThreadState &state = local_state();
+    state.name = name;
+    if (state.buffer != nullptr) {
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      state.buffer->name = name;
+    }
+  }
+
+  /**
+   * @brief Keep a copy of a dynamic span name for the lifetime of the process
+   * @param name Name
+   * @return Static string usable as span name
+   */
+  const char *intern(const std::string &name) {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    return this->m_names.insert(name).first->c_str();
+  }
+
+public:
+  /**
+   * @brief Get the frame id of the calling thread, set by FrameScope
+   * @return Frame id, -1 if none
+   */
+  static int64_t &current_frame() {
+    thread_local int64_t frame_id = -1;
+    return frame_id;
+  }
+
+public:
+  /**
+   * @brief Copy the spans of all threads, also while they are recording
+   * @return Spans per thread id
+   */
+  [[nodiscard]] std::vector<std::pair<int, std::vector<TraceEvent>>>
+  get_events() {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    std::vector<std::pair<int, std::vector<TraceEvent>>> events;
+    for (const auto &buffer : this->m_buffers) {
+      events.emplace_back(buffer->thread_id, buffer->snapshot());
+    }
+    return events;
+  }
+
+  /**
+   * @brief Render the spans as Chrome trace-event JSON
+   * @return JSON, open in https://ui.perfetto.dev or chrome://tracing
+   */
+  [[nodiscard]] std::string to_chrome_trace() {
+    const auto events = this->get_events();
+    std::vector<std::pair<int, std::string>> names;
+    {
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      for (const auto &buffer : this->m_buffers) {
+        names.emplace_back(buffer->thread_id, buffer->name);
+      }
+    }
+
+    std::ostringstream out;
+    out.precision(3);
+    out << std::fixed << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    const auto separator = [&out, &first] {
+      out << (first ? "" : ",\n");
+      first = false;
+    };
+    for (const auto &[thread_id, name] : names) {
+      if (name.empty()) {
+        continue;
+      }
+      separator();
+      out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << thread_id
+          << R"(,"args":{"name":")" << escape(name) << "\"}}";
+    }
+    for (const auto &[thread_id, thread_events] : events) {
+      for (const auto &event : thread_events) {
+        separator();
+        out << R"({"name":")" << escape(event.name)
+            << R"(","cat":"tflite","ph":"X","pid":1,"tid":)" << thread_id
+            << ",\"ts\":" << static_cast<double>(event.start_ns) * 1e-3
+            << ",\"dur\":" << static_cast<double>(event.duration_ns) * 1e-3;
+        if (event.frame_id >= 0) {
+          out << ",\"args\":{\"frame\":" << event.frame_id << "}";
+        }
+        out << "}";
+      }
+    }
+    out << "\n]}\n";
+    return out.str();
+  }
+
+  /**
+   * @brief Write the Chrome trace-event JSON to a file
+   * @param path File path, e.g. trace.json
+   * @return True on success
+   */
+  bool write_chrome_trace(const std::string &path) {
+    std::ofstream file(path);
+    if (!file) {
+      return false;
+    }
+    file << this->to_chrome_trace();
+    return static_cast<bool>(file);
+  }
+
+private:
+  Tracer() = default;
+  Tracer(const Tracer &) = delete;
+  Tracer &operator=(const Tracer &) = delete;
+
+private:
+  /**
+   * @brief Ring buffer slot guarded by a sequence number, so a dump running
+   * next to the owning thread skips spans that are being overwritten instead
+   * of reading them torn
+   */
+  struct Slot {
+    /**
+     * @brief Write the span of the given ring index, owning thread only
+     */
+    void write(uint64_t index, const TraceEvent &event) {
+      this->sequence.store(2 * index + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      this->name.store(event.name, std::memory_order_relaxed);
+      this->start_ns.store(event.start_ns, std::memory_order_relaxed);
+      this->duration_ns.store(event.duration_ns, std::memory_order_relaxed);
+      this->frame_id.store(event.frame_id, std::memory_order_relaxed);
+      this->sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Read the span of the given ring index
+     * @return False if the slot holds another span or is being written
+     */
+    bool read(uint64_t index, TraceEvent &event) const {
+      const uint64_t expected = 2 * index + 2;
+      if (this->sequence.load(std::memory_order_acquire) != expected) {
+        return false;
+      }
+      event.name = this->name.load(std::memory_order_relaxed);
+      event.start_ns = this->start_ns.load(std::memory_order_relaxed);
+      event.duration_ns = this->duration_ns.load(std::memory_order_relaxed);
+      event.frame_id = this->frame_id.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return this->sequence.load(std::memory_order_relaxed) == expected;
+    }
+
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<int64_t> start_ns{0};
+    std::atomic<int64_t> duration_ns{0};
+    std::atomic<int64_t> frame_id{-1};
+  };
+
+  struct RingBuffer {
+    explicit RingBuffer(size_t size)
+        : capacity(size), slots(std::make_unique<Slot[]>(size)) {}
+
+    /**
+     * @brief Copy the valid spans, oldest first. Spans overwritten by the
+     * owning thread during the copy are dropped.
+     */
+    [[nodiscard]] std::vector<TraceEvent> snapshot() const {
+      const uint64_t end = this->head.load(std::memory_order_acquire);
+      const uint64_t begin =
+          std::max(this->cleared.load(std::memory_order_acquire),
+                   end > this->capacity ? end - this->capacity : 0);
+      std::vector<TraceEvent> copy;
+      copy.reserve(end - begin);
+      TraceEvent event;
+      for (uint64_t i = begin; i < end; ++i) {
+        if (this->slots[i % this->capacity].read(i, event)) {
+          copy.push_back(event);
+        }
+      }
+      return copy;
+    }
+
+    /**
+     * @brief Check for spans not dropped by clear()
+     */
+    [[nodiscard]] bool empty() const {
+      return this->head.load(std::memory_order_acquire) ==
+             this->cleared.load(std::memory_order_acquire);
+    }
+
+    // The fields below are guarded by the tracer mutex
+    int thread_id = 0;
+    std::string name;
+    // The thread exited, the buffer is kept until its spans are cleared
+    bool retired = false;
+
+    const size_t capacity;
+    const std::unique_ptr<Slot[]> slots;
+    // Ring index of the next span, only grows so stale slots never match
+    std::atomic<uint64_t> head{0};
+    // Ring index of the first span not dropped by clear()
+    std::atomic<uint64_t> cleared{0};
+  };
+
+  /**
+   * @brief Per-thread owner of the ring buffer, retires it when the thread
+   * exits
+   */
+  struct ThreadState {
+    ThreadState() = default;
+    ~ThreadState() {
+      if (this->buffer != nullptr) {
+        Tracer::get_instance().retire(this->buffer);
+      }
+    }
+
+    ThreadState(const ThreadState &) = delete;
+    ThreadState &operator=(const ThreadState &) = delete;
+
+    std::string name;
+    RingBuffer *buffer = nullptr;
+  };
+
+private:
+  static ThreadState &local_state() {
+    thread_local ThreadState state;
+    return state;
+  }
+
+  /**
+   * @brief Get the ring buffer of the calling thread, created when the
+   * thread records its first span. Reuses the buffer of an exited thread
+   * whose spans were cleared.
+   */
+  RingBuffer &local_buffer() {
+    ThreadState &state = local_state();
+    if (state.buffer == nullptr) {
+      std::lock_guard<std::mutex> lock(this->m_mutex);
+      std::unique_ptr<RingBuffer> buffer;
+      auto reusable = std::find_if(
+          this->m_free.begin(), this->m_free.end(), [this](const auto &free) {
+            return free->capacity == this->m_capacity;
+          });
+      if (reusable != this->m_free.end()) {
+        buffer = std::move(*reusable);
+        this->m_free.erase(reusable);
+      } else {
+        // Buffers of another capacity are not worth keeping
+        this->m_free.clear();
+        buffer = std::make_unique<RingBuffer>(this->m_capacity);
+      }
+      buffer->thread_id = ++this->m_next_thread_id;
+      buffer->name = state.name;
+      buffer->retired = false;
+      state.buffer = buffer.get();
+      this->m_buffers.push_back(std::move(buffer));
+    }
+    return *state.buffer;
+  }
+
+  /**
+   * @brief Retire the ring buffer of an exiting thread. Its spans stay
+   * available for dumps until cleared, an empty buffer is reused right away.
+   */
+  void retire(RingBuffer *buffer) {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    auto it = std::find_if(
+        this->m_buffers.begin(), this->m_buffers.end(),
+        [buffer](const auto &owned) { return owned.get() == buffer; });
+    if (it == this->m_buffers.end()) {
+      return;
+    }
+    buffer->retired = true;
+    if (buffer->empty()) {
+      this->m_free.push_back(std::move(*it));
+      this->m_buffers.erase(it);
+    }
+  }
+
+  static int64_t to_ns(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               time.time_since_epoch())
+        .count();
+  }
+
+  static std::string escape(const std::string &text) {
+    std::string escaped;
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+      }
+      escaped += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+    }
+    return escaped;
+  }
+
+private:
+  std::atomic<bool> m_enabled{false};
+  size_t m_capacity = 16384;
+  std::mutex m_mutex;
+  // Buffers of running threads and of exited threads with spans
+  std::vector<std::unique_ptr<RingBuffer>> m_buffers;
+  // Buffers of exited threads, reused by new threads
+  std::vector<std::unique_ptr<RingBuffer>> m_free;
+  int m_next_thread_id = 0;
+  std::set<std::string> m_names;
+};
+
+/**
+ * @brief Records the time from construction to destruction as a span of the
+ * current frame. Costs one relaxed load while the tracer is stopped.
+ */
+class Span {
+public:
+  /**
+   * @brief Start the span
+   * @param name Static span name
+   */
+  explicit Span(const char *name)
+      : m_name(Tracer::get_instance().is_enabled() ? name : nullptr) {
+    if (this->m_name != nullptr) {
+      this->m_start = Tracer::Clock::now();
+    }
+  }
+  ~Span() {
+    if (this->m_name != nullptr) {
+      Tracer::get_instance().record(this->m_name, this->m_start,
+                                    Tracer::Clock::now(),
+                                    Tracer::current_frame());
+    }
+  }
+
+  Span(const Span &) = delete;
+  Span &operator=(const Span &) = delete;
+  Span(Span &&) = delete;
+  Span &operator=(Span &&) = delete;
+
+private:
+  const char *m_name;
+  Tracer::Clock::time_point m_start;
+};
+
+/**
+ * @brief Tags the spans of the calling thread with a frame id until the end
+ * of the scope
+ */
+class FrameScope {
+public:
+  explicit FrameScope(int64_t frame_id)
+      : m_previous(Tracer::current_frame()) {
+    Tracer::current_frame() = frame_id;
+  }
+  ~FrameScope() { Tracer::current_frame() = this->m_previous; }
+
+  FrameScope(const FrameScope &) = delete;
+  FrameScope &operator=(const FrameScope &) = delete;
+  FrameScope(FrameScope &&) = delete;
+  FrameScope &operator=(FrameScope &&) = delete;
+
+private:
+  const int64_t m_previous;
+};
+} // namespace tflite::trace
+
+// Without TFLITE_ENABLE_TRACING the macros expand to nothing
+#ifdef TFLITE_ENABLE_TRACING
+#define TFLITE_TRACE_CONCAT_IMPL(a, b) a##b
+#define TFLITE_TRACE_CONCAT(a, b) TFLITE_TRACE_CONCAT_IMPL(a, b)
+#define TFLITE_TRACE_SCOPE(name)                                               \
+  ::tflite::trace::Span TFLITE_TRACE_CONCAT(trace_span_, __LINE__)(name)
+#define TFLITE_TRACE_FRAME(frame_id)                                           \
+  ::tflite::trace::FrameScope TFLITE_TRACE_CONCAT(trace_frame_, __LINE__)(     \
+      static_cast<int64_t>(frame_id))
+#define TFLITE_TRACE_THREAD_NAME(name)                                         \
+  ::tflite::trace::Tracer::get_instance().set_thread_name(name)
+#else
+#define TFLITE_TRACE_SCOPE(name) static_cast<void>(0)
+#define TFLITE_TRACE_FRAME(frame_id) static_cast<void>(0)
+#define TFLITE_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
+
+#endif // TRACER_HPP
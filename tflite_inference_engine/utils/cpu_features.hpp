@@ -0,0 +1,80 @@
+/**
+ * @file cpu_features.hpp
+ * @details Runtime detection of the SIMD instruction sets of the CPU, so
+ * vectorized kernels run without building for a specific CPU
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef CPU_FEATURES_HPP
+#define CPU_FEATURES_HPP
+
+#include <algorithm>
+
+// Kernels for an instruction set are compiled with the target attribute and
+// only called after checking the CPU at runtime
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define TFLITE_HAS_X86_DISPATCH 1
+#include <immintrin.h>
+#define TFLITE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TFLITE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TFLITE_HAS_X86_DISPATCH 0
+#endif
+
+namespace utils ::cpu {
+/**
+ * @brief Instruction sets of the vectorized kernels, ordered by width
+ */
+enum class SimdLevel { SCALAR, SSE41, AVX2 };
+
+/**
+ * @brief Get the widest instruction set supported by the CPU
+ * @return SIMD level, detected once
+ */
+inline SimdLevel detect_simd_level() {
+#if TFLITE_HAS_X86_DISPATCH
+  static const SimdLevel level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+      return SimdLevel::SSE41;
+    }
+    return SimdLevel::SCALAR;
+  }();
+  return level;
+#else
+  return SimdLevel::SCALAR;
+#endif
+}
+
+/**
+ * @brief Limit a requested instruction set to the ones the CPU supports
+ * @param requested Requested SIMD level
+ * @return Supported SIMD level
+ */
+inline SimdLevel clamp_simd_level(SimdLevel requested) {
+  return std::min(requested, detect_simd_level());
+}
+
+/**
+ * @brief Get the name of an instruction set
+ * @param level SIMD level
+ * @return Name
+ */
+inline const char *to_string(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::AVX2:
+    return "avx2";
+  case SimdLevel::SSE41:
+    return "sse4.1";
+  default:
+    return "scalar";
+  }
+}
+} // namespace utils :: cpu
+
+#endif // CPU_FEATURES_HPP
@@ -12,7 +12,8 @@ enum class InferenceStatus {
   INTERPRETER_ERROR,
   TENSOR_ALLOCATION_ERROR,
   INVOCATION_ERROR,
-  INPUT_ERROR
+  INPUT_ERROR,
+  DELEGATE_ERROR
 };
 } // namespace tflite::inference
 
@@ -1,6 +1,7 @@
 /**
  * @file scoped_timer.hpp
- * @details Header to get the execution time of a block of code.
+ * @details Header to record the execution time of a block of code into a
+ * latency histogram.
  * @author Arghadeep Mazumder
  * @version 0.1.0
  * @copyright -
@@ -10,18 +11,32 @@
 #define SCOPED_TIMER_HPP
 
 #include <chrono>
-#include <iostream>
+
+#include <metrics/histogram.hpp>
 
 namespace utils ::timer {
-struct ScopedTimer {
-  using Clock = std::chrono::high_resolution_clock;
-  std::chrono::time_point<Clock> start;
-  ScopedTimer() : start(Clock::now()) {}
-  ~ScopedTimer() {
-    const auto end = Clock::now();
-    std::cout << std::chrono::duration<double>(end - start).count()
-              << " seconds" << std::endl;
-  }
+class ScopedTimer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+public:
+  /**
+   * @brief Start timing
+   * @param histogram Histogram receiving the time when the scope ends, e.g.
+   *        from tflite::metrics::MetricsRegistry
+   */
+  explicit ScopedTimer(tflite::metrics::Histogram &histogram)
+      : m_histogram(histogram), m_start(Clock::now()) {}
+  ~ScopedTimer() { this->m_histogram.record(Clock::now() - this->m_start); }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+  ScopedTimer(ScopedTimer &&) = delete;
+  ScopedTimer &operator=(ScopedTimer &&) = delete;
+
+private:
+  tflite::metrics::Histogram &m_histogram;
+  const Clock::time_point m_start;
 };
 } // namespace utils :: timer
 
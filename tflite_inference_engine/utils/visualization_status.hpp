@@ -10,7 +10,8 @@ enum class VisualizationStatus {
   SUCCESS,
   INPUT_IMAGE_EMPTY,
   WINDOW_NAME_EMPTY,
-  OUTPUT_PATH_EMPTY
+  OUTPUT_PATH_EMPTY,
+  INPUT_TYPE_MISMATCH
 };
 } // namespace tflite::visualizer
 
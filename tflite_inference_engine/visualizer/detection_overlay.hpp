@@ -0,0 +1,247 @@
+/**
+ * @file detection_overlay.hpp
+ * @details Drawing of detections into an image without allocation, with the
+ * labels rendered once and reused
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef DETECTION_OVERLAY_HPP
+#define DETECTION_OVERLAY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glog/logging.h>
+#include <opencv2/opencv.hpp>
+#include <postprocess/detection_decoder.hpp>
+#include <trace/tracer.hpp>
+#include <utils/visualization_status.hpp>
+
+namespace tflite::visualizer {
+/**
+ * @brief Appearance of the boxes and labels
+ */
+struct DetectionOverlayOptions {
+  cv::Scalar color = cv::Scalar(0, 255, 0);
+  int box_thickness = 2;
+  double font_scale = 0.5;
+  int font_thickness = 2;
+  // Digits of the score in the labels, -1 to show the class only. Labels
+  // are cached per class and score rounded down to these digits.
+  int score_decimals = 2;
+  // Name of each class, the class index is shown for the others
+  std::vector<std::string> labels;
+  // Labels kept, the least recently drawn one is dropped beyond this. At
+  // least 1.
+  size_t max_cached_labels = 1024;
+};
+
+/**
+ * @brief Draws boxes and labels into a caller-owned image. The text of a
+ * label is rasterized once per class and score into a mask, then copied
+ * onto the image on every later frame, putText being the most expensive
+ * part of the drawing. Once the labels are cached no allocation happens.
+ * The cache holds at most max_cached_labels labels, dropping the least
+ * recently drawn one. Not thread-safe, use one instance per thread.
+ */
+class DetectionOverlay {
+public:
+  /**
+   * @brief Create the overlay
+   * @param options Colors, thicknesses, label format and class names
+   */
+  explicit DetectionOverlay(
+      const DetectionOverlayOptions &options = DetectionOverlayOptions())
+      : m_options(options) {
+    this->m_options.max_cached_labels =
+        std::max<size_t>(1, options.max_cached_labels);
+    this->m_buckets =
+        options.score_decimals >= 0
+            ? static_cast<int>(std::pow(10, options.score_decimals))
+            : 0;
+  }
+  ~DetectionOverlay() = default;
+
+  DetectionOverlay(const DetectionOverlay &) = delete;
+  DetectionOverlay &operator=(const DetectionOverlay &) = delete;
+  DetectionOverlay(DetectionOverlay &&) = delete;
+  DetectionOverlay &operator=(DetectionOverlay &&) = delete;
+
+public:
+  /**
+   * @brief Draw the detections in place
+   * @param image Image to draw into
+   * @param detections Detections in image coordinates
+   * @return Status
+   */
+  VisualizationStatus draw(cv::Mat &image,
+                           const postprocess::Detections &detections) {
+    TFLITE_TRACE_SCOPE("draw_detections");
+    if (image.empty()) {
+      LOG(ERROR) << "Input image is empty";
+      return VisualizationStatus::INPUT_IMAGE_EMPTY;
+    }
+
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    for (size_t i = 0; i < detections.size(); ++i) {
+      const cv::Rect &box = detections.boxes[i];
+      cv::rectangle(image, box, this->m_options.color,
+                    this->m_options.box_thickness);
+
+      // Text baseline 5 pixels above the box
+      const Sprite &sprite =
+          this->get_sprite(detections.classes[i], detections.scores[i]);
+      const cv::Rect target(box.x - sprite.origin.x,
+                            box.y - 5 - sprite.origin.y, sprite.mask.cols,
+                            sprite.mask.rows);
+      const cv::Rect visible = target & bounds;
+      if (visible.empty()) {
+        continue;
+      }
+      image(visible).setTo(this->m_options.color,
+                           sprite.mask(visible - target.tl()));
+    }
+    return VisualizationStatus::SUCCESS;
+  }
+
+  /**
+   * @brief Draw the detections onto a copy of the image held by a reused
+   * buffer
+   * @param image Input image
+   * @param detections Detections in image coordinates
+   * @param output Buffer receiving the image and the detections, only
+   *        reallocated when the image size or type changes
+   * @return Status
+   */
+  VisualizationStatus draw(const cv::Mat &image,
+                           const postprocess::Detections &detections,
+                           cv::Mat &output) {
+    if (image.empty()) {
+      LOG(ERROR) << "Input image is empty";
+      return VisualizationStatus::INPUT_IMAGE_EMPTY;
+    }
+    if (output.data != image.data) {
+      image.copyTo(output);
+    }
+    return this->draw(output, detections);
+  }
+
+public:
+  /**
+   * @brief Get the number of cached labels
+   * @return Number of labels
+   */
+  [[nodiscard]] size_t get_cache_size() const {
+    return this->m_sprites.size();
+  }
+
+  void clear_cache() {
+    this->m_sprites.clear();
+    this->m_recent.clear();
+  }
+
+private:
+  /**
+   * @brief Rasterized label
+   */
+  struct Sprite {
+    // Text pixels set to 255
+    cv::Mat mask;
+    // Position of the text origin, the left end of the baseline, in the mask
+    cv::Point origin;
+  };
+
+  struct CachedSprite {
+    uint64_t key;
+    Sprite sprite;
+  };
+
+  /**
+   * @brief Get the label of a class and score, rendering it on first use and
+   * dropping the least recently drawn label when the cache is full
+   */
+  const Sprite &get_sprite(int class_id, float score) {
+    const int bucket =
+        this->m_buckets > 0
+            ? static_cast<int>(std::floor(std::max(score, 0.0f) *
+                                          static_cast<float>(this->m_buckets)))
+            : 0;
+    const uint64_t key =
+        (static_cast<uint64_t>(static_cast<uint32_t>(class_id)) << 32) |
+        static_cast<uint32_t>(bucket);
+    auto cached = this->m_sprites.find(key);
+    if (cached != this->m_sprites.end()) {
+      // Most recent first
+      this->m_recent.splice(this->m_recent.begin(), this->m_recent,
+                            cached->second);
+      return cached->second->sprite;
+    }
+
+    if (this->m_sprites.size() >= this->m_options.max_cached_labels) {
+      // Reuse the node of the least recently drawn label
+      this->m_sprites.erase(this->m_recent.back().key);
+      this->m_recent.splice(this->m_recent.begin(), this->m_recent,
+                            std::prev(this->m_recent.end()));
+      this->m_recent.front() = {key, this->render(class_id, bucket)};
+    } else {
+      this->m_recent.push_front({key, this->render(class_id, bucket)});
+    }
+    this->m_sprites.emplace(key, this->m_recent.begin());
+    return this->m_recent.front().sprite;
+  }
+
+  /**
+   * @brief Rasterize a label with putText
+   */
+  Sprite render(int class_id, int bucket) const {
+    std::string text =
+        class_id >= 0 &&
+                static_cast<size_t>(class_id) < this->m_options.labels.size()
+            ? this->m_options.labels[class_id]
+            : std::to_string(class_id);
+    if (this->m_buckets > 0) {
+      char score[32];
+      std::snprintf(score, sizeof(score), " : %.*f",
+                    this->m_options.score_decimals,
+                    static_cast<double>(bucket) / this->m_buckets);
+      text += score;
+    }
+
+    int baseline = 0;
+    const cv::Size size =
+        cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX,
+                        this->m_options.font_scale,
+                        this->m_options.font_thickness, &baseline);
+    // Strokes are centred on the glyph outlines and overhang the text size
+    const int padding = this->m_options.font_thickness;
+    Sprite sprite;
+    sprite.origin = cv::Point(padding, padding + size.height);
+    sprite.mask = cv::Mat::zeros(size.height + baseline + 2 * padding,
+                                 size.width + 2 * padding, CV_8UC1);
+    cv::putText(sprite.mask, text, sprite.origin, cv::FONT_HERSHEY_SIMPLEX,
+                this->m_options.font_scale, cv::Scalar(255),
+                this->m_options.font_thickness);
+    return sprite;
+  }
+
+private:
+  DetectionOverlayOptions m_options;
+  // Scores per label, 10^score_decimals
+  int m_buckets = 0;
+  // Labels by decreasing recency
+  std::list<CachedSprite> m_recent;
+  // Position of each label in m_recent
+  std::unordered_map<uint64_t, std::list<CachedSprite>::iterator> m_sprites;
+};
+} // namespace tflite::visualizer
+
+#endif // DETECTION_OVERLAY_HPP
@@ -9,7 +9,9 @@
 #ifndef OBJECT_DETECTION_VISUALIZER_HPP
 #define OBJECT_DETECTION_VISUALIZER_HPP
 
-
+#include <infer/output_tensor.hpp>
+#include <postprocess/detection_decoder.hpp>
+#include <visualizer/detection_overlay.hpp>
 #include <visualizer/visualizer_base.hpp>
 
 namespace tflite::visualizer {
@@ -24,12 +26,8 @@ public:
   ObjectDetectionVisualizer(ObjectDetectionVisualizer &&) = delete;
   ObjectDetectionVisualizer &operator=(ObjectDetectionVisualizer &&) = delete;
 
-private:
-  struct DetectionOutput {
-    std::vector<cv::Rect> boxes;
-    std::vector<int> classes;
-    std::vector<float> scores;
-  };
+public:
+  using DetectionOutput = postprocess::Detections;
 
 public:
   /**
@@ -56,57 +54,102 @@ public:
       return cv::Mat();
     }
 
-    DetectionOutput output =
-        convert_to_array(image.size(), output_locations, output_classes,
-                         output_scores, num_detections);
-
-    cv::Mat overlaid_image = image.clone();
-    for (size_t i = 0; i < output.boxes.size(); i++) {
-      if (output.scores[i] > threshold) {
-        cv::rectangle(overlaid_image, output.boxes[i], cv::Scalar(0, 255, 0),
-                      2);
-        cv::putText(overlaid_image,
-                    std::to_string(output.classes[i]) + " : " +
-                        std::to_string(output.scores[i]),
-                    cv::Point(output.boxes[i].x, output.boxes[i].y - 5),
-                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 2);
-      }
+    return draw(image, convert_to_array(image.size(), output_locations,
+                                        output_classes, output_scores,
+                                        num_detections, threshold));
+  }
+
+public:
+  /**
+   * @brief Visualize the detected objects of float or quantized output
+   * tensors. Quantized elements are only dequantized when read.
+   * @param image Input image
+   * @param output_locations Detected boxes
+   * @param output_classes Detected classes
+   * @param output_scores Detected scores
+   * @param num_detections Number of detections
+   * @param threshold Detection threshold
+   * @return Visualized image
+   */
+  static cv::Mat overlay(const cv::Mat &image,
+                         const inference::OutputTensor &output_locations,
+                         const inference::OutputTensor &output_classes,
+                         const inference::OutputTensor &output_scores,
+                         const inference::OutputTensor &num_detections,
+                         float threshold = 0.5) {
+    if (image.empty()) {
+      LOG(ERROR) << "Input image is empty";
+      return cv::Mat();
+    }
+
+    if (output_locations.empty() || output_classes.empty() ||
+        output_scores.empty() || num_detections.empty()) {
+      LOG(ERROR) << "Output tensors are empty";
+      return cv::Mat();
     }
-    return overlaid_image;
+
+    return draw(image, convert_to_array(image.size(), output_locations,
+                                        output_classes, output_scores,
+                                        num_detections, threshold));
+  }
+
+public:
+  /**
+   * @brief Visualize decoded detections into a caller-owned buffer, which
+   * is not reallocated while the image size stays the same. The labels are
+   * cached per thread, see DetectionOverlay to set their appearance.
+   * @param image Input image
+   * @param detections Detections in image coordinates
+   * @param output Visualized image, may be the input image to draw in place
+   * @return Status
+   */
+  static VisualizationStatus overlay(const cv::Mat &image,
+                                     const DetectionOutput &detections,
+                                     cv::Mat &output) {
+    return get_detection_overlay().draw(image, detections, output);
   }
 
 private:
   /**
-   * @brief Convert the output tensors to array
+   * @brief Draw the detections on a copy of the image
+   * @param image Input image
+   * @param output Detection output
+   * @return Visualized image
+   */
+  static cv::Mat draw(const cv::Mat &image, const DetectionOutput &output) {
+    cv::Mat overlaid_image;
+    get_detection_overlay().draw(image, output, overlaid_image);
+    return overlaid_image;
+  }
+
+  static DetectionOverlay &get_detection_overlay() {
+    thread_local DetectionOverlay detection_overlay;
+    return detection_overlay;
+  }
+
+public:
+  /**
+   * @brief Convert the output tensors to array. Allocates the result on each
+   * call, see postprocess::DetectionDecoder to decode into a reused buffer.
    * @param size Image size
    * @param output_locations Output locations
    * @param output_classes Output classes
    * @param output_scores Output scores
    * @param num_detections Number of detections
+   * @param threshold Detection threshold
    * @return Detection output
    */
-  static DetectionOutput convert_to_array(const cv::Size &size,
-                                          const float *output_locations,
-                                          const float *output_classes,
-                                          const float *output_scores,
-                                          const float *num_detections) {
-    std::vector<cv::Rect> locations;
-    std::vector<int> classes;
-    std::vector<float> scores;
-    int nums_detected = static_cast<int>(*num_detections);
+  template <typename Tensor>
+  static DetectionOutput
+  convert_to_array(const cv::Size &size, const Tensor &output_locations,
+                   const Tensor &output_classes, const Tensor &output_scores,
+                   const Tensor &num_detections, float threshold = 0.5) {
+    postprocess::DecoderOptions options;
+    options.score_threshold = threshold;
     DetectionOutput output;
-
-    for (int i = 0; i < nums_detected; ++i) {
-      if (output_scores[i] > 0.5) {
-        int y1 = static_cast<int>(output_locations[4 * i + 0] * size.width);
-        int x1 = static_cast<int>(output_locations[4 * i + 1] * size.height);
-        int y2 = static_cast<int>(output_locations[4 * i + 2] * size.width);
-        int x2 = static_cast<int>(output_locations[4 * i + 3] * size.height);
-        output.boxes.push_back(cv::Rect(cv::Point(x1, y1), cv::Point(x2, y2)));
-        output.classes.push_back(static_cast<int>(output_classes[i]));
-        output.scores.push_back(output_scores[i]);
-      }
-    }
+    postprocess::DetectionDecoder(options).decode(
+        size, output_locations, output_classes, output_scores, num_detections,
+        output);
     return output;
   }
 };
@@ -9,6 +9,9 @@
 #ifndef SEGMENTATION_VISUALIZER_HPP
 #define SEGMENTATION_VISUALIZER_HPP
 
+#include <postprocess/segmentation_argmax.hpp>
+#include <trace/tracer.hpp>
+#include <visualizer/segmentation_overlay.hpp>
 #include <visualizer/visualizer_base.hpp>
 
 namespace tflite::visualizer {
@@ -23,6 +26,16 @@ public:
   SegmentationVisualizer &operator=(SegmentationVisualizer &&) = delete;
 
 public:
+  /**
+   * @brief Blend the class map of a segmentation output onto an image
+   * @param image CV_8UC3 image. It may be larger than the output, e.g. the
+   *        original frame, the class map is upsampled to its size
+   * @param output_locations Class scores in HWC order
+   * @param height Output height
+   * @param width Output width
+   * @param channels Number of classes
+   * @return Blended image, empty on error
+   */
   static cv::Mat overlay(const cv::Mat &image, const float *output_locations,
                          const int &height, const int &width,
                          const int &channels) {
@@ -36,54 +49,50 @@ public:
       return cv::Mat();
     }
 
-    if (image.size() != cv::Size(width, height)) {
-      LOG(ERROR) << "Input image size does not match with the output size";
+    // Buffers reused by the calls of each thread
+    static const postprocess::SegmentationArgmax argmax;
+    thread_local SegmentationOverlay segmentation_overlay;
+    thread_local cv::Mat classes;
+    if (argmax.run(output_locations, height, width, channels, classes) !=
+        inference::InferenceStatus::SUCCESS) {
       return cv::Mat();
     }
 
-    cv::Mat segmentation_map =
-        generate_segmentation_map(output_locations, height, width, channels);
-
-    cv::Mat resized_segmentation_map;
-    cv::resize(segmentation_map, resized_segmentation_map, image.size(), 0, 0,
-               cv::INTER_NEAREST);
-
-    // Apply color map to the segmentation map for visualization
-    cv::Mat color_map;
-    cv::applyColorMap(resized_segmentation_map, color_map, cv::COLORMAP_JET);
-
-    if (color_map.channels() == 1) {
-      cv::cvtColor(color_map, color_map, cv::COLOR_GRAY2BGR);
-    }
-
-    if (color_map.type() != image.type()) {
-      color_map.convertTo(color_map, image.type());
-    }
+    // Colorize, upsample and blend in one pass
     cv::Mat output_image;
-    cv::addWeighted(image, 0.9, color_map, 0.1, 0, output_image);
+    if (segmentation_overlay.run(image, classes, output_image) !=
+        VisualizationStatus::SUCCESS) {
+      return cv::Mat();
+    }
     return output_image;
   }
 
-private:
+public:
+  /**
+   * @brief Generate the map of the most likely class of each pixel. Class c
+   * is stored as c * 255 / (channels - 1), so the classes span the 8-bit
+   * range of a color map; the previous class * 255 overflowed above class 1.
+   * Use postprocess::SegmentationArgmax for the raw class indices.
+   * @param output_locations Class scores in HWC order
+   * @param height Output height
+   * @param width Output width
+   * @param channels Number of classes
+   * @return Class map scaled to 8 bits
+   */
   static cv::Mat generate_segmentation_map(const float *output_locations,
                                            const int &height, const int &width,
                                            const int &channels) {
-    cv::Mat segmentation_map(height, width, CV_8UC1);
-    for (int i = 0; i < height; ++i) {
-      for (int j = 0; j < width; ++j) {
-        float max_prob = 0.0;
-        uchar max_class = 0;
-        for (int c = 0; c < channels; ++c) {
-          float prob =
-              output_locations[i * width * channels + j * channels + c];
-          if (prob > max_prob) {
-            max_prob = prob;
-            max_class = c;
-          }
-        }
-        segmentation_map.at<uchar>(i, j) = static_cast<uchar>(max_class * 255.);
-      }
+    TFLITE_TRACE_SCOPE("segmentation_map");
+    static const postprocess::SegmentationArgmax argmax;
+    cv::Mat classes;
+    if (argmax.run(output_locations, height, width, channels, classes) !=
+        inference::InferenceStatus::SUCCESS) {
+      return cv::Mat();
     }
+    // Spread the class indices over the 8-bit range for the color map
+    cv::Mat segmentation_map;
+    classes.convertTo(segmentation_map, CV_8U,
+                      channels > 1 ? 255.0 / (channels - 1) : 0.0);
     return segmentation_map;
   }
 };
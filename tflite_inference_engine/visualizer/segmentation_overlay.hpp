@@ -0,0 +1,225 @@
+/**
+ * @file segmentation_overlay.hpp
+ * @details Colorization of a class map and alpha blending onto an image in
+ * one pass, with the class map upsampled on the fly
+ * @author Arghadeep Mazumder
+ * @version 0.1.0
+ * @copyright -
+ */
+
+#ifndef SEGMENTATION_OVERLAY_HPP
+#define SEGMENTATION_OVERLAY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glog/logging.h>
+#include <opencv2/core.hpp>
+#include <trace/tracer.hpp>
+#include <utils/visualization_status.hpp>
+
+namespace tflite::visualizer {
+/**
+ * @brief Colors and opacity of the overlay. The defaults match the previous
+ * addWeighted(image, 0.9, colors, 0.1) blend with every class colored.
+ */
+struct OverlayOptions {
+  // BGR color of each class, classes past the end reuse it cyclically.
+  // Empty for default_palette()
+  std::vector<cv::Vec3b> palette;
+  // Opacity of the class colors
+  float alpha = 0.1f;
+  // Class left uncolored, -1 to color every class
+  int background = -1;
+};
+
+/**
+ * @brief Blends the colors of a class map onto an image. Every palette entry
+ * is turned into a lookup table from image value to blended value when the
+ * options are set, so a pixel costs three table lookups. Each class map
+ * pixel covers a run of image pixels sharing its table; background runs are
+ * copied, or skipped when blending in place. Output rows are split across
+ * the OpenCV threads and the runs of the upsampling are cached. Not
+ * thread-safe, use one instance per thread.
+ */
+class SegmentationOverlay {
+public:
+  /**
+   * @brief Create the overlay
+   * @param options Palette, opacity and background class
+   */
+  explicit SegmentationOverlay(const OverlayOptions &options = OverlayOptions())
+      : m_options(options) {
+    if (this->m_options.palette.empty()) {
+      this->m_options.palette = default_palette();
+    }
+    // Class maps hold at most 256 classes
+    if (this->m_options.palette.size() > 256) {
+      this->m_options.palette.resize(256);
+    }
+    this->m_options.alpha = std::clamp(this->m_options.alpha, 0.0f, 1.0f);
+    this->build_tables();
+  }
+  ~SegmentationOverlay() = default;
+
+  SegmentationOverlay(const SegmentationOverlay &) = delete;
+  SegmentationOverlay &operator=(const SegmentationOverlay &) = delete;
+  SegmentationOverlay(SegmentationOverlay &&) = delete;
+  SegmentationOverlay &operator=(SegmentationOverlay &&) = delete;
+
+public:
+  /**
+   * @brief Blend a class map onto an image
+   * @param image CV_8UC3 image
+   * @param classes CV_8UC1 class map, upsampled to the image size with
+   *        nearest neighbour
+   * @param output Blended image, reused when its size matches. May be the
+   *        input image.
+   * @return Status
+   */
+  VisualizationStatus run(const cv::Mat &image, const cv::Mat &classes,
+                          cv::Mat &output) {
+    TFLITE_TRACE_SCOPE("segmentation_overlay");
+    if (image.empty() || classes.empty()) {
+      LOG(ERROR) << "Input image or class map is empty";
+      return VisualizationStatus::INPUT_IMAGE_EMPTY;
+    }
+    if (image.type() != CV_8UC3 || classes.type() != CV_8UC1) {
+      LOG(ERROR) << "Overlay expects a CV_8UC3 image and a CV_8UC1 class map";
+      return VisualizationStatus::INPUT_TYPE_MISMATCH;
+    }
+
+    output.create(image.rows, image.cols, CV_8UC3);
+    this->map_columns(classes.cols, image.cols);
+    const int *starts = this->m_starts.data();
+    const uint8_t *tables = this->m_tables.data();
+    const uint16_t *entries = this->m_entries.data();
+    const uint16_t identity =
+        static_cast<uint16_t>(this->m_options.palette.size());
+    const int columns = classes.cols;
+    const int64_t rows = classes.rows;
+    const int64_t height = image.rows;
+    const bool in_place = output.data == image.data;
+
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range &range) {
+      for (int y = range.start; y < range.end; ++y) {
+        const uint8_t *class_row =
+            classes.ptr<uint8_t>(static_cast<int>(y * rows / height));
+        const uint8_t *src = image.ptr<uint8_t>(y);
+        uint8_t *dst = output.ptr<uint8_t>(y);
+        for (int column = 0; column < columns; ++column) {
+          const int begin = 3 * starts[column];
+          const int end = 3 * starts[column + 1];
+          const uint16_t entry = entries[class_row[column]];
+          if (entry == identity) {
+            if (!in_place) {
+              std::copy(src + begin, src + end, dst + begin);
+            }
+            continue;
+          }
+          const uint8_t *table = tables + entry * TABLE_SIZE;
+          for (int i = begin; i < end; i += 3) {
+            dst[i] = table[src[i]];
+            dst[i + 1] = table[256 + src[i + 1]];
+            dst[i + 2] = table[512 + src[i + 2]];
+          }
+        }
+      }
+    });
+    return VisualizationStatus::SUCCESS;
+  }
+
+public:
+  /**
+   * @brief Get the Pascal VOC palette, distinct colors for the 21 classes of
+   * DeepLab and beyond
+   * @param size Number of colors
+   * @return BGR colors
+   */
+  static std::vector<cv::Vec3b> default_palette(int size = 256) {
+    std::vector<cv::Vec3b> palette(size);
+    for (int i = 0; i < size; ++i) {
+      int red = 0;
+      int green = 0;
+      int blue = 0;
+      for (int bit = 7, id = i; bit >= 0 && id > 0; --bit, id >>= 3) {
+        red |= (id & 1) << bit;
+        green |= ((id >> 1) & 1) << bit;
+        blue |= ((id >> 2) & 1) << bit;
+      }
+      palette[i] = cv::Vec3b(static_cast<uint8_t>(blue),
+                             static_cast<uint8_t>(green),
+                             static_cast<uint8_t>(red));
+    }
+    return palette;
+  }
+
+  [[nodiscard]] const OverlayOptions &get_options() const {
+    return this->m_options;
+  }
+
+private:
+  // Blended value of each channel and image value for one palette entry
+  static constexpr size_t TABLE_SIZE = 3 * 256;
+
+  /**
+   * @brief Build a table per palette entry plus an identity table for the
+   * background, and the entry of each of the 256 classes
+   */
+  void build_tables() {
+    const std::vector<cv::Vec3b> &palette = this->m_options.palette;
+    const float alpha = this->m_options.alpha;
+    const size_t identity = palette.size();
+    this->m_tables.resize((palette.size() + 1) * TABLE_SIZE);
+    for (size_t entry = 0; entry <= palette.size(); ++entry) {
+      uint8_t *table = this->m_tables.data() + entry * TABLE_SIZE;
+      for (int channel = 0; channel < 3; ++channel) {
+        for (int value = 0; value < 256; ++value) {
+          table[channel * 256 + value] =
+              entry == identity
+                  ? static_cast<uint8_t>(value)
+                  : cv::saturate_cast<uint8_t>(
+                        (1.0f - alpha) * static_cast<float>(value) +
+                        alpha * static_cast<float>(palette[entry][channel]));
+        }
+      }
+    }
+    for (size_t class_id = 0; class_id < this->m_entries.size(); ++class_id) {
+      this->m_entries[class_id] = static_cast<uint16_t>(
+          static_cast<int>(class_id) == this->m_options.background
+              ? identity
+              : class_id % palette.size());
+    }
+  }
+
+  /**
+   * @brief Find the first image column of each class map column. Image
+   * column x shows class map column x * source_width / width, rounded down.
+   */
+  void map_columns(int source_width, int width) {
+    if (this->m_source_width == source_width && this->m_width == width) {
+      return;
+    }
+    this->m_source_width = source_width;
+    this->m_width = width;
+    this->m_starts.resize(source_width + 1);
+    for (int column = 0; column <= source_width; ++column) {
+      this->m_starts[column] = static_cast<int>(
+          (static_cast<int64_t>(column) * width + source_width - 1) /
+          source_width);
+    }
+  }
+
+private:
+  OverlayOptions m_options;
+  std::vector<uint8_t> m_tables;
+  std::array<uint16_t, 256> m_entries{};
+  std::vector<int> m_starts;
+  int m_source_width = 0;
+  int m_width = 0;
+};
+} // namespace tflite::visualizer
+
+#endif // SEGMENTATION_OVERLAY_HPP